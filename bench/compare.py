@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Compare two usd_fluid_domain_bench JSON reports and flag regressions.
+
+    usd_fluid_domain_bench --benchmark_out=current.json --benchmark_out_format=json
+    bench/compare.py bench/baselines/<host>.json current.json [--threshold 0.10]
+
+Each benchmark's time, and each per-phase "<phase>_ms" counter the
+EnvelopeBuilder benchmarks report, is compared against the baseline.  A value
+more than threshold slower than the baseline is a regression, and the script
+exits 1 if there is any.  With --benchmark_repetitions the mean aggregates are
+compared instead of the single runs.
+
+Timings only compare on the machine that recorded them, so baselines are kept
+per host under bench/baselines/ (see the README there for how to record one).
+A warning is printed when the two reports come from different hosts, CPU
+counts or library build types.
+"""
+
+import argparse
+import json
+import sys
+
+UNIT_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path, metric):
+    """Benchmark name -> {figure: value}, times in ms, and the run context."""
+    with open(path) as f:
+        report = json.load(f)
+
+    runs, means = {}, {}
+    for b in report.get("benchmarks", []):
+        if b.get("error_occurred"):
+            continue
+        scale = UNIT_NS[b.get("time_unit", "ns")] / 1e6
+        figures = {"time_ms": b[metric] * scale}
+        figures.update({k: v for k, v in b.items()
+                        if k.endswith("_ms") and isinstance(v, (int, float))})
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "mean":
+                means[b["run_name"]] = figures
+        else:
+            runs[b.get("run_name", b["name"])] = figures
+    return means or runs, report.get("context", {})
+
+
+def check_context(baseline, current):
+    """Warn about context fields that make the timings incomparable."""
+    for field in ("host_name", "num_cpus", "library_build_type"):
+        if baseline.get(field) != current.get(field):
+            print(f"warning: {field} differs: baseline {baseline.get(field)!r}, "
+                  f"current {current.get(field)!r}", file=sys.stderr)
+    if current.get("library_build_type") == "debug":
+        print("warning: current report is from a debug benchmark library",
+              file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown flagged as a regression "
+                             "(default 0.10)")
+    parser.add_argument("--metric", choices=["real_time", "cpu_time"],
+                        default="real_time")
+    parser.add_argument("--min-ms", type=float, default=0.01,
+                        help="ignore figures below this many ms in the "
+                             "baseline, which are mostly noise (default 0.01)")
+    args = parser.parse_args()
+
+    baseline, baseline_context = load(args.baseline, args.metric)
+    current, current_context = load(args.current, args.metric)
+    check_context(baseline_context, current_context)
+
+    regressions = 0
+    width = max([len("benchmark")] + [len(n) for n in current]) + 2
+    print(f"{'benchmark':<{width}}{'figure':<22}{'baseline':>12}"
+          f"{'current':>12}{'change':>10}")
+    for name in sorted(current):
+        if name not in baseline:
+            print(f"{name:<{width}}(new)")
+            continue
+        for figure, value in sorted(current[name].items()):
+            base = baseline[name].get(figure)
+            if base is None or base < args.min_ms:
+                continue
+            change = value / base - 1.0
+            flag = ""
+            if change > args.threshold:
+                flag = "  REGRESSION"
+                regressions += 1
+            elif change < -args.threshold:
+                flag = "  improved"
+            print(f"{name:<{width}}{figure:<22}{base:>12.3f}{value:>12.3f}"
+                  f"{change:>+10.1%}{flag}")
+    for name in sorted(set(baseline) - set(current)):
+        print(f"{name:<{width}}(missing)")
+
+    if regressions:
+        print(f"\n{regressions} regression(s) over {args.threshold:.0%}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,162 @@
+#include "SceneGenerator.h"
+
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/xform.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <sstream>
+
+namespace bench {
+
+namespace {
+
+// Rings from pole to pole; each has twice as many segments, so a sphere has
+// 2 * rings^2 faces: quads, with a fan of triangles around each pole.
+int ring_count(const SceneSpec& spec) {
+    return std::max(2, static_cast<int>(std::lround(
+        std::sqrt(static_cast<double>(spec.faces_per_body) / 2.0))));
+}
+
+struct SphereMesh {
+    VtVec3fArray points;
+    VtIntArray   counts;
+    VtIntArray   indices;
+};
+
+// Latitude-longitude sphere, rotated by angle about z.
+SphereMesh make_sphere(int rings, double radius, double angle) {
+    const int segments = 2 * rings;
+    const double pi = 3.14159265358979323846;
+
+    SphereMesh s;
+    s.points.resize(size_t(rings - 1) * segments + 2);
+    GfVec3f* pt = s.points.data();
+    *pt++ = GfVec3f(0.0f, 0.0f, float(radius));
+    for (int j = 1; j < rings; ++j) {
+        const double theta = pi * j / rings;
+        for (int i = 0; i < segments; ++i) {
+            const double phi = angle + 2.0 * pi * i / segments;
+            *pt++ = GfVec3f(float(radius * std::sin(theta) * std::cos(phi)),
+                            float(radius * std::sin(theta) * std::sin(phi)),
+                            float(radius * std::cos(theta)));
+        }
+    }
+    *pt = GfVec3f(0.0f, 0.0f, float(-radius));
+
+    // Ring j's segment i, with the poles at 0 and the last index
+    const int south = static_cast<int>(s.points.size()) - 1;
+    auto at = [segments](int j, int i) {
+        return 1 + (j - 1) * segments + i % segments;
+    };
+
+    s.counts.reserve(size_t(segments) * rings);
+    s.indices.reserve(size_t(segments) * (4 * rings - 2));
+    for (int i = 0; i < segments; ++i) {
+        s.counts.push_back(3);
+        s.indices.push_back(0);
+        s.indices.push_back(at(1, i));
+        s.indices.push_back(at(1, i + 1));
+    }
+    for (int j = 1; j < rings - 1; ++j) {
+        for (int i = 0; i < segments; ++i) {
+            s.counts.push_back(4);
+            s.indices.push_back(at(j, i));
+            s.indices.push_back(at(j + 1, i));
+            s.indices.push_back(at(j + 1, i + 1));
+            s.indices.push_back(at(j, i + 1));
+        }
+    }
+    for (int i = 0; i < segments; ++i) {
+        s.counts.push_back(3);
+        s.indices.push_back(south);
+        s.indices.push_back(at(rings - 1, i + 1));
+        s.indices.push_back(at(rings - 1, i));
+    }
+    return s;
+}
+
+void define_mesh(UsdStageRefPtr stage, const std::string& path,
+                 const SphereMesh& sphere) {
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath(path));
+    mesh.GetPointsAttr().Set(sphere.points);
+    mesh.GetFaceVertexCountsAttr().Set(sphere.counts);
+    mesh.GetFaceVertexIndicesAttr().Set(sphere.indices);
+}
+
+} // namespace
+
+size_t body_face_count(const SceneSpec& spec) {
+    const size_t rings = static_cast<size_t>(ring_count(spec));
+    return 2 * rings * rings;
+}
+
+size_t scene_face_count(const SceneSpec& spec) {
+    return body_face_count(spec) * size_t(spec.bodies + spec.instances);
+}
+
+UsdStageRefPtr make_scene(const SceneSpec& spec) {
+    auto stage = UsdStage::CreateInMemory();
+    const int rings = ring_count(spec);
+
+    // Lattice cell of the c-th sphere, bodies first
+    const int total = spec.bodies + spec.instances;
+    const int side  = std::max(1, static_cast<int>(std::ceil(std::cbrt(double(total)))));
+    const double pitch = 2.0 * spec.radius + spec.gap;
+    auto cell = [&](int c) {
+        return GfVec3d(pitch * (c % side), pitch * (c / side % side),
+                       pitch * (c / (side * side)));
+    };
+
+    UsdGeomXform::Define(stage, SdfPath("/Scene"));
+    for (int b = 0; b < spec.bodies; ++b) {
+        const std::string part = "/Scene/body_" + std::to_string(b);
+        UsdGeomXform::Define(stage, SdfPath(part)).AddTranslateOp().Set(cell(b));
+        // Golden-angle turns about z keep every body's points distinct
+        define_mesh(stage, part + "/mesh",
+                    make_sphere(rings, spec.radius, 2.39996322972865332 * b));
+    }
+
+    if (spec.instances > 0) {
+        stage->CreateClassPrim(SdfPath("/Library"));
+        UsdGeomXform::Define(stage, SdfPath("/Library/Body"));
+        define_mesh(stage, "/Library/Body/mesh",
+                    make_sphere(rings, spec.radius, 0.0));
+    }
+    for (int i = 0; i < spec.instances; ++i) {
+        auto xf = UsdGeomXform::Define(
+            stage, SdfPath("/Scene/instance_" + std::to_string(i)));
+        xf.AddTranslateOp().Set(cell(spec.bodies + i));
+        xf.GetPrim().GetReferences().AddInternalReference(SdfPath("/Library/Body"));
+        xf.GetPrim().SetInstanceable(true);
+    }
+    return stage;
+}
+
+std::vector<UsdGeomMesh> scene_meshes(UsdStageRefPtr stage) {
+    std::vector<UsdGeomMesh> meshes;
+    for (const auto& prim :
+         stage->Traverse(UsdTraverseInstanceProxies(UsdPrimDefaultPredicate)))
+        if (prim.IsA<UsdGeomMesh>()) meshes.emplace_back(prim);
+    return meshes;
+}
+
+std::string scene_file(const SceneSpec& spec) {
+    std::ostringstream name;
+    name << "ufd_bench_" << spec.bodies << "b_" << spec.instances << "i_"
+         << body_face_count(spec) << "f_" << spec.radius << "r_"
+         << spec.gap << "g.usdc";
+    const auto path = std::filesystem::temp_directory_path() / name.str();
+    if (!std::filesystem::exists(path))
+        make_scene(spec)->GetRootLayer()->Export(path.string());
+    return path.string();
+}
+
+} // namespace bench
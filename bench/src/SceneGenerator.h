@@ -0,0 +1,43 @@
+#pragma once
+
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace bench {
+
+// A procedural scene of tessellated spheres laid out on a cubic lattice.
+// Neighbouring spheres are separated by gap, so a hole_threshold above gap
+// makes closing bridge every pair; a gap above it leaves them apart.
+struct SceneSpec {
+    int    bodies         = 8;        // distinct sphere meshes
+    int    instances      = 0;        // instanceable references to one
+                                      // shared sphere prototype
+    size_t faces_per_body = 20000;    // approximate quads per sphere
+    double radius         = 1.0;
+    double gap            = 0.05;     // surface-to-surface spacing
+};
+
+// Quads each sphere of spec actually gets, and over the whole scene.
+size_t body_face_count(const SceneSpec& spec);
+size_t scene_face_count(const SceneSpec& spec);
+
+// Bodies are /Scene/body_<i>/mesh, each under a translated Xform and rotated
+// in local space so no two share points (prototype reuse does not fold
+// them); instances are /Scene/instance_<i>, referencing the abstract
+// /Library/Body.
+UsdStageRefPtr make_scene(const SceneSpec& spec);
+
+// Every mesh of stage, instance proxies included, in stage order.
+std::vector<UsdGeomMesh> scene_meshes(UsdStageRefPtr stage);
+
+// The same scene saved as a .usdc under the temp directory, reused by every
+// call with the same spec, for benchmarks that open from disk.
+std::string scene_file(const SceneSpec& spec);
+
+} // namespace bench
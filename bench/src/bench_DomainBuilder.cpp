@@ -0,0 +1,44 @@
+#include "SceneGenerator.h"
+
+#include <ufd/DomainBuilder.h>
+#include <ufd/SurfaceExtractor.h>
+
+#include <benchmark/benchmark.h>
+
+// Domain authoring alone, into a fresh in-memory stage
+static void BM_DomainBuild(benchmark::State& state, ufd::DomainShape shape) {
+    ufd::DomainConfig config;
+    config.shape             = shape;
+    config.cylinder_segments = static_cast<int>(state.range(0));
+    const ufd::DomainBuilder builder(config);
+    const GfRange3d bounds(GfVec3d(-1.0), GfVec3d(1.0));
+
+    for (auto _ : state) {
+        auto stage = UsdStage::CreateInMemory();
+        benchmark::DoNotOptimize(builder.build(stage, bounds));
+    }
+}
+
+// Bounds of 100 generated spheres of range(0) faces each, then the domain
+static void BM_DomainFromScene(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies         = 100;
+    spec.faces_per_body = static_cast<size_t>(state.range(0));
+    const auto scene  = bench::make_scene(spec);
+    const auto meshes = bench::scene_meshes(scene);
+    const ufd::SurfaceExtractor extractor;
+    const ufd::DomainBuilder builder(ufd::DomainConfig{});
+
+    for (auto _ : state) {
+        auto stage = UsdStage::CreateInMemory();
+        benchmark::DoNotOptimize(
+            builder.build(stage, extractor.compute_world_bounds(meshes)));
+    }
+    state.SetItemsProcessed(state.iterations() * bench::scene_face_count(spec));
+}
+
+BENCHMARK_CAPTURE(BM_DomainBuild, box, ufd::DomainShape::Box)->Arg(36);
+BENCHMARK_CAPTURE(BM_DomainBuild, cylinder, ufd::DomainShape::Cylinder)
+    ->Arg(36)->Arg(360);
+BENCHMARK(BM_DomainFromScene)
+    ->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
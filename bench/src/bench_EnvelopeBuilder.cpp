@@ -0,0 +1,162 @@
+#include "SceneGenerator.h"
+
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/Metrics.h>
+#include <ufd/StageReader.h>
+
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <string>
+
+// Builds the envelope of scene once per iteration and reports, besides the
+// total, the wall time of each pipeline phase Metrics records, averaged
+// over iterations as "<phase>_ms" counters.
+static void run_builds(benchmark::State& state, const bench::SceneSpec& spec,
+                       const ufd::EnvelopeConfig& config) {
+    const auto scene  = bench::make_scene(spec);
+    const auto meshes = bench::scene_meshes(scene);
+    const ufd::EnvelopeBuilder builder(config);
+
+    auto& metrics = ufd::Metrics::global();
+    metrics.set_enabled(true);
+    std::map<std::string, double> phase_seconds;
+    ufd::EnvelopeStats stats;
+    for (auto _ : state) {
+        metrics.reset();
+        auto stage = UsdStage::CreateInMemory();
+        benchmark::DoNotOptimize(builder.build(stage, meshes, {}, &stats));
+        for (const auto& phase : metrics.phases())
+            phase_seconds[phase.name] += phase.wall_seconds;
+    }
+    metrics.set_enabled(false);
+    metrics.reset();
+
+    for (const auto& [name, seconds] : phase_seconds) {
+        state.counters[name + "_ms"] =
+            benchmark::Counter(1e3 * seconds, benchmark::Counter::kAvgIterations);
+    }
+    state.counters["active_voxels"] = double(stats.active_voxel_count);
+    state.counters["envelope_faces"] = double(stats.envelope_face_count);
+    state.SetItemsProcessed(state.iterations() * bench::scene_face_count(spec));
+}
+
+// 27 spheres of range(0) faces each, 0.05 apart, so closing bridges every
+// gap; up to about 11M faces in all
+static void BM_EnvelopeBuild(benchmark::State& state, ufd::ClosingMode closing) {
+    bench::SceneSpec spec;
+    spec.bodies         = 27;
+    spec.faces_per_body = static_cast<size_t>(state.range(0));
+
+    ufd::EnvelopeConfig config;
+    config.voxel_size     = 0.05;
+    config.hole_threshold = 0.2;
+    config.closing        = closing;
+    run_builds(state, spec, config);
+}
+
+// One body and 63 instances of it, with prototype reuse off (0) or on (1)
+static void BM_EnvelopeInstanced(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies         = 1;
+    spec.instances      = 63;
+    spec.faces_per_body = 20000;
+
+    ufd::EnvelopeConfig config;
+    config.voxel_size       = 0.05;
+    config.hole_threshold   = 0.2;
+    config.reuse_prototypes = state.range(0) != 0;
+    run_builds(state, spec, config);
+}
+
+// Many small bodies, voxelized one SDF per mesh or as a single soup
+static void BM_EnvelopeVoxelizeMode(benchmark::State& state,
+                                    ufd::VoxelizeMode mode) {
+    bench::SceneSpec spec;
+    spec.bodies         = 1000;
+    spec.faces_per_body = 200;
+    spec.radius         = 0.25;
+
+    ufd::EnvelopeConfig config;
+    config.voxel_size     = 0.02;
+    config.hole_threshold = 0.1;
+    config.mode           = mode;
+    run_builds(state, spec, config);
+}
+
+// 64 bodies voxelized as parallel tasks with a pairwise union (1) or
+// folded serially (0)
+static void BM_EnvelopeParallel(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies         = 64;
+    spec.faces_per_body = 20000;
+
+    ufd::EnvelopeConfig config;
+    config.voxel_size     = 0.05;
+    config.hole_threshold = 0.2;
+    config.mode           = ufd::VoxelizeMode::PerMesh;
+    config.parallel       = state.range(0) != 0;
+    run_builds(state, spec, config);
+}
+
+// 125 bodies closed into one block, with coarse_factor range(0): 1 builds
+// at full resolution only
+static void BM_EnvelopeCoarseToFine(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies         = 125;
+    spec.faces_per_body = 2000;
+
+    ufd::EnvelopeConfig config;
+    config.voxel_size     = 0.05;
+    config.hole_threshold = 0.2;
+    config.coarse_factor  = static_cast<int>(state.range(0));
+    run_builds(state, spec, config);
+}
+
+// Traversal, reads and voxelization of 1000 bodies, collected up front and
+// built, or streamed in batches; both PerMesh without reuse
+static void BM_EnvelopeStreamed(benchmark::State& state, bool streamed) {
+    bench::SceneSpec spec;
+    spec.bodies         = 1000;
+    spec.faces_per_body = 2000;
+    spec.radius         = 0.25;
+    const auto scene = bench::make_scene(spec);
+
+    ufd::EnvelopeConfig config;
+    config.voxel_size       = 0.02;
+    config.hole_threshold   = 0.1;
+    config.mode             = ufd::VoxelizeMode::PerMesh;
+    config.reuse_prototypes = false;
+    const ufd::EnvelopeBuilder builder(config);
+
+    for (auto _ : state) {
+        auto stage = UsdStage::CreateInMemory();
+        if (streamed) {
+            ufd::MeshStream stream(scene);
+            benchmark::DoNotOptimize(builder.build_streamed(stage, stream));
+        } else {
+            benchmark::DoNotOptimize(
+                builder.build(stage, bench::scene_meshes(scene)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * bench::scene_face_count(spec));
+}
+
+#define UFD_BODY_FACES \
+    Arg(2000)->Arg(40000)->Arg(400000)->Unit(benchmark::kMillisecond)
+
+BENCHMARK_CAPTURE(BM_EnvelopeBuild, level_set, ufd::ClosingMode::LevelSet)
+    ->UFD_BODY_FACES;
+BENCHMARK_CAPTURE(BM_EnvelopeBuild, topology, ufd::ClosingMode::Topology)
+    ->UFD_BODY_FACES;
+BENCHMARK(BM_EnvelopeInstanced)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnvelopeVoxelizeMode, per_mesh, ufd::VoxelizeMode::PerMesh)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnvelopeVoxelizeMode, soup, ufd::VoxelizeMode::Soup)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EnvelopeParallel)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EnvelopeCoarseToFine)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnvelopeStreamed, collected, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_EnvelopeStreamed, streamed, true)
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,66 @@
+#include <ufd/MeshGather.h>
+
+#include <openvdb/tools/LevelSetSphere.h>
+
+#include <benchmark/benchmark.h>
+
+// Run mesher over a level-set sphere of the given radius in voxels
+static void mesh_sphere(openvdb::tools::VolumeToMesh& mesher, float radius) {
+    openvdb::initialize();
+    mesher(*openvdb::tools::createLevelSetSphere<openvdb::FloatGrid>(
+        radius, openvdb::Vec3f(0.0f), 1.0f));
+}
+
+static size_t polygon_count(const openvdb::tools::VolumeToMesh& mesher) {
+    size_t n = 0;
+    for (size_t pi = 0; pi < mesher.polygonPoolListSize(); ++pi)
+        n += mesher.polygonPoolList()[pi].numQuads()
+           + mesher.polygonPoolList()[pi].numTriangles();
+    return n;
+}
+
+// The one-element-at-a-time gather gather_mesh replaced
+static void BM_GatherSerialLoop(benchmark::State& state) {
+    openvdb::tools::VolumeToMesh mesher(0.0, 0.0);
+    mesh_sphere(mesher, static_cast<float>(state.range(0)));
+
+    for (auto _ : state) {
+        ufd::SurfaceData surface;
+        const auto& pts = mesher.pointList();
+        for (size_t i = 0; i < mesher.pointListSize(); ++i)
+            surface.points.push_back(GfVec3f(pts[i][0], pts[i][1], pts[i][2]));
+
+        const auto& pools = mesher.polygonPoolList();
+        for (size_t pi = 0; pi < mesher.polygonPoolListSize(); ++pi) {
+            const auto& pool = pools[pi];
+            for (size_t qi = 0; qi < pool.numQuads(); ++qi) {
+                const openvdb::Vec4I& q = pool.quad(qi);
+                surface.face_vertex_counts.push_back(4);
+                for (int c = 3; c >= 0; --c)
+                    surface.face_vertex_indices.push_back(static_cast<int>(q[c]));
+            }
+            for (size_t ti = 0; ti < pool.numTriangles(); ++ti) {
+                const openvdb::Vec3I& t = pool.triangle(ti);
+                surface.face_vertex_counts.push_back(3);
+                for (int c = 2; c >= 0; --c)
+                    surface.face_vertex_indices.push_back(static_cast<int>(t[c]));
+            }
+        }
+        benchmark::DoNotOptimize(surface.face_vertex_indices.cdata());
+    }
+    state.SetItemsProcessed(state.iterations() * polygon_count(mesher));
+}
+
+static void BM_GatherMesh(benchmark::State& state) {
+    openvdb::tools::VolumeToMesh mesher(0.0, 0.0);
+    mesh_sphere(mesher, static_cast<float>(state.range(0)));
+
+    for (auto _ : state) {
+        auto surface = ufd::gather_mesh(mesher);
+        benchmark::DoNotOptimize(surface.face_vertex_indices.cdata());
+    }
+    state.SetItemsProcessed(state.iterations() * polygon_count(mesher));
+}
+
+BENCHMARK(BM_GatherSerialLoop)->Arg(100)->Arg(400)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GatherMesh)->Arg(100)->Arg(400)->Unit(benchmark::kMillisecond);
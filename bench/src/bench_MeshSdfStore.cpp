@@ -0,0 +1,45 @@
+#include "SceneGenerator.h"
+
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/MeshSdfStore.h>
+
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usdGeom/xform.h>
+
+#include <benchmark/benchmark.h>
+
+// Rebuild after one of 27 bodies moves, from scratch (0) or incrementally
+// from a MeshSdfStore holding the previous build (1).  The body moves back
+// and forth outside the timing, so every rebuild has one changed mesh.
+static void BM_EnvelopeRebuild(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies = 27;
+    const auto scene  = bench::make_scene(spec);
+    const auto meshes = bench::scene_meshes(scene);
+
+    ufd::EnvelopeConfig config;
+    config.voxel_size     = 0.05;
+    config.hole_threshold = 0.2;
+    ufd::MeshSdfStore store;
+    ufd::MeshSdfStore* const use_store = state.range(0) != 0 ? &store : nullptr;
+    const ufd::EnvelopeBuilder builder(config, nullptr, use_store);
+    builder.build(UsdStage::CreateInMemory(), meshes);
+
+    bool reset = false;
+    auto op = UsdGeomXform(scene->GetPrimAtPath(SdfPath("/Scene/body_26")))
+                  .GetOrderedXformOps(&reset)[0];
+    GfVec3d home;
+    op.Get(&home);
+
+    bool lifted = false;
+    for (auto _ : state) {
+        state.PauseTiming();
+        lifted = !lifted;
+        op.Set(lifted ? home + GfVec3d(0.0, 0.0, 0.5) : home);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(builder.build(UsdStage::CreateInMemory(), meshes));
+    }
+}
+
+BENCHMARK(BM_EnvelopeRebuild)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
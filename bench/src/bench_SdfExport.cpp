@@ -0,0 +1,31 @@
+#include <ufd/SdfExport.h>
+
+#include <openvdb/tools/LevelSetSphere.h>
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+
+// Export of a level-set sphere of radius range(0) voxels, with the file size
+// reported as the "file_bytes" counter
+static void BM_WriteSdf(benchmark::State& state, ufd::SdfFormat format) {
+    openvdb::initialize();
+    const auto sphere = openvdb::tools::createLevelSetSphere<openvdb::FloatGrid>(
+        static_cast<float>(state.range(0)), openvdb::Vec3f(0.0f), 1.0f);
+    const std::string path =
+        (std::filesystem::temp_directory_path()
+         / (std::string("ufd_bench.") + ufd::to_string(format))).string();
+
+    for (auto _ : state) ufd::write_sdf(*sphere, path, format);
+
+    const auto bytes = std::filesystem::file_size(path);
+    state.counters["file_bytes"] = double(bytes);
+    state.SetBytesProcessed(state.iterations() * bytes);
+    std::filesystem::remove(path);
+}
+
+BENCHMARK_CAPTURE(BM_WriteSdf, dense, ufd::SdfFormat::Dense)
+    ->Arg(50)->Arg(100)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WriteSdf, sparse, ufd::SdfFormat::Sparse)
+    ->Arg(50)->Arg(100)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,58 @@
+#include "SceneGenerator.h"
+
+#include <ufd/DomainBuilder.h>
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/StageComposer.h>
+#include <ufd/SurfaceExtractor.h>
+
+#include <pxr/usd/sdf/layer.h>
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <string>
+
+static std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("ufd_bench_" + name)).string();
+}
+
+// Material authoring and the saves of the domain, envelope and root layers,
+// with the envelope of range(0) spheres in the given layer format.  The
+// component layers are refilled outside the timing each iteration, so
+// every save writes a dirty layer.
+static void BM_ComposeWrite(benchmark::State& state, const char* extension) {
+    bench::SceneSpec spec;
+    spec.bodies = static_cast<int>(state.range(0));
+    const auto scene  = bench::make_scene(spec);
+    const auto meshes = bench::scene_meshes(scene);
+
+    auto domain = UsdStage::CreateInMemory();
+    ufd::DomainBuilder(ufd::DomainConfig{})
+        .build(domain, ufd::SurfaceExtractor().compute_world_bounds(meshes));
+    ufd::EnvelopeConfig config;
+    config.voxel_size     = 0.05;
+    config.hole_threshold = 0.2;
+    auto envelope = UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(config).build(envelope, meshes);
+
+    const std::string ext = extension;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto domain_stage   = UsdStage::CreateNew(temp_path("domain." + ext));
+        auto envelope_stage = UsdStage::CreateNew(temp_path("envelope." + ext));
+        domain_stage->GetRootLayer()->TransferContent(domain->GetRootLayer());
+        envelope_stage->GetRootLayer()->TransferContent(envelope->GetRootLayer());
+        ufd::StageComposer composer(temp_path("root." + ext));
+        composer.add_component(ufd::ComponentType::InputGeometry, scene);
+        composer.add_component(ufd::ComponentType::FluidDomain,   domain_stage);
+        composer.add_component(ufd::ComponentType::Envelope,      envelope_stage);
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(composer.write());
+    }
+}
+
+BENCHMARK_CAPTURE(BM_ComposeWrite, usda, "usda")
+    ->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ComposeWrite, usdc, "usdc")
+    ->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,56 @@
+#include "SceneGenerator.h"
+
+#include <ufd/StageReader.h>
+
+#include <benchmark/benchmark.h>
+
+// Opening a saved scene of range(0) bodies of 20k faces
+static void BM_StageOpen(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies = static_cast<int>(state.range(0));
+    const std::string path = bench::scene_file(spec);
+
+    for (auto _ : state) {
+        ufd::StageReader reader;
+        benchmark::DoNotOptimize(reader.open(path));
+    }
+    state.SetItemsProcessed(state.iterations() * spec.bodies);
+}
+
+// Traversal alone, over range(0) bodies and range(1) instances
+static void BM_CollectMeshes(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies         = static_cast<int>(state.range(0));
+    spec.instances      = static_cast<int>(state.range(1));
+    spec.faces_per_body = 200;
+    ufd::StageReader reader;
+    reader.open(bench::scene_file(spec));
+
+    for (auto _ : state) {
+        auto meshes = reader.collect_meshes();
+        benchmark::DoNotOptimize(meshes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * (spec.bodies + spec.instances));
+}
+
+// The same traversal, pulled one mesh at a time
+static void BM_MeshStream(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies         = static_cast<int>(state.range(0));
+    spec.faces_per_body = 200;
+    ufd::StageReader reader;
+    reader.open(bench::scene_file(spec));
+
+    for (auto _ : state) {
+        ufd::MeshStream stream(reader.get_stage());
+        UsdGeomMesh mesh;
+        while (stream.next(mesh)) benchmark::DoNotOptimize(mesh);
+    }
+    state.SetItemsProcessed(state.iterations() * spec.bodies);
+}
+
+BENCHMARK(BM_StageOpen)->Arg(8)->Arg(64)->Arg(512)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CollectMeshes)
+    ->Args({1000, 0})->Args({10000, 0})->Args({100, 10000})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_MeshStream)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
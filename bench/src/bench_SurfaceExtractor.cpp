@@ -0,0 +1,143 @@
+#include "SceneGenerator.h"
+
+#include <ufd/SurfaceExtractor.h>
+
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/xform.h>
+#include <pxr/usd/usdGeom/xformCache.h>
+#include <pxr/usd/sdf/path.h>
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+// In-memory stage of prims quad grids of nx * ny faces, each under its own
+// translated Xform.
+static UsdStageRefPtr make_grid_stage(int prims, int nx, int ny) {
+    auto stage = UsdStage::CreateInMemory();
+
+    VtVec3fArray points;
+    for (int j = 0; j <= ny; ++j)
+        for (int i = 0; i <= nx; ++i)
+            points.push_back(GfVec3f(float(i), float(j), 0.0f));
+    VtIntArray counts(size_t(nx) * ny, 4);
+    VtIntArray indices;
+    for (int j = 0; j < ny; ++j) {
+        for (int i = 0; i < nx; ++i) {
+            const int v = j * (nx + 1) + i;
+            indices.push_back(v);
+            indices.push_back(v + 1);
+            indices.push_back(v + nx + 2);
+            indices.push_back(v + nx + 1);
+        }
+    }
+
+    for (int p = 0; p < prims; ++p) {
+        const std::string part = "/Scene/part_" + std::to_string(p);
+        auto xf = UsdGeomXform::Define(stage, SdfPath(part));
+        xf.AddTranslateOp().Set(GfVec3d(0, 0, p * 0.5));
+        auto mesh = UsdGeomMesh::Define(stage, SdfPath(part + "/mesh"));
+        mesh.GetPointsAttr().Set(points);
+        mesh.GetFaceVertexCountsAttr().Set(counts);
+        mesh.GetFaceVertexIndicesAttr().Set(indices);
+    }
+    return stage;
+}
+
+static std::vector<UsdGeomMesh> stage_meshes(UsdStageRefPtr stage) {
+    std::vector<UsdGeomMesh> meshes;
+    for (const auto& prim : stage->Traverse())
+        if (prim.IsA<UsdGeomMesh>()) meshes.emplace_back(prim);
+    return meshes;
+}
+
+// The former serial, push_back-per-element extract
+static ufd::SurfaceData push_back_extract(const std::vector<UsdGeomMesh>& meshes) {
+    ufd::SurfaceData result;
+    UsdGeomXformCache xform_cache;
+    for (const auto& mesh : meshes) {
+        VtVec3fArray points;
+        VtIntArray   counts, indices;
+        mesh.GetPointsAttr().Get(&points);
+        mesh.GetFaceVertexCountsAttr().Get(&counts);
+        mesh.GetFaceVertexIndicesAttr().Get(&indices);
+        const GfMatrix4d xf = xform_cache.GetLocalToWorldTransform(mesh.GetPrim());
+
+        const int point_offset = static_cast<int>(result.points.size());
+        for (const auto& pt : points) {
+            const GfVec3d w = xf.Transform(GfVec3d(pt[0], pt[1], pt[2]));
+            result.points.push_back(GfVec3f(w[0], w[1], w[2]));
+        }
+        for (int c : counts)  result.face_vertex_counts.push_back(c);
+        for (int i : indices) result.face_vertex_indices.push_back(i + point_offset);
+    }
+    return result;
+}
+
+// 10M faces over 5,000 prims: 40 x 50 quads each
+static const std::vector<UsdGeomMesh>& big_scene() {
+    static UsdStageRefPtr stage = make_grid_stage(5000, 40, 50);
+    static std::vector<UsdGeomMesh> meshes = stage_meshes(stage);
+    return meshes;
+}
+
+static void BM_ExtractPushBack(benchmark::State& state) {
+    const auto& meshes = big_scene();
+    for (auto _ : state) {
+        auto surface = push_back_extract(meshes);
+        benchmark::DoNotOptimize(surface.points.cdata());
+    }
+    state.SetItemsProcessed(state.iterations() * 10000000);
+}
+
+static void BM_Extract(benchmark::State& state) {
+    const auto& meshes = big_scene();
+    ufd::SurfaceExtractor extractor;
+    for (auto _ : state) {
+        auto surface = extractor.extract(meshes);
+        benchmark::DoNotOptimize(surface.points.cdata());
+    }
+    state.SetItemsProcessed(state.iterations() * 10000000);
+}
+
+// Bounds through a merged surface, as main did before compute_world_bounds
+static void BM_BoundsFromExtract(benchmark::State& state) {
+    const auto& meshes = big_scene();
+    ufd::SurfaceExtractor extractor;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            extractor.compute_bounding_box(extractor.extract(meshes)));
+    }
+}
+
+static void BM_WorldBounds(benchmark::State& state) {
+    const auto& meshes = big_scene();
+    ufd::SurfaceExtractor extractor;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(extractor.compute_world_bounds(meshes));
+    }
+}
+
+// 100 generated spheres of range(0) faces each, up to 10M faces in all
+static void BM_ExtractSpheres(benchmark::State& state) {
+    bench::SceneSpec spec;
+    spec.bodies         = 100;
+    spec.faces_per_body = static_cast<size_t>(state.range(0));
+    const auto stage  = bench::make_scene(spec);
+    const auto meshes = bench::scene_meshes(stage);
+    ufd::SurfaceExtractor extractor;
+    for (auto _ : state) {
+        auto surface = extractor.extract(meshes);
+        benchmark::DoNotOptimize(surface.points.cdata());
+    }
+    state.SetItemsProcessed(state.iterations() * bench::scene_face_count(spec));
+}
+
+BENCHMARK(BM_ExtractPushBack)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Extract)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BoundsFromExtract)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WorldBounds)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ExtractSpheres)
+    ->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
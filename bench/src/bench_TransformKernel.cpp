@@ -0,0 +1,74 @@
+#include <ufd/TransformKernel.h>
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/rotation.h>
+#include <pxr/base/gf/vec3d.h>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Rotation, scale and translation, as a typical part's world transform
+static GfMatrix4d part_xform() {
+    GfMatrix4d m;
+    m.SetRotate(GfRotation(GfVec3d(1, 2, 3), 37.0));
+    GfMatrix4d scale;
+    scale.SetScale(GfVec3d(1.5, 0.25, 3.0));
+    return scale * m * GfMatrix4d().SetTranslate(GfVec3d(10.5, -3.25, 7.125));
+}
+
+static std::vector<float> random_points(size_t count) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    std::vector<float> pts(3 * count);
+    for (auto& c : pts) c = coord(rng);
+    return pts;
+}
+
+// The per-point loop transform_points replaced
+static void BM_GfTransformLoop(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const auto in = random_points(count);
+    std::vector<float> out(in.size());
+    const GfMatrix4d m = part_xform();
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < in.size(); i += 3) {
+            const GfVec3d p = m.Transform(GfVec3d(in[i], in[i + 1], in[i + 2]));
+            out[i]     = static_cast<float>(p[0]);
+            out[i + 1] = static_cast<float>(p[1]);
+            out[i + 2] = static_cast<float>(p[2]);
+        }
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * 6 * sizeof(float));
+}
+
+static void BM_TransformPoints(benchmark::State& state, ufd::SimdLevel level) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const auto in = random_points(count);
+    std::vector<float> out(in.size());
+    const GfMatrix4d m = part_xform();
+
+    state.SetLabel(ufd::to_string(std::min(level, ufd::detected_simd_level())));
+    for (auto _ : state) {
+        ufd::transform_points(m, in.data(), out.data(), count, level);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+    state.SetBytesProcessed(state.iterations() * count * 6 * sizeof(float));
+}
+
+// 1M to 100M points; the largest needs about 2.4 GB for both buffers
+#define UFD_POINT_COUNTS \
+    Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond)
+
+BENCHMARK(BM_GfTransformLoop)->UFD_POINT_COUNTS;
+BENCHMARK_CAPTURE(BM_TransformPoints, scalar, ufd::SimdLevel::Scalar)->UFD_POINT_COUNTS;
+BENCHMARK_CAPTURE(BM_TransformPoints, sse2,   ufd::SimdLevel::SSE2)->UFD_POINT_COUNTS;
+BENCHMARK_CAPTURE(BM_TransformPoints, avx2,   ufd::SimdLevel::AVX2)->UFD_POINT_COUNTS;
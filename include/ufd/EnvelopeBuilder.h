@@ -1,39 +1,248 @@
 #pragma once
 
+#include <ufd/SdfExport.h>
+
+#include <pxr/base/gf/range3d.h>
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usdGeom/mesh.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
 namespace ufd {
 
+class GeometryCache;
+class MeshSdfStore;
+class MeshStream;
+class SdfCache;
+
+// How the input meshes are turned into a single SDF before closing.
+enum class VoxelizeMode {
+    Auto,     // choose from face-count statistics of the input
+    PerMesh,  // one narrow-band SDF per mesh, unioned
+    Soup,     // all meshes merged into one world-space soup, voxelized once
+};
+
+// How morphological closing bridges holes smaller than hole_threshold.
+enum class ClosingMode {
+    LevelSet,  // offset the SDF out and back in, with a levelSetRebuild after
+               // each step; exact distances, needs a band wider than the radius
+    Topology,  // close the interior voxel mask and rebuild the SDF only where
+               // voxels were added; much faster, staircase accurate on bridges
+};
+
 struct EnvelopeConfig {
     double voxel_size     = 0.1;  // voxel edge length in world units
     double hole_threshold = 0.5;  // morphological closing radius in world units;
                                   // holes smaller than this are bridged
+    bool   parallel       = true; // voxelize meshes as parallel tasks and union
+                                  // them pairwise; false folds them serially.
+                                  // Covers voxelization and union only: reading
+                                  // geometry (GeometryCache) and OpenVDB's own
+                                  // tools stay multithreaded
+    VoxelizeMode mode     = VoxelizeMode::Auto;
+    size_t soup_max_mean_faces = 256;  // Auto picks Soup when meshes average
+                                       // at most this many polygons ...
+    size_t soup_min_meshes     = 64;   // ... and there are at least this many,
+                                       // so small inputs keep PerMesh output;
+                                       // duplicates are not counted
+    bool   reuse_prototypes = true;  // voxelize duplicated geometry once and
+                                     // stamp it under each rigid instance xform;
+                                     // in Auto mode only the unique remainder
+                                     // can go to a soup. Off in Soup mode
+    ClosingMode closing   = ClosingMode::LevelSet;
+    int    coarse_factor  = 1;    // >1 builds and closes the SDF at
+                                  // voxel_size * coarse_factor, then
+                                  // re-voxelizes only geometry near the coarse
+                                  // surface at voxel_size and merges the two
+    double adaptivity     = 0.0;  // VolumeToMesh adaptivity in [0, 1]; 0 emits
+                                  // about one quad per surface voxel
+    size_t target_face_count = 0;  // if non-zero, raise adaptivity (from the
+                                   // value above) until the envelope fits
+    bool   preserve_features = true;  // scale adaptivity down with surface
+                                      // curvature so edges and thin parts
+                                      // keep full resolution
+    SdfFormat sdf_format  = SdfFormat::Dense;  // layout of the sdf_path export
 };
 
+// How a tiled build splits world space into bricks; see
+// EnvelopeBuilder::build_tiled.
+struct TileConfig {
+    double      brick_size    = 0.0;  // brick edge in world units, rounded up
+                                      // to whole 8-voxel leaves; 0 sizes
+                                      // bricks from memory_budget
+    uint64_t    memory_budget = 0;    // bytes of a brick's own grids; shells
+                                      // wider than a brick add their SDF on
+                                      // top.  0 with no brick_size builds a
+                                      // single brick
+    std::string spill_dir;            // brick meshes are written here
+};
+
+// Brick layout of a tiled build and the bricks each mesh reaches, fixed
+// once from all the geometry.  A process spreading bricks over workers
+// writes it to the spill directory and drops its geometry; each worker
+// reads it back and loads only the meshes reaching its own bricks.
+struct TilePlan {
+    double voxel_size = 0.0;
+    int    origin[3]  = {0, 0, 0};  // index of brick 0's first voxel
+    int    counts[3]  = {0, 0, 0};  // bricks per axis
+    int    brick_vox  = 0;          // brick edge in voxels
+    int    overlap    = 0;          // voxels a brick reads beyond its own
+    size_t face_count = 0;          // input polygons over all meshes
+    std::vector<std::string>        mesh_paths;   // prim path of each mesh
+    std::vector<std::array<int, 6>> mesh_bricks;  // first and last brick per
+                                                  // axis a mesh's band
+                                                  // reaches; empty if first
+                                                  // exceeds last
+
+    size_t brick_count() const;
+    // Brick indices [first, last) of worker out of workers: a contiguous
+    // run, so a worker's bricks are neighbours and share their meshes.
+    std::pair<size_t, size_t> worker_bricks(size_t worker, size_t workers) const;
+    // Indices into mesh_paths of the meshes reaching a brick of worker.
+    std::vector<size_t> worker_meshes(size_t worker, size_t workers) const;
+
+    // Text round trip; false if the file cannot be written or read.
+    bool write(const std::string& path) const;
+    bool read(const std::string& path);
+};
+
+// Summary of a build, filled in when a stats pointer is passed to build().
+struct EnvelopeStats {
+    VoxelizeMode mode       = VoxelizeMode::Auto;  // mode actually used
+    size_t       mesh_count = 0;
+    size_t       face_count = 0;  // input polygons after n-gon triangulation
+    size_t       prototype_count = 0;  // distinct SDFs reused by duplicates
+    size_t       stamped_count   = 0;  // meshes stamped instead of voxelized
+    bool         cache_hit  = false;  // closed SDF was loaded from the cache
+    size_t       voxelized_count   = 0;  // incremental: meshes re-voxelized
+    size_t       reused_mesh_count = 0;  // incremental: stored SDFs reused
+    size_t       refined_face_count = 0;  // coarse-to-fine: input polygons
+                                          // re-voxelized at the fine size
+    size_t       active_voxel_count = 0;  // active voxels of the closed SDF
+    size_t       sdf_bytes = 0;   // memUsage() of the closed SDF
+    double       adaptivity = 0.0;    // adaptivity the envelope was meshed with
+    size_t       envelope_face_count = 0;  // polygons written to /Envelope
+    double       max_deviation = 0.0;  // largest |SDF| at an output vertex or
+                                       // face centroid, in world units
+    size_t       brick_count = 0;  // tiled: bricks built; sdf_bytes is then
+                                   // the largest brick's closed SDF
+};
+
+const char* to_string(VoxelizeMode mode);
+const char* to_string(ClosingMode mode);
+
 // Builds a watertight outer envelope surface from one or more meshes using
 // OpenVDB signed distance fields.  Meshes are unioned, then morphological
 // closing is applied to bridge small holes, and the resulting SDF is
 // iso-surfaced back into a polygon mesh.
 class EnvelopeBuilder {
 public:
-    explicit EnvelopeBuilder(const EnvelopeConfig& config = {});
+    // cache: optional on-disk store of closed SDFs; when set, a build whose
+    // geometry and config match a stored entry skips voxelization and closing.
+    // store: optional per-mesh SDFs of earlier builds; when set, the build is
+    // incremental: only meshes that changed since the last build are
+    // re-voxelized, and the union and closing are redone only where the
+    // changes reach.  Not combined with coarse_factor > 1.
+    explicit EnvelopeBuilder(const EnvelopeConfig& config = {},
+                             SdfCache* cache = nullptr,
+                             MeshSdfStore* store = nullptr);
 
     // Build the envelope and write a /Envelope UsdGeomMesh to stage.  Meshes
     // are read with their USD world-space transforms applied.  Returns the
     // prim path "/Envelope" on success, or an empty string if meshes is empty.
-    // sdf_path: if non-empty, the closed SDF is saved as a raw binary for Python.
+    // sdf_path: if non-empty, the closed SDF is saved for Python in
+    // config.sdf_format.
+    // stats: if non-null, receives a summary of the build.
     std::string build(UsdStageRefPtr stage,
                       const std::vector<UsdGeomMesh>& meshes,
-                      const std::string& sdf_path = {}) const;
+                      const std::string& sdf_path = {},
+                      EnvelopeStats* stats = nullptr) const;
+
+    // The same from geometry already read, e.g. shared with the bounds
+    // computation.
+    std::string build(UsdStageRefPtr stage,
+                      const GeometryCache& geometry,
+                      const std::string& sdf_path = {},
+                      EnvelopeStats* stats = nullptr) const;
+
+    // Streaming build for stages whose traversal and attribute reads take as
+    // long as the voxelization: meshes are pulled from the stream in batches,
+    // and each batch is read, voxelized and unioned while the traversal
+    // finds the next.  Always PerMesh, without prototype reuse, cache or
+    // store, since those need every mesh up front; closing, export and
+    // meshing are as in build().
+    // bounds: if non-null, receives the world bounds of the streamed
+    // geometry, reduced in the same pass.
+    std::string build_streamed(UsdStageRefPtr stage,
+                               MeshStream& meshes,
+                               const std::string& sdf_path = {},
+                               EnvelopeStats* stats = nullptr,
+                               GfRange3d* bounds = nullptr) const;
+
+    // Build one envelope per time code and author them as time samples of a
+    // single /Envelope mesh (points and topology).  Mesh points and world
+    // transforms are evaluated at each time; a mesh whose world geometry is
+    // unchanged from an earlier sample reuses that sample's SDF, and frames
+    // are unioned, closed and meshed in parallel, one batch of a frame per
+    // thread at a time; a sample's SDF is freed after the last frame using
+    // it.  Frames with an empty envelope are authored empty and reported on
+    // stderr.  Uses neither the SDF cache nor a mesh store, and writes no
+    // SDF export.
+    // stats: if non-null, resized to one summary per time code;
+    // voxelized_count counts the meshes that needed a new SDF at that frame.
+    std::string build_animated(UsdStageRefPtr stage,
+                               const std::vector<UsdGeomMesh>& meshes,
+                               const std::vector<UsdTimeCode>& times,
+                               std::vector<EnvelopeStats>* stats = nullptr) const;
+
+    // Out-of-core build for scenes whose SDF does not fit in memory.  World
+    // space is split into cubic bricks; each brick is voxelized from the
+    // meshes that reach it, over the brick plus an overlap covering the
+    // closing reach and the band, then closed and meshed within the brick
+    // alone.  Brick meshes are spilled to tiles.spill_dir and stitched into
+    // one watertight /Envelope by welding the vertices bricks share on their
+    // seams.  Only one brick's grids are held at a time.  Meshes wider than
+    // a brick are split into their connected shells first, but a shell
+    // reaching a brick is still voxelized whole before being clipped to it,
+    // so the brick's peak memory includes the SDF of its largest shell on
+    // top of tiles.memory_budget.  Meshes at
+    // adaptivity 0, since merged polygons would not match across seams, and
+    // uses no cache or store and writes no SDF export.
+    std::string build_tiled(UsdStageRefPtr stage,
+                            const GeometryCache& geometry,
+                            const TileConfig& tiles,
+                            EnvelopeStats* stats = nullptr) const;
+
+    // The parts of build_tiled, for spreading bricks over processes.
+    // plan_tiles lays the bricks out over all the geometry.  build_bricks
+    // builds and spills plan.worker_bricks(worker, workers) from geometry,
+    // which needs to hold only plan.worker_meshes(worker, workers); once all
+    // workers are done, stitch_bricks writes /Envelope from the spilled
+    // bricks.  Every call must see the same config, tiles and plan.
+    // build_bricks returns false and stitch_bricks an empty string if a
+    // brick cannot be written or read.
+    TilePlan plan_tiles(const GeometryCache& geometry,
+                        const TileConfig& tiles) const;
+    bool build_bricks(const GeometryCache& geometry,
+                      const TilePlan& plan,
+                      const TileConfig& tiles,
+                      size_t worker = 0, size_t workers = 1) const;
+    std::string stitch_bricks(UsdStageRefPtr stage,
+                              const TilePlan& plan,
+                              const TileConfig& tiles,
+                              EnvelopeStats* stats = nullptr) const;
 
 private:
     EnvelopeConfig config_;
+    SdfCache*      cache_ = nullptr;
+    MeshSdfStore*  store_ = nullptr;
 };
 
 } // namespace ufd
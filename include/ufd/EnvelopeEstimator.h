@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/GeometryCache.h>
+
+#include <pxr/base/gf/range3d.h>
+
+#include <cstdint>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace ufd {
+
+// Predicted cost of an EnvelopeBuilder run for one config.
+struct EnvelopeEstimate {
+    double   voxel_size         = 0.0;
+    uint64_t active_voxels      = 0;  // active voxels of the closed SDF
+    uint64_t grid_bytes         = 0;  // memUsage() of the closed SDF
+    uint64_t peak_grid_bytes    = 0;  // most memory held in grids at once
+    uint64_t geometry_bytes     = 0;  // world-space input buffers, held for
+                                      // the whole build
+    uint64_t peak_bytes         = 0;  // most memory held at once: grids,
+                                      // input buffers and any soup copy
+    uint64_t dense_export_bytes = 0;  // size of an SdfFormat::Dense export
+    uint64_t face_count         = 0;  // /Envelope polygons at adaptivity 0
+};
+
+// Dry-run cost model for EnvelopeBuilder, computed from the input surface
+// area and bounding box alone (see SurfaceExtractor), without voxelizing.
+//
+// Narrow-band grids are modelled as the shell of voxels within the band of
+// the surface: inside, area times depth up to the enclosed volume; outside,
+// the Steiner volume of the bounding box offset by the band.  The closed
+// envelope's area is taken as the smaller of the input area and the
+// bounding-box surface, which is close for convex parts and blocky
+// assemblies and low for concavities wider than hole_threshold.
+//
+// Given the GeometryCache the build will read from, the peak also counts its
+// buffers, the merged copy a Soup voxelization makes of them, and the
+// per-mesh grids a parallel PerMesh voxelization keeps alive at once (one
+// per worker thread).  Without it only grids are counted.
+class EnvelopeEstimator {
+public:
+    EnvelopeEstimator(double surface_area, const GfRange3d& bounds);
+    EnvelopeEstimator(double surface_area, const GfRange3d& bounds,
+                      const GeometryCache& geometry);
+
+    EnvelopeEstimate estimate(const EnvelopeConfig& config) const;
+
+    // Finest voxel size whose predicted peak memory fits budget_bytes,
+    // all other config fields as given.  Returns the largest voxel size
+    // considered (the longest bounding-box edge) if nothing fits.
+    double fit_voxel_size(const EnvelopeConfig& config,
+                          uint64_t budget_bytes) const;
+
+private:
+    double    surface_area_;
+    GfRange3d bounds_;
+    size_t    mesh_count_     = 0;  // 0 when no GeometryCache was given
+    size_t    face_count_     = 0;
+    uint64_t  geometry_bytes_ = 0;
+};
+
+} // namespace ufd
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <openvdb/openvdb.h>
+
+#include <pxr/usd/usd/timeCode.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/base/gf/matrix4d.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace ufd {
+
+// World-space polygon soup of a single mesh, in the form meshToVolume
+// expects: quads kept, other n-gons fan-triangulated.
+struct MeshGeometry {
+    std::vector<openvdb::Vec3s> points;
+    std::vector<openvdb::Vec3I> triangles;
+    std::vector<openvdb::Vec4I> quads;
+    uint64_t content_hash = 0;  // local-space points and topology
+};
+
+// Read a mesh's points and topology at time and transform the points by
+// world_xform.
+MeshGeometry read_mesh_geometry(const UsdGeomMesh& mesh,
+                                const GfMatrix4d& world_xform,
+                                UsdTimeCode time = UsdTimeCode::Default());
+
+// Polygons of geom: triangles plus quads.
+size_t face_count(const MeshGeometry& geom);
+
+// The input meshes read from USD once per run: world transforms resolved
+// with one UsdGeomXformCache, then points and topology of every prim read
+// and transformed as parallel tasks.  SurfaceExtractor's bounds and area and
+// EnvelopeBuilder all consume the same buffers, so no attribute is decoded
+// twice.
+class GeometryCache {
+public:
+    explicit GeometryCache(const std::vector<UsdGeomMesh>& meshes,
+                           UsdTimeCode time = UsdTimeCode::Default());
+
+    const std::vector<UsdGeomMesh>&  meshes()       const { return meshes_; }
+    const std::vector<GfMatrix4d>&   world_xforms() const { return world_xforms_; }
+    const std::vector<MeshGeometry>& geometry()     const { return geometry_; }
+
+    size_t size()  const { return meshes_.size(); }
+    bool   empty() const { return meshes_.empty(); }
+
+    // Polygons over all meshes, after n-gon triangulation.
+    size_t face_count() const;
+
+private:
+    std::vector<UsdGeomMesh>  meshes_;
+    std::vector<GfMatrix4d>   world_xforms_;
+    std::vector<MeshGeometry> geometry_;
+};
+
+} // namespace ufd
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <pxr/base/vt/array.h>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace ufd {
+
+// Finalizer from MurmurHash3; spreads every input bit over the whole word.
+inline uint64_t hash_mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+inline uint64_t hash_combine(uint64_t seed, uint64_t value) {
+    return hash_mix(seed ^ (value + 0x9e3779b97f4a7c15ULL
+                            + (seed << 6) + (seed >> 2)));
+}
+
+// Non-cryptographic 64-bit content hash of a byte range, consumed a word at a
+// time.  Stable across runs and platforms of the same endianness, so it can
+// key on-disk caches.
+inline uint64_t hash_bytes(const void* data, size_t size, uint64_t seed = 0) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    uint64_t h = hash_mix(seed ^ (size * 0x9e3779b97f4a7c15ULL));
+    for (; size >= 8; p += 8, size -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = hash_mix(h ^ word);
+    }
+    if (size > 0) {
+        uint64_t tail = 0;
+        std::memcpy(&tail, p, size);
+        h = hash_mix(h ^ tail);
+    }
+    return h;
+}
+
+template <typename T>
+uint64_t hash_array(const VtArray<T>& array, uint64_t seed = 0) {
+    return hash_bytes(array.cdata(), array.size() * sizeof(T), seed);
+}
+
+} // namespace ufd
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <ufd/SurfaceExtractor.h>
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tools/VolumeToMesh.h>
+
+namespace ufd {
+
+// Copy VolumeToMesh output into USD-ready arrays.  Per-pool offsets come from
+// a prefix sum, so every array is sized once and pools are filled in
+// parallel without VtArray push_back or copy-on-write checks per element.
+// Quads come before triangles within each pool, pools in mesher order.
+// flip_winding: VolumeToMesh winds polygons with normals pointing inward;
+// true (the default) reverses them to point outward.
+SurfaceData gather_mesh(const openvdb::tools::VolumeToMesh& mesher,
+                        bool flip_winding = true);
+
+} // namespace ufd
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <openvdb/openvdb.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ufd {
+
+// Narrow-band SDFs of individual meshes and the closed result of the last
+// build, kept between EnvelopeBuilder runs so an incremental build only
+// re-voxelizes meshes that changed.  Entries are keyed by prim path and
+// validated by a content key (world-space geometry plus voxelization
+// settings).  Entries always live in memory; with a directory they are also
+// mirrored to disk, one native .vdb file per mesh, so a later process can
+// pick them up.  Returned grids are shared and must not be modified.  Safe to
+// share between threads.
+class MeshSdfStore {
+public:
+    // The closed SDF of a build and the inputs it was built from.
+    struct Build {
+        uint64_t settings_key = 0;  // config fields that change the SDF
+        std::unordered_map<std::string, uint64_t> mesh_keys;  // by prim path
+        openvdb::FloatGrid::Ptr closed;  // nullptr if there was no build
+    };
+
+    // directory: if non-empty, entries are also read from and written to it;
+    // it is created if needed.
+    explicit MeshSdfStore(const std::string& directory = {});
+
+    // SDF stored for path under key, or nullptr if missing or stale.
+    openvdb::FloatGrid::Ptr find(const std::string& path, uint64_t key);
+
+    void put(const std::string& path, uint64_t key, openvdb::FloatGrid::Ptr sdf);
+    void erase(const std::string& path);
+
+    // Most recent build recorded with set_last_build, from disk if this
+    // instance has not recorded one yet.
+    Build last_build();
+    void  set_last_build(const Build& build);
+
+    // Number of mesh SDFs held in memory.
+    size_t size() const;
+
+private:
+    struct Entry {
+        uint64_t                key = 0;
+        openvdb::FloatGrid::Ptr sdf;
+    };
+
+    std::string file_for(const std::string& path) const;
+    Build       read_last_build() const;
+
+    std::string directory_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    Build last_;
+    bool  last_loaded_ = false;
+};
+
+} // namespace ufd
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <ufd/Trace.h>
+
+#include <openvdb/Grid.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ufd {
+
+// Time and memory spent in one pipeline phase, e.g. "closing".  A phase may
+// be entered many times, and from several threads at once (one entry per
+// mesh for "voxelize_mesh"); wall and CPU time then cover the intervals in
+// which at least one entry was open, so overlapping entries are not counted
+// twice.
+struct PhaseMetrics {
+    std::string name;
+    size_t   count        = 0;    // times the phase was entered
+    double   wall_seconds = 0.0;  // elapsed time with the phase open
+    double   cpu_seconds  = 0.0;  // process CPU time (all threads) over the
+                                  // same intervals
+    double   busy_seconds = 0.0;  // entry durations summed; exceeds
+                                  // wall_seconds when entries overlap
+    double   max_seconds  = 0.0;  // longest single entry
+    uint64_t rss_begin_bytes = 0; // resident set size when the phase was
+    uint64_t rss_end_bytes   = 0; // last opened and when it last closed
+};
+
+// Size of a grid at some point of the pipeline, e.g. the closed SDF.
+struct GridMetrics {
+    std::string name;
+    uint64_t active_voxels = 0;
+    uint64_t leaf_count    = 0;
+    uint64_t mem_bytes     = 0;   // memUsage()
+    double   voxel_size    = 0.0;
+};
+
+// Per-phase timing, memory and grid statistics of a run, written as JSON so
+// runs can be compared across model revisions.  Recording is off until
+// set_enabled(true); while off, every call returns after one atomic load.
+// Safe to share between threads.
+class Metrics {
+public:
+    // The recorder the library's own phases report to.
+    static Metrics& global();
+
+    void set_enabled(bool enabled);
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Drop everything recorded so far, e.g. between watch-mode rebuilds.
+    void reset();
+
+    // Open and close one entry of a phase; see ScopedPhase.
+    void begin_phase(const char* name);
+    void end_phase(const char* name, double seconds);
+
+    // Record the size of grid under name.
+    void record_grid(const char* name, const openvdb::GridBase& grid);
+
+    // Record a named figure of the run, e.g. "mesh_count", or a string such
+    // as the input path.
+    void set_value(const std::string& name, double value);
+    void set_value(const std::string& name, const std::string& value);
+
+    // Phases in the order they were first entered, and grids in the order
+    // they were recorded.
+    std::vector<PhaseMetrics> phases() const;
+    std::vector<GridMetrics>  grids() const;
+
+    std::string to_json() const;
+
+    // Write to_json() to path; false if the file cannot be written.
+    bool write_json(const std::string& path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase {
+        PhaseMetrics      metrics;
+        size_t            open = 0;  // entries currently open
+        Clock::time_point wall_start;
+        double            cpu_start = 0.0;
+        uint64_t          rss_start = 0;
+    };
+
+    Phase& phase(const char* name);  // called with mutex_ held
+
+    std::atomic<bool>  enabled_{false};
+    mutable std::mutex mutex_;
+    std::vector<Phase>       phases_;
+    std::vector<GridMetrics> grids_;
+    std::vector<std::pair<std::string, std::string>> values_;  // name, JSON
+};
+
+// Records the enclosing scope as one entry of a phase of metrics, by default
+// Metrics::global(), and as a trace span of the same name.  name must
+// outlive the scope; string literals are used throughout.
+class ScopedPhase {
+public:
+    explicit ScopedPhase(const char* name);
+    ScopedPhase(Metrics& metrics, const char* name);
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+#ifdef UFD_TRACING
+    TraceScope  span_;
+#endif
+    Metrics*    metrics_;  // null while recording is off
+    const char* name_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace ufd
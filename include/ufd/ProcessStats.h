@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ufd {
+
+// Resident memory and CPU time of this process, for reporting what a stage
+// open or a build costs.  All return 0 where the platform offers no figure.
+
+// Resident set size now, in bytes.
+uint64_t current_rss_bytes();
+
+// Largest resident set size so far, in bytes.
+uint64_t peak_rss_bytes();
+
+// User plus system CPU time of all threads so far, in seconds.
+double process_cpu_seconds();
+
+// A sibling of path, "<path>.tmp.<pid>.<n>", that no other call in this or
+// any other process returns, for writing a file that is then renamed over
+// path.
+std::string unique_temp_path(const std::string& path);
+
+} // namespace ufd
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <openvdb/openvdb.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace ufd {
+
+struct SdfCacheStats {
+    size_t   hits          = 0;
+    size_t   misses        = 0;
+    uint64_t bytes_saved   = 0;  // in-memory size of SDFs served from disk
+    uint64_t bytes_written = 0;  // size of .vdb files added to the cache
+    size_t   evictions     = 0;
+};
+
+// Content-addressed directory of closed SDFs, one native .vdb file per key.
+// Entries are evicted least-recently-used first once the directory exceeds
+// max_bytes; a hit refreshes the entry's modification time.  Safe to share
+// between threads.
+class SdfCache {
+public:
+    // max_bytes == 0 means no size cap.  The directory is created if needed.
+    explicit SdfCache(const std::string& directory, uint64_t max_bytes = 0);
+
+    // Load the SDF stored under key, or return nullptr on a miss.
+    openvdb::FloatGrid::Ptr load(uint64_t key);
+
+    // Store an SDF under key, then evict old entries down to the size cap.
+    void store(uint64_t key, openvdb::FloatGrid::Ptr grid);
+
+    SdfCacheStats stats() const;
+
+    // Path of the .vdb file for a key.
+    std::string path_for(uint64_t key) const;
+
+private:
+    std::string directory_;
+    uint64_t    max_bytes_;
+
+    mutable std::mutex mutex_;
+    SdfCacheStats      stats_;
+
+    // Remove least-recently-used entries until the cache fits max_bytes_.
+    void evict();
+};
+
+} // namespace ufd
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <openvdb/openvdb.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ufd {
+
+// On-disk formats for the closed envelope SDF.
+enum class SdfFormat {
+    // Raw dense dump of the active bounding box:
+    //   int32 nx,ny,nz  float32 ox,oy,oz,voxel_size,background
+    //   then nx*ny*nz float32, C-order with x slowest:
+    //   data[ix*ny*nz + iy*nz + iz] = value at (ix,iy,iz)
+    // Streamed from the tree one x-slab at a time.
+    Dense,
+
+    // Sparse dump of the VDB leaf blocks and constant tiles, all little-endian:
+    //   header (64 bytes)
+    //     char[8] magic "UFDSSDF\0", uint32 version (1), uint32 block_dim (8),
+    //     float32 voxel_size, float32 background,
+    //     int32[3] bbox_min, int32[3] bbox_max   (active index bbox, inclusive)
+    //     uint64 leaf_count, uint64 tile_count
+    //   leaf_count x { int32[3] origin; float32[8][8][8] values }   (2060 bytes)
+    //     values[x][y][z] is the voxel at origin + (x,y,z)
+    //   tile_count x { int32[3] origin; int32 dim; float32 value }  (20 bytes)
+    //     a dim^3 cube of constant value, e.g. the SDF interior
+    // Every voxel not covered by a leaf or tile equals background.  World
+    // position of voxel (i,j,k) is (i,j,k) * voxel_size.
+    //
+    // NumPy:
+    //   hdr  = np.dtype([('magic','S8'), ('version','<u4'), ('block_dim','<u4'),
+    //                    ('voxel_size','<f4'), ('background','<f4'),
+    //                    ('bbox_min','<i4',3), ('bbox_max','<i4',3),
+    //                    ('leaf_count','<u8'), ('tile_count','<u8')])
+    //   leaf = np.dtype([('origin','<i4',3), ('values','<f4',(8,8,8))])
+    //   tile = np.dtype([('origin','<i4',3), ('dim','<i4'), ('value','<f4')])
+    //   h  = np.fromfile(f, hdr, 1)[0]
+    //   lv = np.fromfile(f, leaf, h['leaf_count'], offset=64)
+    //   tv = np.fromfile(f, tile, h['tile_count'],
+    //                    offset=64 + leaf.itemsize * h['leaf_count'])
+    Sparse,
+
+    // NumPy .npy (v1.0, '<f4', C-order, shape (nx, ny, nz)) of the active
+    // bounding box, streamed one x-slab at a time so peak memory is one slab.
+    // Load with np.load(path, mmap_mode='r').  Origin, voxel size and
+    // background go to a "<path>.json" sidecar.
+    Npy,
+};
+
+const char* to_string(SdfFormat format);
+
+// Write grid to path in the given format.  Throws std::runtime_error on I/O
+// failure.
+void write_sdf(const openvdb::FloatGrid& grid,
+               const std::string& path,
+               SdfFormat format);
+
+// In-memory form of an SdfFormat::Sparse file; does not depend on OpenVDB.
+struct SparseSdfLeaf {
+    std::array<int32_t, 3>   origin;
+    std::array<float, 512>   values;  // [x][y][z], x slowest
+};
+
+struct SparseSdfTile {
+    std::array<int32_t, 3> origin;
+    int32_t                dim;
+    float                  value;
+};
+
+struct SparseSdf {
+    float                      voxel_size = 0.0f;
+    float                      background = 0.0f;
+    std::array<int32_t, 3>     bbox_min{};
+    std::array<int32_t, 3>     bbox_max{};
+    std::vector<SparseSdfLeaf> leaves;
+    std::vector<SparseSdfTile> tiles;
+
+    // Dense C-order copy (x slowest) of the inclusive index box [min, max].
+    std::vector<float> dense(const std::array<int32_t, 3>& min,
+                             const std::array<int32_t, 3>& max) const;
+};
+
+// Read an SdfFormat::Sparse file.  Throws std::runtime_error on a malformed
+// or unreadable file.
+SparseSdf read_sparse_sdf(const std::string& path);
+
+} // namespace ufd
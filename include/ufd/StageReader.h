@@ -1,8 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usdGeom/mesh.h>
 
@@ -10,13 +17,66 @@ PXR_NAMESPACE_USING_DIRECTIVE
 
 namespace ufd {
 
+// Which meshes collect_meshes keeps.  A prim that fails a test inherited by
+// its descendants (purpose, visibility, an exclude pattern or kind) prunes
+// its whole subtree.  The default keeps every mesh.
+struct TraversalFilter {
+    std::vector<TfToken> purposes;   // computed purposes to keep, e.g.
+                                     // "default" and "render"; empty keeps all
+    bool visible_only = false;       // skip subtrees authored invisible
+    std::vector<std::string> include;  // path patterns; if non-empty a mesh
+                                       // is kept only if it or an ancestor
+                                       // matches one
+    std::vector<std::string> exclude;  // path patterns whose subtrees are
+                                       // skipped
+    std::vector<TfToken> kinds;          // if non-empty a mesh is kept only
+                                         // under a model of one of these
+                                         // kinds or their subkinds
+    std::vector<TfToken> exclude_kinds;  // models of these kinds or their
+                                         // subkinds are skipped
+
+    // Path patterns are fnmatch(3) globs matched against the whole prim
+    // path, with * also matching '/': "/Plant/*/Interior*", "*_proxy".
+};
+
+// How StageReader::open composes and loads the stage.  The default opens
+// and loads everything, like UsdStage::Open.
+struct StageOpenOptions {
+    std::vector<SdfPath> roots;   // if non-empty, compose only these subtrees
+                                  // (a population mask, so materials, cameras
+                                  // and other geometry elsewhere are never
+                                  // composed) and load only payloads beneath
+                                  // them
+    bool load_payloads   = true;  // false opens with LoadNone and loads no
+                                  // payloads at all
+    bool use_stage_cache = false; // reuse a stage this process already opened
+                                  // from the same file with the same mask.
+                                  // Each open loads or unloads payloads on
+                                  // the shared stage to match load_payloads,
+                                  // so threads must not open or read the
+                                  // same file through the cache at once
+};
+
+// What an open cost, filled in when a stats pointer is passed to open().
+struct StageOpenStats {
+    double  seconds   = 0.0;    // wall time of the open and payload loads
+    int64_t rss_bytes = 0;      // change in the process's resident memory
+                                // across them, other threads' included
+    bool    cache_hit = false;  // the stage came from the stage cache
+};
+
 class StageReader {
 public:
     // Open a USD stage from a file path.
-    bool open(const std::string& usd_file_path);
+    bool open(const std::string& usd_file_path,
+              const StageOpenOptions& options = {},
+              StageOpenStats* stats = nullptr);
 
-    // Traverse the stage and collect all UsdGeomMesh prims.
-    std::vector<UsdGeomMesh> collect_meshes() const;
+    // Traverse the stage and collect the UsdGeomMesh prims that pass filter,
+    // including instance proxies beneath instanceable prims.  Prims with
+    // many children have them traversed as parallel tasks; meshes are
+    // returned in stage order regardless.
+    std::vector<UsdGeomMesh> collect_meshes(const TraversalFilter& filter = {}) const;
 
     // Access the underlying stage.
     UsdStageRefPtr get_stage() const { return stage_; }
@@ -25,4 +85,45 @@ private:
     UsdStageRefPtr stage_;
 };
 
+// Pull-style traversal for pipelining: yields the meshes
+// collect_meshes(filter) would return, in the same order, one at a time, so
+// downstream work starts on the first mesh while the rest of the stage is
+// still being walked.  The walk is serial and only advances when next() is
+// called, so a consumer that pulls at its own pace bounds how far traversal
+// runs ahead.  Not thread-safe; pull from one thread or serial stage at a
+// time.  The stage must outlive the stream.
+class MeshStream {
+public:
+    explicit MeshStream(UsdStageRefPtr stage, const TraversalFilter& filter = {});
+    ~MeshStream();
+
+    MeshStream(const MeshStream&) = delete;
+    MeshStream& operator=(const MeshStream&) = delete;
+
+    // Advance to the next kept mesh; false once the stage is exhausted.
+    bool next(UsdGeomMesh& mesh);
+
+    // Meshes yielded so far.
+    size_t count() const { return count_; }
+
+    // Called with a batch of meshes and their world transforms.
+    using BatchFn = std::function<void(const std::vector<UsdGeomMesh>& meshes,
+                                       const std::vector<GfMatrix4d>& world_xforms)>;
+
+    // Pull every remaining mesh in batches of up to batch_size (0: a few per
+    // worker thread) and hand each batch to fn, resolving transforms at time.
+    // The next batch is pulled while fn works on the current one, so the
+    // traversal overlaps the consumer's work; at most two batches are in
+    // flight and fn sees one at a time, which bounds memory by what fn keeps
+    // per batch.  Returns the meshes handed to fn.
+    size_t for_each_batch(const BatchFn& fn,
+                          UsdTimeCode time = UsdTimeCode::Default(),
+                          size_t batch_size = 0);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+    size_t count_ = 0;
+};
+
 } // namespace ufd
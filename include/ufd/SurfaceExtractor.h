@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include <pxr/usd/usd/timeCode.h>
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/base/gf/range3d.h>
 
@@ -9,6 +10,9 @@ PXR_NAMESPACE_USING_DIRECTIVE
 
 namespace ufd {
 
+class GeometryCache;
+class MeshStream;
+
 struct SurfaceData {
     VtVec3fArray points;
     VtIntArray   face_vertex_counts;
@@ -18,11 +22,43 @@ struct SurfaceData {
 class SurfaceExtractor {
 public:
     // Extract and merge the surface from a set of UsdGeomMesh prims
-    // into a single combined surface representation.
-    SurfaceData extract(const std::vector<UsdGeomMesh>& meshes) const;
+    // into a single combined surface representation.  Points and transforms
+    // are evaluated at time.
+    SurfaceData extract(const std::vector<UsdGeomMesh>& meshes,
+                        UsdTimeCode time = UsdTimeCode::Default()) const;
 
     // Compute the axis-aligned bounding box of the extracted surface.
     GfRange3d compute_bounding_box(const SurfaceData& surface) const;
+
+    // Bounding box of the meshes over all given times: the union of the
+    // per-time boxes from compute_world_bounds.
+    GfRange3d compute_bounding_box(const std::vector<UsdGeomMesh>& meshes,
+                                   const std::vector<UsdTimeCode>& times,
+                                   bool trust_extents = false) const;
+
+    // World-space bounding box of the meshes at time, for callers that need
+    // only the box: nothing is merged or kept.  With trust_extents, a mesh
+    // with an authored extent is bounded by that extent through a
+    // UsdGeomBBoxCache without reading its points; stale extents then give
+    // stale bounds.  Every other mesh is bounded by transform_bounds over
+    // its points, meshes in parallel, which matches
+    // compute_bounding_box(extract(meshes, time)) exactly.
+    GfRange3d compute_world_bounds(const std::vector<UsdGeomMesh>& meshes,
+                                   UsdTimeCode time = UsdTimeCode::Default(),
+                                   bool trust_extents = false) const;
+
+    // The same from points, reduced batch by batch as the stream's traversal
+    // goes on; consumes the stream.
+    GfRange3d compute_world_bounds(MeshStream& meshes,
+                                   UsdTimeCode time = UsdTimeCode::Default()) const;
+
+    // Total area of the extracted surface, with polygons fan-triangulated.
+    double compute_surface_area(const SurfaceData& surface) const;
+
+    // Bounding box and area straight from geometry already read, without
+    // merging it into a SurfaceData.
+    GfRange3d compute_bounding_box(const GeometryCache& geometry) const;
+    double    compute_surface_area(const GeometryCache& geometry) const;
 };
 
 } // namespace ufd
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Span tracing for profiling a run in chrome://tracing or Perfetto.
+//
+//     UFD_TRACE_SCOPE("closing");
+//     UFD_TRACE_SCOPE_ARG("voxelize_mesh", "faces", face_count);
+//
+// record the enclosing scope as one complete event on the calling thread's
+// timeline; scopes nest, including inside TBB tasks.  Each thread appends to
+// its own buffer, so recording takes no lock.  With tracing off at run time
+// a scope costs one relaxed atomic load; configured with -DUFD_TRACING=OFF
+// the macros expand to nothing and their arguments are not evaluated.
+
+namespace ufd {
+
+// Start or stop recording.  Spans already open when recording stops are
+// still written when they close.
+void set_tracing(bool enabled);
+bool tracing_enabled();
+
+// Drop every recorded span.  Not to be called while traced work is running.
+void reset_trace();
+
+// Spans recorded so far, over all threads.
+size_t trace_event_count();
+
+// Recorded spans as Chrome trace-event JSON: one "X" event per span, on one
+// timeline per thread, with times in microseconds from a clock started on
+// the first use of tracing in the process.
+std::string trace_json();
+
+// Write trace_json() to path; false if the file cannot be written.
+bool write_trace(const std::string& path);
+
+// Records its lifetime as a span named name, with an optional integer
+// argument shown in the event's details.  name and arg_name must outlive
+// the trace; string literals are used throughout.  Normally placed through
+// the macros below.
+class TraceScope {
+public:
+    explicit TraceScope(const char* name,
+                        const char* arg_name = nullptr, int64_t arg = 0);
+    ~TraceScope();
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;      // null while tracing is off
+    const char* arg_name_;
+    int64_t     arg_;
+    uint64_t    begin_ns_ = 0;
+};
+
+} // namespace ufd
+
+#define UFD_TRACE_CONCAT_(a, b) a##b
+#define UFD_TRACE_CONCAT(a, b)  UFD_TRACE_CONCAT_(a, b)
+
+#ifdef UFD_TRACING
+#define UFD_TRACE_SCOPE(name) \
+    ::ufd::TraceScope UFD_TRACE_CONCAT(ufd_trace_scope_, __COUNTER__)(name)
+#define UFD_TRACE_SCOPE_ARG(name, arg_name, arg)                        \
+    ::ufd::TraceScope UFD_TRACE_CONCAT(ufd_trace_scope_, __COUNTER__)(     \
+        name, arg_name, static_cast<int64_t>(arg))
+#else
+#define UFD_TRACE_SCOPE(name) static_cast<void>(0)
+#define UFD_TRACE_SCOPE_ARG(name, arg_name, arg) static_cast<void>(sizeof(arg))
+#endif
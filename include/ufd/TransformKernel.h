@@ -0,0 +1,49 @@
+#pragma once
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/range3d.h>
+
+#include <cstddef>
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+namespace ufd {
+
+// Instruction sets transform_points can run on.
+enum class SimdLevel {
+    Scalar,
+    SSE2,  // two doubles per register
+    AVX2,  // four doubles per register
+};
+
+const char* to_string(SimdLevel level);
+
+// Widest level this CPU supports, detected once at first call.
+SimdLevel detected_simd_level();
+
+// Transform count points, packed as xyz float triples, from in to out by m.
+// Matches GfMatrix4d::Transform on GfVec3d followed by a cast to float bit
+// for bit at every level: the arithmetic is done in double, in the same
+// order and without fused multiply-adds, so content hashes of world-space
+// geometry do not depend on the machine.  Affine matrices skip the
+// perspective divide; projective ones take the scalar path.  Large arrays
+// are split across TBB tasks.  in and out may be the same buffer, and point
+// types such as GfVec3f and openvdb::Vec3s can be passed by casting their
+// data pointers.
+void transform_points(const GfMatrix4d& m, const float* in, float* out,
+                      size_t count);
+
+// As above at a given level, clamped to what the CPU supports; for tests and
+// benchmarks.
+void transform_points(const GfMatrix4d& m, const float* in, float* out,
+                      size_t count, SimdLevel level);
+
+// Axis-aligned bounds of count points transformed by m, exactly those of the
+// points transform_points would write, without storing them: each task
+// transforms a small chunk at a time into a stack buffer and folds it into
+// a running min/max.  Empty for count 0.
+GfRange3d transform_bounds(const GfMatrix4d& m, const float* in, size_t count);
+GfRange3d transform_bounds(const GfMatrix4d& m, const float* in, size_t count,
+                           SimdLevel level);
+
+} // namespace ufd
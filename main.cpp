@@ -3,39 +3,661 @@
 #include <ufd/DomainBuilder.h>
 #include <ufd/DomainConfig.h>
 #include <ufd/EnvelopeBuilder.h>
+#include <ufd/EnvelopeEstimator.h>
+#include <ufd/GeometryCache.h>
+#include <ufd/MeshSdfStore.h>
+#include <ufd/Metrics.h>
+#include <ufd/ProcessStats.h>
+#include <ufd/SdfCache.h>
+#include <ufd/SdfExport.h>
 #include <ufd/StageComposer.h>
+#include <ufd/Trace.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
-int main(int argc, char* argv[]) {
-    if (argc < 3) {
-        std::cerr << "Usage: usd_fluid_domain <input.usd> <output.usd>"
-                  << std::endl;
+#include <spawn.h>
+#include <sys/wait.h>
+
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+
+extern char** environ;
+
+namespace {
+
+const char* const k_usage =
+    "Usage: usd_fluid_domain [options] <input.usd> <output.usd>\n"
+    "       usd_fluid_domain [options] --batch <manifest>\n"
+    "\n"
+    "Options:\n"
+    "  --cache-dir <dir>      reuse closed SDFs stored in <dir> across runs\n"
+    "  --cache-max-mb <n>     evict least-recently-used cache entries above\n"
+    "                         <n> MB (default: unbounded)\n"
+    "  --sdf <path>           also save the closed envelope SDF to <path>\n"
+    "  --sdf-format <fmt>     dense | sparse | npy (default: dense)\n"
+    "  --adaptivity <a>       envelope mesh adaptivity in [0, 1] (default: 0)\n"
+    "  --target-faces <n>     raise adaptivity until the envelope has at most\n"
+    "                         <n> faces\n"
+    "  --voxel-size <v>       envelope voxel size in world units (default: 0.1)\n"
+    "  --memory-budget <n>    use the finest voxel size whose predicted peak\n"
+    "                         grid memory fits in <n> MB\n"
+    "  --dry-run              print the predicted envelope cost and exit\n"
+    "  --trust-extents        bound the domain by authored mesh extents\n"
+    "                         instead of the points\n"
+    "  --purpose <list>       keep only meshes of these comma-separated\n"
+    "                         purposes, e.g. default,render\n"
+    "  --visible-only         skip invisible subtrees\n"
+    "  --include <pattern>    keep only meshes at or under prim paths\n"
+    "                         matching the glob <pattern> (repeatable)\n"
+    "  --exclude <pattern>    skip subtrees at prim paths matching the glob\n"
+    "                         <pattern> (repeatable)\n"
+    "  --kind <list>          keep only meshes under models of these\n"
+    "                         comma-separated kinds\n"
+    "  --exclude-kind <list>  skip models of these comma-separated kinds\n"
+    "  --root <path>          compose only the subtree at prim <path> and\n"
+    "                         load only its payloads (repeatable)\n"
+    "  --no-payloads          open the stage without loading any payloads\n"
+    "  --stage-cache          reuse stages already opened by this process\n"
+    "  --metrics <path>       write the wall time, CPU time and peak memory\n"
+    "                         of each phase and the grid sizes to <path>\n"
+    "                         as JSON\n"
+    "  --trace <path>         write a Chrome trace of the run's phases and\n"
+    "                         parallel tasks to <path>\n"
+    "  --stream               voxelize meshes while the stage is still being\n"
+    "                         traversed (static, untiled builds without a\n"
+    "                         cache, store, budget or dry run)\n"
+    "  --mesh-store <dir>     keep per-mesh SDFs in <dir> and rebuild the\n"
+    "                         envelope incrementally from the last run\n"
+    "                         (static, untiled builds only)\n"
+    "  --watch                rebuild incrementally whenever <input.usd> or\n"
+    "                         a layer it uses changes, until interrupted\n"
+    "                         (static, untiled builds only)\n"
+    "  --time-range <s>:<e>[:<step>]\n"
+    "                         build a time-sampled envelope for time codes\n"
+    "                         s..e (inclusive, default step 1)\n"
+    "  --tile-size <w>        build the envelope out of core in bricks of\n"
+    "                         edge <w> world units\n"
+    "  --tile-memory <n>      build out of core in bricks sized to hold at\n"
+    "                         most <n> MB of grids each, plus any mesh\n"
+    "                         shell wider than a brick\n"
+    "  --tile-dir <dir>       spill brick meshes to <dir> (default:\n"
+    "                         <output.usd>.tiles)\n"
+    "  --tile-workers <n>     build bricks in <n> worker processes\n"
+    "  --batch <manifest>     run every job of <manifest> in this process; a\n"
+    "                         job is a line \"<input.usd> <output.usd>\n"
+    "                         [options]\", its options added to those given\n"
+    "                         here\n"
+    "  --jobs <n>             run <n> batch jobs at once (default: one per\n"
+    "                         4 cores), each with a share of the cores\n";
+
+struct CliOptions {
+    std::string input_path;
+    std::string output_path;
+    std::string cache_dir;
+    uint64_t    cache_max_mb = 0;
+    std::string sdf_path;
+    ufd::SdfFormat sdf_format = ufd::SdfFormat::Dense;
+    double      adaptivity   = 0.0;
+    uint64_t    target_faces = 0;
+    double      voxel_size   = ufd::EnvelopeConfig{}.voxel_size;
+    uint64_t    memory_budget_mb = 0;
+    bool        dry_run      = false;
+    bool        trust_extents = false;
+    ufd::TraversalFilter filter;
+    ufd::StageOpenOptions open_options;
+    bool        stream       = false;
+    std::string metrics_path;
+    std::string trace_path;
+    std::string mesh_store_dir;
+    bool        watch        = false;
+    std::vector<UsdTimeCode> times;  // empty: default time only
+    double      tile_size      = 0.0;
+    uint64_t    tile_memory_mb = 0;
+    std::string tile_dir;
+    size_t      tile_workers   = 1;
+    size_t      tile_worker    = 0;  // this process's index with
+    size_t      tile_worker_of = 0;  // --tile-worker k/n; 0: not a worker
+    std::string batch_path;          // --batch manifest
+    size_t      batch_jobs     = 0;  // concurrent batch jobs; 0: one per
+                                     // k_cores_per_job cores
+    bool        concurrent     = false;  // a batch job running beside others
+                                         // in this process
+    std::vector<std::string> args;   // command line, for spawning workers
+
+    bool tiled() const { return tile_size > 0.0 || tile_memory_mb > 0; }
+};
+
+// Batch jobs share the process: none may watch forever, spawn tile workers
+// of its own, or write the process-wide metrics and trace.
+bool batch_compatible(const CliOptions& opts) {
+    return !opts.watch && opts.tile_workers == 1 && opts.tile_worker_of == 0
+        && opts.metrics_path.empty() && opts.trace_path.empty();
+}
+
+// Parse "<start>:<end>[:<step>]" into the time codes start, start+step, ...
+// up to and including end.
+bool parse_time_range(const std::string& spec, std::vector<UsdTimeCode>& times) {
+    double values[3] = {0.0, 0.0, 1.0};
+    size_t count = 0;
+    size_t begin = 0;
+    try {
+        while (count < 3) {
+            const size_t colon = spec.find(':', begin);
+            values[count++] = std::stod(spec.substr(begin, colon - begin));
+            if (colon == std::string::npos) break;
+            begin = colon + 1;
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    const double start = values[0], end = values[1], step = values[2];
+    if (count < 2 || !(step > 0.0) || end < start) return false;
+
+    times.clear();
+    const auto n = static_cast<size_t>(std::floor((end - start) / step + 1e-9));
+    for (size_t k = 0; k <= n; ++k) times.emplace_back(start + k * step);
+    return true;
+}
+
+bool parse_sdf_format(const std::string& name, ufd::SdfFormat& format) {
+    for (auto f : {ufd::SdfFormat::Dense, ufd::SdfFormat::Sparse,
+                   ufd::SdfFormat::Npy}) {
+        if (name == ufd::to_string(f)) {
+            format = f;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parse a comma-separated list of tokens, e.g. "default,render".
+bool parse_tokens(const std::string& list, std::vector<TfToken>& tokens) {
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        const size_t comma = std::min(list.find(',', begin), list.size());
+        if (comma == begin) return false;
+        tokens.emplace_back(list.substr(begin, comma - begin));
+        begin = comma + 1;
+    }
+    return true;
+}
+
+// Parse "<k>/<n>" as worker k of n.
+bool parse_worker(const std::string& spec, size_t& worker, size_t& workers) {
+    const size_t slash = spec.find('/');
+    if (slash == std::string::npos) return false;
+    try {
+        worker  = std::stoull(spec.substr(0, slash));
+        workers = std::stoull(spec.substr(slash + 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return workers > 0 && worker < workers;
+}
+
+// Parse command-line arguments. Returns false on malformed input.
+bool parse_args(int argc, char* argv[], CliOptions& opts) {
+    opts.args.assign(argv, argv + argc);
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--cache-dir" && has_value) {
+            opts.cache_dir = argv[++i];
+        } else if (arg == "--cache-max-mb" && has_value) {
+            try {
+                opts.cache_max_mb = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+        } else if (arg == "--sdf" && has_value) {
+            opts.sdf_path = argv[++i];
+        } else if (arg == "--sdf-format" && has_value) {
+            if (!parse_sdf_format(argv[++i], opts.sdf_format)) return false;
+        } else if (arg == "--adaptivity" && has_value) {
+            try {
+                opts.adaptivity = std::stod(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+            if (opts.adaptivity < 0.0 || opts.adaptivity > 1.0) return false;
+        } else if (arg == "--target-faces" && has_value) {
+            try {
+                opts.target_faces = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+        } else if (arg == "--voxel-size" && has_value) {
+            try {
+                opts.voxel_size = std::stod(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+            if (!(opts.voxel_size > 0.0)) return false;
+        } else if (arg == "--memory-budget" && has_value) {
+            try {
+                opts.memory_budget_mb = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+        } else if (arg == "--dry-run") {
+            opts.dry_run = true;
+        } else if (arg == "--trust-extents") {
+            opts.trust_extents = true;
+        } else if (arg == "--purpose" && has_value) {
+            if (!parse_tokens(argv[++i], opts.filter.purposes)) return false;
+        } else if (arg == "--visible-only") {
+            opts.filter.visible_only = true;
+        } else if (arg == "--include" && has_value) {
+            opts.filter.include.push_back(argv[++i]);
+        } else if (arg == "--exclude" && has_value) {
+            opts.filter.exclude.push_back(argv[++i]);
+        } else if (arg == "--kind" && has_value) {
+            if (!parse_tokens(argv[++i], opts.filter.kinds)) return false;
+        } else if (arg == "--exclude-kind" && has_value) {
+            if (!parse_tokens(argv[++i], opts.filter.exclude_kinds)) return false;
+        } else if (arg == "--root" && has_value) {
+            const std::string root = argv[++i];
+            if (!SdfPath::IsValidPathString(root)) return false;
+            const SdfPath path(root);
+            if (!path.IsAbsolutePath() || !path.IsPrimPath()) return false;
+            opts.open_options.roots.push_back(path);
+        } else if (arg == "--no-payloads") {
+            opts.open_options.load_payloads = false;
+        } else if (arg == "--stage-cache") {
+            opts.open_options.use_stage_cache = true;
+        } else if (arg == "--stream") {
+            opts.stream = true;
+        } else if (arg == "--metrics" && has_value) {
+            opts.metrics_path = argv[++i];
+        } else if (arg == "--trace" && has_value) {
+            opts.trace_path = argv[++i];
+        } else if (arg == "--mesh-store" && has_value) {
+            opts.mesh_store_dir = argv[++i];
+        } else if (arg == "--watch") {
+            opts.watch = true;
+        } else if (arg == "--time-range" && has_value) {
+            if (!parse_time_range(argv[++i], opts.times)) return false;
+        } else if (arg == "--tile-size" && has_value) {
+            try {
+                opts.tile_size = std::stod(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+            if (!(opts.tile_size > 0.0)) return false;
+        } else if (arg == "--tile-memory" && has_value) {
+            try {
+                opts.tile_memory_mb = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+        } else if (arg == "--tile-dir" && has_value) {
+            opts.tile_dir = argv[++i];
+        } else if (arg == "--tile-workers" && has_value) {
+            try {
+                opts.tile_workers = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+            if (opts.tile_workers == 0) return false;
+        } else if (arg == "--batch" && has_value) {
+            opts.batch_path = argv[++i];
+        } else if (arg == "--jobs" && has_value) {
+            try {
+                opts.batch_jobs = std::stoull(argv[++i]);
+            } catch (const std::exception&) {
+                return false;
+            }
+            if (opts.batch_jobs == 0) return false;
+        } else if (arg == "--tile-worker" && has_value) {
+            // Internal: set on the worker processes --tile-workers spawns
+            if (!parse_worker(argv[++i], opts.tile_worker, opts.tile_worker_of))
+                return false;
+        } else if (arg.rfind("--", 0) == 0) {
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    // A batch takes its input and output paths from the manifest; the
+    // options given here are every job's defaults
+    if (!opts.batch_path.empty()) {
+        return positional.empty() && batch_compatible(opts);
+    }
+    if (opts.batch_jobs > 0) return false;
+
+    if (positional.size() != 2) return false;
+    opts.input_path  = positional[0];
+    opts.output_path = positional[1];
+    if (opts.tile_dir.empty()) opts.tile_dir = opts.output_path + ".tiles";
+    // Tiled builds are static
+    if (opts.tiled() && !opts.times.empty()) return false;
+    // The mesh store serves single static builds, which alone read and
+    // record per-mesh SDFs; watch mode rebuilds from one
+    if ((opts.watch || !opts.mesh_store_dir.empty())
+        && (opts.tiled() || !opts.times.empty()))
+        return false;
+    // A streamed build sees each mesh once, as the traversal reaches it
+    if (opts.stream
+        && (opts.tiled() || !opts.times.empty() || opts.watch
+            || !opts.mesh_store_dir.empty() || !opts.cache_dir.empty()
+            || opts.memory_budget_mb > 0 || opts.dry_run)) {
+        return false;
+    }
+    return true;
+}
+
+void print_cache_stats(const ufd::SdfCache& cache, std::ostream& out) {
+    const auto stats = cache.stats();
+    out << "SDF cache: " << stats.hits << " hits, " << stats.misses
+        << " misses, " << stats.bytes_saved / (1024 * 1024)
+        << " MB saved, " << stats.evictions << " evicted" << std::endl;
+}
+
+void print_estimate(const ufd::EnvelopeEstimate& est, std::ostream& out) {
+    constexpr double mb = 1024.0 * 1024.0;
+    out << "Envelope estimate at voxel size " << est.voxel_size << ":\n"
+        << "  active voxels:   " << est.active_voxels << "\n"
+        << "  closed SDF:      " << est.grid_bytes / mb << " MB\n"
+        << "  peak grids:      " << est.peak_grid_bytes / mb << " MB\n"
+        << "  input geometry:  " << est.geometry_bytes / mb << " MB\n"
+        << "  peak total:      " << est.peak_bytes / mb << " MB\n"
+        << "  dense export:    " << est.dense_export_bytes / mb << " MB\n"
+        << "  envelope faces:  " << est.face_count << std::endl;
+}
+
+// Spawn opts.tile_workers copies of this executable as --tile-worker k/n,
+// each building its run of bricks from the plan in --tile-dir, and wait for
+// all of them.  Returns false if a worker could not be started or failed.
+bool run_tile_workers(const CliOptions& opts) {
+    std::vector<pid_t> pids;
+    bool ok = true;
+    for (size_t k = 0; k < opts.tile_workers; ++k) {
+        std::vector<std::string> args = opts.args;
+        args.push_back("--tile-worker");
+        args.push_back(std::to_string(k) + "/" + std::to_string(opts.tile_workers));
+        std::vector<char*> argv;
+        for (auto& arg : args) argv.push_back(arg.data());
+        argv.push_back(nullptr);
+
+        pid_t pid = 0;
+        const int err = posix_spawn(&pid, "/proc/self/exe", nullptr, nullptr,
+                                    argv.data(), environ);
+        if (err != 0) {
+            std::cerr << "Error: cannot start tile worker " << k << ": "
+                      << std::strerror(err) << std::endl;
+            ok = false;
+            continue;
+        }
+        pids.push_back(pid);
+    }
+    for (pid_t pid : pids) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)
+            || WEXITSTATUS(status) != 0) {
+            std::cerr << "Error: tile worker " << pid << " failed" << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Envelope and tiling settings the command line asks for.
+ufd::EnvelopeConfig envelope_config_of(const CliOptions& opts) {
+    ufd::EnvelopeConfig config;
+    config.voxel_size        = opts.voxel_size;
+    config.sdf_format        = opts.sdf_format;
+    config.adaptivity        = opts.adaptivity;
+    config.target_face_count = opts.target_faces;
+    return config;
+}
+
+ufd::TileConfig tile_config_of(const CliOptions& opts) {
+    ufd::TileConfig tiles;
+    tiles.brick_size    = opts.tile_size;
+    tiles.memory_budget = opts.tile_memory_mb * 1024 * 1024;
+    tiles.spill_dir     = opts.tile_dir;
+    return tiles;
+}
+
+// Where a tiled build spread over workers keeps its TilePlan.
+std::string tile_plan_path(const CliOptions& opts) {
+    return (std::filesystem::path(opts.tile_dir) / "plan.txt").string();
+}
+
+// A tile worker's whole run: read the plan its parent wrote, load only the
+// meshes reaching this worker's bricks, and build and spill those bricks.
+int run_tile_worker(const CliOptions& opts, const ufd::StageReader& reader,
+                    std::ostream& err) {
+    ufd::TilePlan plan;
+    if (!plan.read(tile_plan_path(opts))) {
+        err << "Error: cannot read tile plan " << tile_plan_path(opts)
+            << std::endl;
         return 1;
     }
+    const auto stage = reader.get_stage();
+    std::vector<UsdGeomMesh> meshes;
+    for (size_t i : plan.worker_meshes(opts.tile_worker, opts.tile_worker_of)) {
+        UsdGeomMesh mesh(stage->GetPrimAtPath(SdfPath(plan.mesh_paths[i])));
+        if (!mesh) {
+            err << "Error: tile plan mesh " << plan.mesh_paths[i]
+                << " not found" << std::endl;
+            return 1;
+        }
+        meshes.push_back(mesh);
+    }
 
-    const std::string input_path  = argv[1];
-    const std::string output_path = argv[2];
+    // The parent may have fitted the voxel size to --memory-budget
+    ufd::EnvelopeConfig config = envelope_config_of(opts);
+    config.voxel_size = plan.voxel_size;
+    const ufd::GeometryCache geometry(meshes);
+    return ufd::EnvelopeBuilder(config).build_bricks(
+        geometry, plan, tile_config_of(opts), opts.tile_worker,
+        opts.tile_worker_of) ? 0 : 1;
+}
+
+// Record the figures of a finished envelope build next to its phases.
+void record_envelope_metrics(const ufd::EnvelopeConfig& config,
+                             const ufd::EnvelopeStats& stats) {
+    auto& metrics = ufd::Metrics::global();
+    metrics.set_value("voxel_size", config.voxel_size);
+    metrics.set_value("voxelize_mode", ufd::to_string(stats.mode));
+    metrics.set_value("mesh_count", static_cast<double>(stats.mesh_count));
+    metrics.set_value("face_count", static_cast<double>(stats.face_count));
+    metrics.set_value("active_voxel_count",
+                      static_cast<double>(stats.active_voxel_count));
+    metrics.set_value("sdf_bytes", static_cast<double>(stats.sdf_bytes));
+    metrics.set_value("envelope_face_count",
+                      static_cast<double>(stats.envelope_face_count));
+    metrics.set_value("max_deviation", stats.max_deviation);
+    if (stats.brick_count > 0)
+        metrics.set_value("brick_count", static_cast<double>(stats.brick_count));
+}
+
+// Write the metrics and trace of the run just finished to --metrics and
+// --trace, if given.
+void write_metrics(const CliOptions& opts) {
+    const auto& metrics = ufd::Metrics::global();
+    if (metrics.enabled() && !metrics.write_json(opts.metrics_path)) {
+        std::cerr << "Error: cannot write metrics " << opts.metrics_path
+                  << std::endl;
+    }
+    if (ufd::tracing_enabled() && !ufd::write_trace(opts.trace_path)) {
+        std::cerr << "Error: cannot write trace " << opts.trace_path
+                  << std::endl;
+    }
+}
+
+// Run the whole pipeline once, reporting progress to out and errors to err.
+// reload: re-read the input layers from disk even if USD still holds them
+// from an earlier run (watch mode).
+// layers: if non-null, receives the file paths of every layer the input
+// stage uses (sublayers, references, payloads), for watch mode to poll.
+int run_pipeline(const CliOptions& opts, ufd::SdfCache* cache,
+                 ufd::MeshSdfStore* store, bool reload,
+                 std::ostream& out = std::cout, std::ostream& err = std::cerr,
+                 std::vector<std::string>* layers = nullptr) {
+    const std::string& input_path  = opts.input_path;
+    const std::string& output_path = opts.output_path;
+
+    ufd::Metrics::global().reset();
+    ufd::Metrics::global().set_value("input", input_path);
+    ufd::reset_trace();
+    ufd::ScopedPhase total("total");
 
     // 1. Read the input stage
     ufd::StageReader reader;
-    if (!reader.open(input_path)) {
-        std::cerr << "Error: cannot open stage " << input_path << std::endl;
+    ufd::StageOpenStats open_stats;
+    if (!reader.open(input_path, opts.open_options, &open_stats)) {
+        err << "Error: cannot open stage " << input_path << std::endl;
         return 1;
     }
+    // The RSS change is process-wide, so concurrent batch jobs blur it
+    out << "Opened " << input_path << " in " << open_stats.seconds << " s";
+    if (!opts.concurrent) {
+        out << ", RSS " << (open_stats.rss_bytes >= 0 ? "+" : "")
+            << open_stats.rss_bytes / (1024 * 1024) << " MB";
+    }
+    out << (open_stats.cache_hit ? " (stage cache hit)" : "") << std::endl;
+    if (reload) reader.get_stage()->Reload();
+    if (layers) {
+        layers->clear();
+        for (const auto& layer : reader.get_stage()->GetUsedLayers()) {
+            if (!layer->GetRealPath().empty())
+                layers->push_back(layer->GetRealPath());
+        }
+    }
+
+    // A tile worker only builds its share of the bricks
+    if (opts.tile_worker_of > 0) return run_tile_worker(opts, reader, err);
 
-    auto meshes = reader.collect_meshes();
-    if (meshes.empty()) {
-        std::cerr << "Warning: no meshes found in stage." << std::endl;
+    // A streamed build collects nothing up front: the envelope build pulls
+    // the meshes itself and reports their bounds.
+    std::vector<UsdGeomMesh> meshes;
+    if (!opts.stream) {
+        meshes = reader.collect_meshes(opts.filter);
+        if (meshes.empty()) {
+            err << "Warning: no meshes found in stage." << std::endl;
+        }
     }
 
-    // 2. Extract the combined surface and compute its bounding box
+    // 2. Read the geometry once, for the bounds and the envelope alike.  A
+    // tiled build spread over workers drops it before they start.
+    std::optional<ufd::GeometryCache> geometry_cache(std::in_place, meshes);
+    const ufd::GeometryCache& geometry = *geometry_cache;
     ufd::SurfaceExtractor extractor;
-    auto surface = extractor.extract(meshes);
-    auto bounds  = extractor.compute_bounding_box(surface);
+    // For an animated build the domain covers the geometry at every frame.
+    // Either way the bounds come straight from the points or the authored
+    // extents, never from a merged surface.  A streamed build has read
+    // nothing yet and fills them in below.
+    GfRange3d bounds;
+    if (!opts.times.empty()) {
+        bounds = extractor.compute_bounding_box(meshes, opts.times,
+                                                opts.trust_extents);
+    } else if (opts.trust_extents) {
+        bounds = extractor.compute_world_bounds(
+            meshes, UsdTimeCode::Default(), true);
+    } else {
+        bounds = extractor.compute_bounding_box(geometry);
+    }
+
+    ufd::EnvelopeConfig envelope_config = envelope_config_of(opts);
+    const ufd::TileConfig tiles = tile_config_of(opts);
+
+    if (opts.memory_budget_mb > 0 || opts.dry_run) {
+        ufd::EnvelopeEstimator estimator(
+            extractor.compute_surface_area(geometry), bounds, geometry);
+        if (opts.memory_budget_mb > 0) {
+            envelope_config.voxel_size = estimator.fit_voxel_size(
+                envelope_config, opts.memory_budget_mb * 1024 * 1024);
+            out << "Voxel size " << envelope_config.voxel_size
+                << " fits the " << opts.memory_budget_mb
+                << " MB memory budget" << std::endl;
+        }
+        if (opts.dry_run) {
+            print_estimate(estimator.estimate(envelope_config), out);
+            return 0;
+        }
+    }
 
-    // 3. Build the fluid domain into its own layer
+    // 3. Build the watertight envelope into its own layer
+    const std::string envelope_path = output_path + ".envelope.usda";
+
+    auto envelope_stage = pxr::UsdStage::CreateNew(envelope_path);
+    if (!envelope_stage) {
+        err << "Error: cannot create envelope stage " << envelope_path
+            << std::endl;
+        return 1;
+    }
+
+    ufd::EnvelopeStats envelope_stats;
+    if (opts.stream) {
+        ufd::MeshStream stream(reader.get_stage(), opts.filter);
+        ufd::EnvelopeBuilder(envelope_config)
+            .build_streamed(envelope_stage, stream, opts.sdf_path,
+                            &envelope_stats, &bounds);
+        if (envelope_stats.mesh_count == 0) {
+            err << "Warning: no meshes found in stage." << std::endl;
+        }
+    } else if (opts.tiled()) {
+        ufd::EnvelopeBuilder envelope_builder(envelope_config);
+        if (opts.tile_workers > 1) {
+            // Each worker loads only the meshes its bricks need, so the
+            // parent keeps just the plan while they run
+            const ufd::TilePlan plan =
+                envelope_builder.plan_tiles(geometry, tiles);
+            geometry_cache.reset();
+            if (!plan.write(tile_plan_path(opts))) {
+                err << "Error: cannot write tile plan " << tile_plan_path(opts)
+                    << std::endl;
+                return 1;
+            }
+            if (!run_tile_workers(opts)) return 1;
+            envelope_builder.stitch_bricks(envelope_stage, plan, tiles,
+                                           &envelope_stats);
+        } else {
+            envelope_builder.build_tiled(envelope_stage, geometry, tiles,
+                                         &envelope_stats);
+        }
+    } else if (opts.times.empty()) {
+        ufd::EnvelopeBuilder(envelope_config, cache, store)
+            .build(envelope_stage, geometry, opts.sdf_path, &envelope_stats);
+    } else {
+        std::vector<ufd::EnvelopeStats> frame_stats;
+        ufd::EnvelopeBuilder(envelope_config)
+            .build_animated(envelope_stage, meshes, opts.times, &frame_stats);
+        envelope_stage->SetStartTimeCode(opts.times.front().GetValue());
+        envelope_stage->SetEndTimeCode(opts.times.back().GetValue());
+        // Report the largest frame
+        for (const auto& fs : frame_stats) {
+            if (fs.envelope_face_count >= envelope_stats.envelope_face_count)
+                envelope_stats = fs;
+        }
+    }
+
+    record_envelope_metrics(envelope_config, envelope_stats);
+
+    // 4. Build the fluid domain into its own layer, around the input bounds
     const std::string domain_path = output_path + ".domain.usda";
 
     ufd::DomainConfig config;
@@ -43,25 +665,13 @@ int main(int argc, char* argv[]) {
 
     auto domain_stage = pxr::UsdStage::CreateNew(domain_path);
     if (!domain_stage) {
-        std::cerr << "Error: cannot create domain stage " << domain_path
-                  << std::endl;
+        err << "Error: cannot create domain stage " << domain_path
+            << std::endl;
         return 1;
     }
 
     builder.build(domain_stage, bounds);
 
-    // 4. Build the watertight envelope into its own layer
-    const std::string envelope_path = output_path + ".envelope.usda";
-
-    auto envelope_stage = pxr::UsdStage::CreateNew(envelope_path);
-    if (!envelope_stage) {
-        std::cerr << "Error: cannot create envelope stage " << envelope_path
-                  << std::endl;
-        return 1;
-    }
-
-    ufd::EnvelopeBuilder(ufd::EnvelopeConfig{}).build(envelope_stage, meshes);
-
     // 5. Compose all components into a root layer
     ufd::StageComposer composer(output_path);
     composer.add_component(ufd::ComponentType::InputGeometry, reader.get_stage());
@@ -69,13 +679,324 @@ int main(int argc, char* argv[]) {
     composer.add_component(ufd::ComponentType::Envelope,      envelope_stage);
 
     if (!composer.write()) {
-        std::cerr << "Error: cannot write composed stage " << output_path
-                  << std::endl;
+        err << "Error: cannot write composed stage " << output_path
+            << std::endl;
         return 1;
     }
 
-    std::cout << "Written: " << domain_path << std::endl;
-    std::cout << "Written: " << envelope_path << std::endl;
-    std::cout << "Written: " << output_path << std::endl;
+    out << "Written: " << domain_path << std::endl;
+    out << "Written: " << envelope_path << std::endl;
+    out << "Written: " << output_path << std::endl;
+    out << "Envelope: " << envelope_stats.envelope_face_count
+        << " faces, max deviation " << envelope_stats.max_deviation
+        << std::endl;
+    out << "Peak RSS: " << ufd::peak_rss_bytes() / (1024 * 1024)
+        << " MB" << std::endl;
+    if (cache) print_cache_stats(*cache, out);
     return 0;
 }
+
+// Modification time of path, or the epoch if it cannot be read.
+std::filesystem::file_time_type modified_time(const std::string& path) {
+    std::error_code ec;
+    auto t = std::filesystem::last_write_time(path, ec);
+    return ec ? std::filesystem::file_time_type{} : t;
+}
+
+// Modification times of paths, in order.
+std::vector<std::filesystem::file_time_type>
+modified_times(const std::vector<std::string>& paths) {
+    std::vector<std::filesystem::file_time_type> times;
+    times.reserve(paths.size());
+    for (const auto& path : paths) times.push_back(modified_time(path));
+    return times;
+}
+
+// Cores a batch job gets unless --jobs says otherwise.  A job's serial
+// phases (stage open, layer saves) leave a wide arena idle, so several
+// narrower jobs side by side keep the machine busier than one wide one.
+constexpr size_t k_cores_per_job = 4;
+
+struct BatchJob {
+    size_t      line = 0;  // manifest line, for messages
+    CliOptions  opts;
+    std::string error;     // why the line cannot run; empty if it can
+};
+
+// Split a manifest line into whitespace-separated words; double quotes
+// group a word containing spaces, and an unquoted '#' starts a comment.
+// False on an unterminated quote.
+bool split_words(const std::string& line, std::vector<std::string>& words) {
+    std::string word;
+    bool in_word = false;
+    bool quoted  = false;
+    for (char c : line) {
+        if (quoted) {
+            if (c == '"') quoted = false;
+            else          word += c;
+        } else if (c == '"') {
+            quoted = in_word = true;
+        } else if (c == '#') {
+            break;
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            if (in_word) words.push_back(word);
+            word.clear();
+            in_word = false;
+        } else {
+            word += c;
+            in_word = true;
+        }
+    }
+    if (quoted) return false;
+    if (in_word) words.push_back(word);
+    return true;
+}
+
+// Read the jobs of the batch's manifest.  A job's command line is the
+// batch's own options followed by the line's, so the line overrides a
+// batch-wide value and adds to the repeatable filters.  A line that does
+// not parse, or writes an output an earlier line already writes, becomes a
+// job that fails without running.  False if the manifest cannot be read.
+bool load_manifest(const CliOptions& batch, std::vector<BatchJob>& jobs) {
+    std::ifstream in(batch.batch_path);
+    if (!in) {
+        std::cerr << "Error: cannot read manifest " << batch.batch_path
+                  << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> defaults;
+    for (size_t i = 0; i < batch.args.size(); ++i) {
+        if (batch.args[i] == "--batch" || batch.args[i] == "--jobs") {
+            ++i;
+            continue;
+        }
+        defaults.push_back(batch.args[i]);
+    }
+
+    std::set<std::string> outputs;
+    std::string line;
+    for (size_t n = 1; std::getline(in, line); ++n) {
+        std::vector<std::string> words;
+        BatchJob job;
+        job.line = n;
+        if (!split_words(line, words)) {
+            job.error = "unterminated quote";
+        } else if (words.empty()) {
+            continue;
+        } else {
+            std::vector<std::string> args = defaults;
+            args.insert(args.end(), words.begin(), words.end());
+            std::vector<char*> argv;
+            for (auto& arg : args) argv.push_back(arg.data());
+            if (!parse_args(static_cast<int>(argv.size()), argv.data(), job.opts)
+                || !batch_compatible(job.opts)) {
+                job.error = "invalid job \"" + line + "\"";
+            } else if (!outputs.insert(job.opts.output_path).second) {
+                job.error = job.opts.output_path + " is written by an earlier job";
+            }
+        }
+        jobs.push_back(std::move(job));
+    }
+    return true;
+}
+
+// Run every job of the manifest, --jobs at a time, in this one process, so
+// the USD plugin registry, OpenVDB and the TBB scheduler start once for the
+// whole batch.  Each job runs in a task_arena limited to its share of the
+// cores, so the jobs' parallel loops together fill the machine without
+// oversubscribing it.  A job that fails, by its status or by throwing, is
+// reported and the rest go on.  Returns 1 if any job failed.
+int run_batch(const CliOptions& batch) {
+    std::vector<BatchJob> jobs;
+    if (!load_manifest(batch, jobs)) return 1;
+    if (jobs.empty()) {
+        std::cerr << "Error: no jobs in " << batch.batch_path << std::endl;
+        return 1;
+    }
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t slots = std::min(
+        jobs.size(), batch.batch_jobs > 0
+                         ? batch.batch_jobs
+                         : std::max<size_t>(1, cores / k_cores_per_job));
+    const int threads_per_job =
+        static_cast<int>(std::max<size_t>(1, cores / slots));
+    std::cout << "Batch: " << jobs.size() << " jobs, " << slots
+              << " at a time with " << threads_per_job << " threads each"
+              << std::endl;
+    for (auto& job : jobs) job.opts.concurrent = slots > 1;
+
+    // Jobs sharing a cache directory share its SdfCache, which is safe
+    // between threads; the first job naming the directory sets its limit.
+    std::map<std::string, std::unique_ptr<ufd::SdfCache>> caches;
+    for (const auto& job : jobs) {
+        const std::string& dir = job.opts.cache_dir;
+        if (job.error.empty() && !dir.empty() && !caches.count(dir)) {
+            caches[dir] = std::make_unique<ufd::SdfCache>(
+                dir, job.opts.cache_max_mb * 1024 * 1024);
+        }
+    }
+
+    // A stage cache hit may load payloads on a stage another job is
+    // reading, so jobs opening the same file through the cache run one at
+    // a time; the lock is held for the whole job, since it reads the
+    // shared stage to the end.
+    std::map<std::string, std::unique_ptr<std::mutex>> stage_locks;
+    auto stage_key = [](const CliOptions& opts) {
+        std::error_code ec;
+        const auto path = std::filesystem::weakly_canonical(opts.input_path, ec);
+        return ec ? opts.input_path : path.string();
+    };
+    for (const auto& job : jobs) {
+        if (job.error.empty() && job.opts.open_options.use_stage_cache) {
+            auto& lock = stage_locks[stage_key(job.opts)];
+            if (!lock) lock = std::make_unique<std::mutex>();
+        }
+    }
+
+    std::vector<int>    status(jobs.size(), 1);
+    std::atomic<size_t> next{0};
+    std::mutex          report_mutex;
+    const auto batch_start = std::chrono::steady_clock::now();
+
+    // Each pool thread takes the next job until none are left, buffering
+    // the job's output so reports of concurrent jobs do not interleave
+    auto run_jobs = [&] {
+        tbb::task_arena arena(threads_per_job);
+        for (size_t j = next++; j < jobs.size(); j = next++) {
+            const BatchJob& job = jobs[j];
+            std::ostringstream out, err;
+            const auto start = std::chrono::steady_clock::now();
+            if (!job.error.empty()) {
+                err << "Error: " << batch.batch_path << ":" << job.line << ": "
+                    << job.error << std::endl;
+            } else {
+                try {
+                    std::unique_lock<std::mutex> stage_lock;
+                    if (job.opts.open_options.use_stage_cache) {
+                        stage_lock = std::unique_lock<std::mutex>(
+                            *stage_locks.at(stage_key(job.opts)));
+                    }
+                    std::unique_ptr<ufd::MeshSdfStore> store;
+                    if (!job.opts.mesh_store_dir.empty()) {
+                        store = std::make_unique<ufd::MeshSdfStore>(
+                            job.opts.mesh_store_dir);
+                    }
+                    auto cache = caches.find(job.opts.cache_dir);
+                    status[j] = arena.execute([&] {
+                        return run_pipeline(
+                            job.opts,
+                            cache != caches.end() ? cache->second.get() : nullptr,
+                            store.get(), false, out, err);
+                    });
+                } catch (const std::exception& e) {
+                    err << "Error: " << e.what() << std::endl;
+                } catch (...) {
+                    err << "Error: unknown exception" << std::endl;
+                }
+            }
+            const double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(report_mutex);
+            std::cout << "[" << j + 1 << "/" << jobs.size() << "] line "
+                      << job.line << ": " << job.opts.input_path
+                      << (status[j] == 0 ? " done" : " FAILED") << " in "
+                      << seconds << " s\n" << out.str() << std::flush;
+            std::cerr << err.str() << std::flush;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t i = 1; i < slots; ++i) pool.emplace_back(run_jobs);
+    run_jobs();
+    for (auto& thread : pool) thread.join();
+
+    size_t failed = 0;
+    for (int s : status) failed += s != 0;
+    std::cout << "Batch: " << jobs.size() - failed << " of " << jobs.size()
+              << " jobs succeeded in "
+              << std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - batch_start).count()
+              << " s" << std::endl;
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        if (status[j] != 0) {
+            std::cerr << "  failed: line " << jobs[j].line << " "
+                      << jobs[j].opts.input_path << std::endl;
+        }
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CliOptions opts;
+    if (!parse_args(argc, argv, opts)) {
+        std::cerr << k_usage;
+        return 1;
+    }
+    if (!opts.batch_path.empty()) return run_batch(opts);
+
+    // Tile workers share the machine; split its threads between them
+    std::unique_ptr<tbb::global_control> threads;
+    if (opts.tile_worker_of > 0) {
+        const size_t n = std::max<size_t>(
+            1, std::thread::hardware_concurrency() / opts.tile_worker_of);
+        threads = std::make_unique<tbb::global_control>(
+            tbb::global_control::max_allowed_parallelism, n);
+    }
+
+    std::unique_ptr<ufd::SdfCache> cache;
+    if (!opts.cache_dir.empty()) {
+        cache = std::make_unique<ufd::SdfCache>(
+            opts.cache_dir, opts.cache_max_mb * 1024 * 1024);
+    }
+
+    // Watch mode keeps per-mesh SDFs in memory for the life of the process;
+    // --mesh-store also persists them for the next run.
+    std::unique_ptr<ufd::MeshSdfStore> store;
+    if (opts.watch || !opts.mesh_store_dir.empty()) {
+        store = std::make_unique<ufd::MeshSdfStore>(opts.mesh_store_dir);
+    }
+
+    // Tile workers would all write the same files; only the parent reports
+    if (!opts.metrics_path.empty() && opts.tile_worker_of == 0) {
+        ufd::Metrics::global().set_enabled(true);
+    }
+    if (!opts.trace_path.empty() && opts.tile_worker_of == 0) {
+#ifndef UFD_TRACING
+        std::cerr << "Warning: built with UFD_TRACING off; the trace will be"
+                     " empty" << std::endl;
+#endif
+        ufd::set_tracing(true);
+    }
+
+    // Watch mode polls every layer the stage composed, not just the root,
+    // and picks up layers added or dropped by each rebuild
+    std::vector<std::string> layers = {opts.input_path};
+    auto last_change = modified_times(layers);
+    const int status = run_pipeline(opts, cache.get(), store.get(), false,
+                                    std::cout, std::cerr, &layers);
+    write_metrics(opts);
+    if (!opts.watch || opts.dry_run || opts.tile_worker_of > 0) return status;
+
+    std::cout << "Watching " << opts.input_path << " and " << layers.size() - 1
+              << " layers it uses for changes (Ctrl-C to stop)" << std::endl;
+    last_change = modified_times(layers);
+    for (;;) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        if (modified_times(layers) == last_change) continue;
+
+        const auto t0 = std::chrono::steady_clock::now();
+        run_pipeline(opts, cache.get(), store.get(), true, std::cout,
+                     std::cerr, &layers);
+        last_change = modified_times(layers);
+        write_metrics(opts);
+        const auto t1 = std::chrono::steady_clock::now();
+        std::cout << "Rebuilt in "
+                  << std::chrono::duration<double>(t1 - t0).count() << " s"
+                  << std::endl;
+    }
+}
@@ -1,4 +1,5 @@
 #include <ufd/DomainBuilder.h>
+#include <ufd/Metrics.h>
 
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/usd/usdGeom/tokens.h>
@@ -17,6 +18,7 @@ DomainBuilder::DomainBuilder(const DomainConfig& config)
 std::string DomainBuilder::build(
     UsdStageRefPtr stage,
     const GfRange3d& object_bounds) const {
+    ScopedPhase phase("usd_authoring");
     const GfVec3d domain_center = object_bounds.GetMidpoint()
                                 + config_.origin_offset;
     const GfVec3d size          = object_bounds.GetSize();
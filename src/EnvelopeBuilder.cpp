@@ -1,14 +1,52 @@
 #include <ufd/EnvelopeBuilder.h>
+#include <ufd/GeometryCache.h>
+#include <ufd/Hash.h>
+#include <ufd/MeshGather.h>
+#include <ufd/MeshSdfStore.h>
+#include <ufd/Metrics.h>
+#include <ufd/ProcessStats.h>
+#include <ufd/SdfCache.h>
+#include <ufd/SdfExport.h>
+#include <ufd/StageReader.h>
+#include <ufd/Trace.h>
 
 #include <openvdb/openvdb.h>
+#include <openvdb/tools/ChangeBackground.h>
+#include <openvdb/tools/Clip.h>
 #include <openvdb/tools/Composite.h>
-#include <openvdb/tools/Dense.h>
+#include <openvdb/tools/GridOperators.h>
+#include <openvdb/tools/GridTransformer.h>
+#include <openvdb/tools/Interpolation.h>
 #include <openvdb/tools/LevelSetFilter.h>
 #include <openvdb/tools/LevelSetRebuild.h>
+#include <openvdb/tools/LevelSetUtil.h>
 #include <openvdb/tools/MeshToVolume.h>
+#include <openvdb/tools/Morphology.h>
+#include <openvdb/tools/Prune.h>
+#include <openvdb/tools/SignedFloodFill.h>
+#include <openvdb/tools/TopologyToLevelSet.h>
+#include <openvdb/tools/ValueTransformer.h>
 #include <openvdb/tools/VolumeToMesh.h>
+#include <openvdb/tree/LeafManager.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <unordered_map>
 
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/usd/usdGeom/tokens.h>
@@ -17,196 +55,2012 @@
 
 namespace ufd {
 
-EnvelopeBuilder::EnvelopeBuilder(const EnvelopeConfig& config)
-    : config_(config) {}
+namespace {
 
-std::string EnvelopeBuilder::build(
-    UsdStageRefPtr stage,
-    const std::vector<UsdGeomMesh>& meshes,
-    const std::string& sdf_path) const
+constexpr size_t k_no_prototype = std::numeric_limits<size_t>::max();
+
+// Mode for voxelizing count meshes of faces polygons in all.
+VoxelizeMode choose_mode(const EnvelopeConfig& config, size_t count,
+                         size_t faces)
 {
-    const std::string prim_path = "/Envelope";
-    if (meshes.empty()) return {};
+    if (config.mode != VoxelizeMode::Auto) return config.mode;
+    if (count < std::max<size_t>(2, config.soup_min_meshes))
+        return VoxelizeMode::PerMesh;
 
-    openvdb::initialize();
+    // Many small meshes: per-call setup and the union dominate, so one
+    // voxelization of the merged soup wins.
+    return faces <= config.soup_max_mean_faces * count
+        ? VoxelizeMode::Soup
+        : VoxelizeMode::PerMesh;
+}
 
-    const float vox         = static_cast<float>(config_.voxel_size);
-    const float close_world = static_cast<float>(config_.hole_threshold);
-    const float close_vox   = close_world / vox;
-    // Narrow band must be wide enough to survive the closing pass
-    const float half_band   = close_vox + 3.0f;
+// Concatenate the geometry of meshes `subset` into one soup, rebasing polygon
+// indices.  Offsets come from a prefix sum so each mesh's slice is filled in
+// parallel.
+MeshGeometry merge_soup(const std::vector<MeshGeometry>& geoms,
+                        const std::vector<size_t>& subset)
+{
+    struct Offsets { size_t points = 0, triangles = 0, quads = 0; };
+    std::vector<Offsets> offsets(subset.size() + 1);
+    for (size_t k = 0; k < subset.size(); ++k) {
+        const MeshGeometry& geom = geoms[subset[k]];
+        offsets[k + 1].points    = offsets[k].points    + geom.points.size();
+        offsets[k + 1].triangles = offsets[k].triangles + geom.triangles.size();
+        offsets[k + 1].quads     = offsets[k].quads     + geom.quads.size();
+    }
 
-    auto xform = openvdb::math::Transform::createLinearTransform(
-        static_cast<double>(vox));
+    MeshGeometry soup;
+    soup.points.resize(offsets.back().points);
+    soup.triangles.resize(offsets.back().triangles);
+    soup.quads.resize(offsets.back().quads);
 
-    UsdGeomXformCache xform_cache;
-    openvdb::FloatGrid::Ptr sdf;
+    tbb::parallel_for(size_t(0), subset.size(), [&](size_t k) {
+        const MeshGeometry& geom = geoms[subset[k]];
+        const Offsets&      off  = offsets[k];
+        const auto base = static_cast<uint32_t>(off.points);
 
-    for (const auto& mesh : meshes) {
-        VtVec3fArray usd_pts;
-        mesh.GetPointsAttr().Get(&usd_pts);
-
-        VtIntArray face_counts;
-        VtIntArray face_indices;
-        mesh.GetFaceVertexCountsAttr().Get(&face_counts);
-        mesh.GetFaceVertexIndicesAttr().Get(&face_indices);
-
-        GfMatrix4d world_xform =
-            xform_cache.GetLocalToWorldTransform(mesh.GetPrim());
-
-        // Convert USD points to world-space OpenVDB Vec3s
-        std::vector<openvdb::Vec3s> points;
-        points.reserve(usd_pts.size());
-        for (const auto& p : usd_pts) {
-            GfVec3d wp = world_xform.Transform(GfVec3d(p[0], p[1], p[2]));
-            points.emplace_back(
-                static_cast<float>(wp[0]),
-                static_cast<float>(wp[1]),
-                static_cast<float>(wp[2]));
-        }
-
-        // Fan-triangulate faces; keep quads as quads
-        std::vector<openvdb::Vec3I> triangles;
-        std::vector<openvdb::Vec4I> quads;
-        int cursor = 0;
-        for (int count : face_counts) {
-            if (count == 3) {
-                triangles.emplace_back(
-                    static_cast<uint32_t>(face_indices[cursor]),
-                    static_cast<uint32_t>(face_indices[cursor + 1]),
-                    static_cast<uint32_t>(face_indices[cursor + 2]));
-            } else if (count == 4) {
-                quads.emplace_back(
-                    static_cast<uint32_t>(face_indices[cursor]),
-                    static_cast<uint32_t>(face_indices[cursor + 1]),
-                    static_cast<uint32_t>(face_indices[cursor + 2]),
-                    static_cast<uint32_t>(face_indices[cursor + 3]));
+        std::copy(geom.points.begin(), geom.points.end(),
+                  soup.points.begin() + off.points);
+        for (size_t t = 0; t < geom.triangles.size(); ++t) {
+            soup.triangles[off.triangles + t] =
+                geom.triangles[t] + openvdb::Vec3I(base);
+        }
+        for (size_t q = 0; q < geom.quads.size(); ++q) {
+            soup.quads[off.quads + q] = geom.quads[q] + openvdb::Vec4I(base);
+        }
+    });
+
+    return soup;
+}
+
+MeshGeometry merge_soup(const std::vector<MeshGeometry>& geoms)
+{
+    std::vector<size_t> all(geoms.size());
+    for (size_t i = 0; i < all.size(); ++i) all[i] = i;
+    return merge_soup(geoms, all);
+}
+
+// True when m is a rotation/reflection plus translation, so distances sampled
+// through it are still distances.
+bool is_rigid(const GfMatrix4d& m) {
+    if (m[0][3] != 0.0 || m[1][3] != 0.0 || m[2][3] != 0.0 || m[3][3] != 1.0)
+        return false;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            const double dot = m[i][0] * m[j][0] + m[i][1] * m[j][1]
+                             + m[i][2] * m[j][2];
+            if (std::abs(dot - (i == j ? 1.0 : 0.0)) > 1e-6) return false;
+        }
+    }
+    return true;
+}
+
+bool same_shape(const MeshGeometry& a, const MeshGeometry& b) {
+    return a.content_hash     == b.content_hash
+        && a.points.size()    == b.points.size()
+        && a.triangles.size() == b.triangles.size()
+        && a.quads.size()     == b.quads.size();
+}
+
+// Place a prototype SDF under a rigid relative transform by resampling it
+// into a grid with the given world transform.  The prototype tree is shared,
+// not copied, so concurrent stamps of one prototype are cheap.
+openvdb::FloatGrid::Ptr stamp_instance(const openvdb::FloatGrid::Ptr& proto,
+                                       const GfMatrix4d& relative,
+                                       const openvdb::math::Transform& xform)
+{
+    UFD_TRACE_SCOPE("stamp_instance");
+    auto inst = openvdb::gridPtrCast<openvdb::FloatGrid>(proto->copyGrid());
+    // Not flagged as a level set, so resampleToMatch samples values through
+    // the transform instead of meshing and re-voxelizing the prototype.
+    inst->setGridClass(openvdb::GRID_UNKNOWN);
+    auto inst_xform = proto->transform().copy();
+    inst_xform->postMult(openvdb::math::Mat4d(relative.GetArray()));
+    inst->setTransform(inst_xform);
+
+    auto out = openvdb::FloatGrid::create(proto->background());
+    out->setTransform(xform.copy());
+    out->setGridClass(openvdb::GRID_LEVEL_SET);
+    openvdb::tools::resampleToMatch<openvdb::tools::BoxSampler>(*inst, *out);
+
+    // Restore level-set invariants: only the narrow band stays active and
+    // inactive values carry the sign of their side.
+    const float bg = out->background();
+    for (auto it = out->beginValueOn(); it; ++it) {
+        if (std::abs(*it) >= bg) it.setValueOff();
+    }
+    openvdb::tools::signedFloodFill(out->tree());
+    openvdb::tools::pruneLevelSet(out->tree());
+    return out;
+}
+
+// Narrow-band SDF of one mesh, in world space.
+openvdb::FloatGrid::Ptr voxelize_mesh(const openvdb::math::Transform& xform,
+                                      const MeshGeometry& geom,
+                                      float half_band)
+{
+    ScopedPhase phase("voxelize_mesh");
+    return openvdb::tools::meshToSignedDistanceField<openvdb::FloatGrid>(
+        xform, geom.points, geom.triangles, geom.quads, half_band, half_band);
+}
+
+// Union b into a, consuming b.
+void union_into(openvdb::FloatGrid& a, openvdb::FloatGrid& b) {
+    ScopedPhase phase("union");
+    openvdb::tools::csgUnion(a, b);
+}
+
+// Voxelize meshes [begin, end) and union them in a balanced pairwise tree.
+// Each half is an independent TBB task, so leaves run in parallel and every
+// csgUnion merges two grids of similar size instead of growing one
+// accumulator serially.
+template <typename VoxelizeFn>
+openvdb::FloatGrid::Ptr voxelize_and_union(const VoxelizeFn& voxelize,
+                                           size_t begin, size_t end)
+{
+    if (end - begin == 1) return voxelize(begin);
+
+    const size_t mid = begin + (end - begin) / 2;
+    openvdb::FloatGrid::Ptr lhs;
+    openvdb::FloatGrid::Ptr rhs;
+    tbb::parallel_invoke(
+        [&] { lhs = voxelize_and_union(voxelize, begin, mid); },
+        [&] { rhs = voxelize_and_union(voxelize, mid, end); });
+
+    union_into(*lhs, *rhs);
+    return lhs;
+}
+
+// Voxelize all meshes into one narrow-band SDF.  Meshes whose local geometry
+// duplicates an earlier mesh (USD instances, or copies under another xform)
+// reuse that mesh's SDF when the relative transform is rigid; this runs
+// before the mode is chosen, so in Auto mode many small duplicated parts are
+// stamped and only the unique remainder is voxelized, per mesh or as one
+// soup.  An explicit Soup mode merges every mesh.
+openvdb::FloatGrid::Ptr union_sdf(const EnvelopeConfig& config,
+                                  const std::vector<MeshGeometry>& geoms,
+                                  const std::vector<GfMatrix4d>& world_xforms,
+                                  const openvdb::math::Transform& xform,
+                                  float half_band,
+                                  EnvelopeStats* stats)
+{
+    ScopedPhase phase("voxelization");
+    size_t total_faces = 0;
+    for (const auto& geom : geoms) total_faces += face_count(geom);
+
+    const auto voxelize = [&](const MeshGeometry& geom) {
+        return voxelize_mesh(xform, geom, half_band);
+    };
+
+    std::vector<size_t>     prototype_of(geoms.size(), k_no_prototype);
+    std::vector<GfMatrix4d> relative(geoms.size());
+    std::vector<bool>       is_prototype(geoms.size(), false);
+    size_t stamped_count = 0;
+    if (config.mode != VoxelizeMode::Soup && config.reuse_prototypes) {
+        std::unordered_map<uint64_t, size_t> first_of;
+        for (size_t i = 0; i < geoms.size(); ++i) {
+            auto [it, inserted] = first_of.emplace(geoms[i].content_hash, i);
+            const size_t rep = it->second;
+            if (inserted || !same_shape(geoms[rep], geoms[i])) continue;
+
+            const GfMatrix4d rel = world_xforms[rep].GetInverse()
+                                 * world_xforms[i];
+            if (!is_rigid(rel)) continue;
+
+            prototype_of[i] = rep;
+            relative[i]     = rel;
+            is_prototype[rep] = true;
+            ++stamped_count;
+        }
+    }
+
+    // Meshes neither stamped nor serving as a prototype pick the mode
+    std::vector<size_t> unique;
+    size_t unique_faces = 0;
+    for (size_t i = 0; i < geoms.size(); ++i) {
+        if (prototype_of[i] != k_no_prototype || is_prototype[i]) continue;
+        unique.push_back(i);
+        unique_faces += face_count(geoms[i]);
+    }
+    const VoxelizeMode mode = choose_mode(config, unique.size(), unique_faces);
+
+    std::cerr << "EnvelopeBuilder: voxelizing " << geoms.size() << " meshes ("
+              << total_faces << " faces) in " << to_string(mode) << " mode\n";
+
+    std::vector<size_t> reps;
+    for (size_t i = 0; i < geoms.size(); ++i)
+        if (is_prototype[i]) reps.push_back(i);
+    std::vector<openvdb::FloatGrid::Ptr> prototypes(geoms.size());
+    tbb::parallel_for(size_t(0), reps.size(), [&](size_t r) {
+        prototypes[reps[r]] = voxelize(geoms[reps[r]]);
+    });
+
+    if (stats) {
+        stats->mode            = mode;
+        stats->mesh_count      = geoms.size();
+        stats->face_count      = total_faces;
+        stats->prototype_count = reps.size();
+        stats->stamped_count   = stamped_count;
+    }
+    if (stamped_count > 0) {
+        std::cerr << "EnvelopeBuilder: reusing " << reps.size()
+                  << " prototype SDFs for " << stamped_count
+                  << " duplicate meshes\n";
+    }
+
+    // One task per mesh to voxelize or stamp, except that in Soup mode the
+    // unique meshes are a single task at the end
+    std::vector<size_t> tasks;
+    for (size_t i = 0; i < geoms.size(); ++i) {
+        if (mode != VoxelizeMode::Soup || prototype_of[i] != k_no_prototype
+            || is_prototype[i]) {
+            tasks.push_back(i);
+        }
+    }
+    if (mode == VoxelizeMode::Soup && !unique.empty())
+        tasks.push_back(k_no_prototype);
+
+    const auto mesh_sdf = [&](size_t t) {
+        const size_t i = tasks[t];
+        if (i == k_no_prototype) return voxelize(merge_soup(geoms, unique));
+        UFD_TRACE_SCOPE_ARG("mesh_sdf", "mesh", i);
+        if (prototype_of[i] != k_no_prototype) {
+            return stamp_instance(prototypes[prototype_of[i]], relative[i],
+                                  xform);
+        }
+        // csgUnion consumes its operands, so the shared prototype is copied
+        if (prototypes[i]) return prototypes[i]->deepCopy();
+        return voxelize(geoms[i]);
+    };
+
+    if (tasks.empty()) return nullptr;
+    openvdb::FloatGrid::Ptr sdf;
+    if (config.parallel) {
+        sdf = voxelize_and_union(mesh_sdf, 0, tasks.size());
+    } else {
+        for (size_t t = 0; t < tasks.size(); ++t) {
+            auto grid = mesh_sdf(t);
+            if (!sdf) {
+                sdf = grid;
             } else {
-                // Fan-triangulate n-gons (n > 4)
-                for (int i = 1; i < count - 1; ++i) {
-                    triangles.emplace_back(
-                        static_cast<uint32_t>(face_indices[cursor]),
-                        static_cast<uint32_t>(face_indices[cursor + i]),
-                        static_cast<uint32_t>(face_indices[cursor + i + 1]));
-                }
+                union_into(*sdf, *grid);
             }
-            cursor += count;
         }
+    }
+
+    if (sdf) Metrics::global().record_grid("unioned", *sdf);
+    return sdf;
+}
+
+// Morphological closing: dilate then erode by close_world (world units).
+// Bridges holes/gaps smaller than hole_threshold.
+openvdb::FloatGrid::Ptr close_sdf_level_set(openvdb::FloatGrid::Ptr sdf,
+                                            float close_world,
+                                            float half_band)
+{
+    {
+        UFD_TRACE_SCOPE("dilate");
+        openvdb::tools::LevelSetFilter<openvdb::FloatGrid> f(*sdf);
+        f.offset(-close_world);
+    }
+    {
+        UFD_TRACE_SCOPE("rebuild");
+        sdf = openvdb::tools::levelSetRebuild(*sdf, 0.0f, half_band, half_band);
+    }
+    {
+        UFD_TRACE_SCOPE("erode");
+        openvdb::tools::LevelSetFilter<openvdb::FloatGrid> f(*sdf);
+        f.offset(close_world);
+    }
+    UFD_TRACE_SCOPE("rebuild");
+    return openvdb::tools::levelSetRebuild(*sdf, 0.0f, half_band, half_band);
+}
+
+// The same closing done on the voxelized interior mask.  Dilating and eroding
+// a bool tree is cheap, and the SDF is only rebuilt for the voxels the closing
+// adds (bridges and filled holes), which are then unioned back in.  Surfaces
+// the closing leaves alone keep their original sub-voxel SDF, and the input
+// band needs no widening.
+//
+// A face-neighbour step grows the mask by an L1 diamond and a full 26-
+// neighbour step by a cube, which reach 1/sqrt(3) and sqrt(3) voxels along a
+// body diagonal.  Alternating them gives an octagon-like element whose
+// diagonal reach is within about 15% of a ball's, so gaps close at close to
+// hole_threshold whatever their orientation.  Bridges are still rebuilt from
+// voxel topology: their surfaces are voxel staircases, where LevelSet
+// closing gives smooth ones.
+openvdb::FloatGrid::Ptr close_sdf_topology(openvdb::FloatGrid::Ptr sdf,
+                                           float close_vox)
+{
+    const int steps = std::max(1, static_cast<int>(std::lround(close_vox)));
+    const auto step_nn = [](int i) {
+        return i % 2 == 0 ? openvdb::tools::NN_FACE_EDGE_VERTEX
+                          : openvdb::tools::NN_FACE;
+    };
+
+    openvdb::BoolGrid::Ptr interior, closed;
+    {
+        UFD_TRACE_SCOPE("close_mask");
+        interior = openvdb::tools::sdfInteriorMask(*sdf);
+        interior->setTransform(sdf->transform().copy());
+        interior->tree().voxelizeActiveTiles();
+
+        closed = interior->deepCopy();
+        for (int i = 0; i < steps; ++i)
+            openvdb::tools::dilateActiveValues(closed->tree(), 1, step_nn(i));
+        for (int i = 0; i < steps; ++i)
+            openvdb::tools::erodeActiveValues(closed->tree(), 1, step_nn(i));
+    }
+
+    auto added = closed->deepCopy();
+    added->tree().topologyDifference(interior->tree());
+    if (added->tree().activeVoxelCount() == 0) return sdf;
+
+    // Grow the patch one voxel into the original interior so the union welds
+    // it to the existing surface without a seam.
+    openvdb::tools::dilateActiveValues(added->tree(), 1,
+                                       openvdb::tools::NN_FACE);
+    added->tree().topologyIntersection(closed->tree());
+    added->setTransform(sdf->transform().copy());
+
+    UFD_TRACE_SCOPE("patch");
+    auto patch = openvdb::tools::topologyToLevelSet(*added, 3, 0);
+    openvdb::tools::csgUnion(*sdf, *patch);
+    return sdf;
+}
 
-        auto mesh_sdf =
-            openvdb::tools::meshToSignedDistanceField<openvdb::FloatGrid>(
-                *xform, points, triangles, quads, half_band, half_band);
+openvdb::FloatGrid::Ptr close_sdf(const EnvelopeConfig& config,
+                                  openvdb::FloatGrid::Ptr sdf,
+                                  float half_band)
+{
+    const float close_world = static_cast<float>(config.hole_threshold);
+    if (close_world <= 0.0f) return sdf;
+
+    ScopedPhase phase("closing");
+    switch (config.closing) {
+    case ClosingMode::LevelSet:
+        return close_sdf_level_set(sdf, close_world, half_band);
+    case ClosingMode::Topology:
+        return close_sdf_topology(
+            sdf, close_world / static_cast<float>(config.voxel_size));
+    }
+    return sdf;
+}
+
+// Narrow band must be wide enough to survive the level-set closing pass;
+// topology closing works on the interior mask and needs no extra band.
+float closing_half_band(const EnvelopeConfig& config) {
+    const float close_vox = static_cast<float>(config.hole_threshold
+                                               / config.voxel_size);
+    return config.closing == ClosingMode::LevelSet ? close_vox + 3.0f : 3.0f;
+}
+
+// How far, in voxels, the closed SDF at a voxel depends on geometry: the
+// closing dilates and then erodes by its radius, over the band.
+int closing_reach(const EnvelopeConfig& config) {
+    const float close_vox = static_cast<float>(config.hole_threshold
+                                               / config.voxel_size);
+    return static_cast<int>(std::ceil(2.0f * close_vox
+                                      + closing_half_band(config))) + 1;
+}
+
+// Voxelize and close the meshes at config.voxel_size.
+openvdb::FloatGrid::Ptr closed_sdf(const EnvelopeConfig& config,
+                                   const std::vector<MeshGeometry>& geoms,
+                                   const std::vector<GfMatrix4d>& world_xforms,
+                                   EnvelopeStats* stats)
+{
+    const float vox       = static_cast<float>(config.voxel_size);
+    const float half_band = closing_half_band(config);
+
+    auto xform = openvdb::math::Transform::createLinearTransform(
+        static_cast<double>(vox));
+
+    auto sdf = union_sdf(config, geoms, world_xforms, *xform, half_band, stats);
+    if (!sdf || sdf->empty()) return nullptr;
+    return close_sdf(config, sdf, half_band);
+}
+
+// Half width, in coarse voxels, of the shell around the coarse surface that
+// is refined at the fine voxel size.
+constexpr float k_refine_band_vox = 2.0f;
+
+// Drop polygons buried more than margin inside the closed coarse envelope:
+// they cannot move the fine zero crossing.  A polygon is kept when the coarse
+// SDF at its centroid is within margin plus its circumradius of the surface.
+MeshGeometry near_surface(const MeshGeometry& geom,
+                          const openvdb::FloatGrid& coarse,
+                          float margin)
+{
+    openvdb::tools::GridSampler<openvdb::FloatGrid::ConstAccessor,
+                                openvdb::tools::BoxSampler>
+        sampler(coarse.getConstAccessor(), coarse.transform());
+    // Inactive interior voxels only bound the depth from below by the band
+    const float bg = coarse.background();
+
+    const auto keep = [&](const auto& poly, int corners) {
+        openvdb::Vec3s centroid(0.0f);
+        for (int c = 0; c < corners; ++c) centroid += geom.points[poly[c]];
+        centroid /= static_cast<float>(corners);
+        float radius = 0.0f;
+        for (int c = 0; c < corners; ++c)
+            radius = std::max(radius, (geom.points[poly[c]] - centroid).length());
+
+        const float reach = radius + margin;
+        const float value = sampler.wsSample(openvdb::Vec3d(centroid));
+        return value <= -bg ? reach >= bg : value > -reach;
+    };
+
+    MeshGeometry kept;
+    kept.points       = geom.points;
+    kept.content_hash = geom.content_hash;
+    for (const auto& t : geom.triangles)
+        if (keep(t, 3)) kept.triangles.push_back(t);
+    for (const auto& q : geom.quads)
+        if (keep(q, 4)) kept.quads.push_back(q);
+    return kept;
+}
+
+// Coarse-to-fine: refine a closed SDF built at voxel_size * coarse_factor.
+// Only polygons near the coarse surface are voxelized at the fine voxel size,
+// with a minimal band.  Inside a shell of k_refine_band_vox coarse voxels
+// around the coarse surface, the fine distance wins unless the coarse one is
+// further inside by more than a coarse voxel; there the closing bridged a gap
+// the fine geometry leaves open.  One rebuild then restores a clean fine
+// narrow band.
+openvdb::FloatGrid::Ptr refine_sdf(const EnvelopeConfig& config,
+                                   const std::vector<MeshGeometry>& geoms,
+                                   const openvdb::FloatGrid& coarse,
+                                   EnvelopeStats* stats)
+{
+    ScopedPhase phase("voxelization");
+    constexpr float k_fine_band = 3.0f;
+    const float vox        = static_cast<float>(config.voxel_size);
+    const float coarse_vox = static_cast<float>(coarse.voxelSize()[0]);
+
+    std::vector<MeshGeometry> kept(geoms.size());
+    tbb::parallel_for(size_t(0), geoms.size(), [&](size_t i) {
+        kept[i] = near_surface(geoms[i], coarse, coarse_vox + k_fine_band * vox);
+    });
 
-        if (!sdf) {
-            sdf = mesh_sdf;
+    size_t total_faces = 0;
+    size_t kept_faces  = 0;
+    for (size_t i = 0; i < geoms.size(); ++i) {
+        total_faces += face_count(geoms[i]);
+        kept_faces  += face_count(kept[i]);
+    }
+    std::cerr << "EnvelopeBuilder: refining " << kept_faces << " of "
+              << total_faces << " faces near the coarse surface\n";
+    if (stats) stats->refined_face_count = kept_faces;
+
+    auto xform = openvdb::math::Transform::createLinearTransform(
+        static_cast<double>(vox));
+    const MeshGeometry soup = merge_soup(kept);
+    auto fine = voxelize_mesh(*xform, soup, k_fine_band);
+
+    // Coarse shell resampled to the fine voxel size; not flagged as a level
+    // set, so resampleToMatch samples values instead of re-meshing.
+    auto shell = openvdb::tools::levelSetRebuild(
+        coarse, 0.0f, k_refine_band_vox, k_refine_band_vox);
+    shell->setGridClass(openvdb::GRID_UNKNOWN);
+    auto merged = openvdb::FloatGrid::create(shell->background());
+    merged->setTransform(xform->copy());
+    openvdb::tools::resampleToMatch<openvdb::tools::BoxSampler>(*shell, *merged);
+
+    // Values only change in place, so leaves are merged in parallel
+    const float tol = coarse_vox;
+    openvdb::tree::LeafManager<openvdb::FloatTree> leaves(merged->tree());
+    leaves.foreach([&](openvdb::FloatTree::LeafNodeType& leaf, size_t) {
+        auto fine_acc = fine->getConstAccessor();
+        for (auto it = leaf.beginValueOn(); it; ++it) {
+            const float f = fine_acc.getValue(it.getCoord());
+            if (!(*it < f - tol)) it.setValue(f);
+        }
+    });
+    openvdb::tools::signedFloodFill(merged->tree());
+
+    return openvdb::tools::levelSetRebuild(*merged, 0.0f,
+                                           k_fine_band, k_fine_band);
+}
+
+// Hash of a mesh's world-space points and polygons.
+uint64_t world_geometry_hash(const MeshGeometry& geom) {
+    uint64_t h = hash_bytes(geom.points.data(),
+                            geom.points.size() * sizeof(openvdb::Vec3s));
+    h = hash_bytes(geom.triangles.data(),
+                   geom.triangles.size() * sizeof(openvdb::Vec3I), h);
+    return hash_bytes(geom.quads.data(),
+                      geom.quads.size() * sizeof(openvdb::Vec4I), h);
+}
+
+// Hash of the config fields that change the closed SDF.
+uint64_t settings_key(const EnvelopeConfig& config) {
+    uint64_t key = hash_bytes(&config.voxel_size, sizeof(config.voxel_size));
+    key = hash_bytes(&config.hole_threshold, sizeof(config.hole_threshold), key);
+    key = hash_combine(key, static_cast<uint64_t>(config.closing));
+    return hash_combine(key, static_cast<uint64_t>(config.coarse_factor));
+}
+
+// Content key for the closed SDF: world-space geometry of every mesh, in
+// order, plus the config fields that change the result.
+uint64_t cache_key(const EnvelopeConfig& config,
+                   const std::vector<MeshGeometry>& geoms)
+{
+    std::vector<uint64_t> mesh_keys(geoms.size());
+    tbb::parallel_for(size_t(0), geoms.size(), [&](size_t i) {
+        mesh_keys[i] = world_geometry_hash(geoms[i]);
+    });
+    return hash_bytes(mesh_keys.data(), mesh_keys.size() * sizeof(uint64_t),
+                      settings_key(config));
+}
+
+// Incremental build against the per-mesh SDFs and closed result of the last
+// build held in store.  Meshes whose key (world geometry plus voxelization
+// settings) is unchanged reuse their stored SDF; the rest are re-voxelized.
+// The union and closing are then redone only inside the region the changes
+// can reach: the old and new SDF bounds of every changed, added or removed
+// mesh, grown by the closing's reach (dilation plus erosion) and the band.
+// That region is computed from all meshes overlapping it, with another reach
+// of context, and spliced into the previous closed SDF.  Stored SDFs the last
+// build did not use (left by a build that ended early or a process that
+// died before recording it) count as changed; if an old SDF is no longer
+// stored its extent is unknown, and the whole envelope is rebuilt.
+openvdb::FloatGrid::Ptr incremental_sdf(const EnvelopeConfig& config,
+                                        const std::vector<UsdGeomMesh>& meshes,
+                                        const std::vector<MeshGeometry>& geoms,
+                                        MeshSdfStore& store,
+                                        EnvelopeStats* stats)
+{
+    const float vox       = static_cast<float>(config.voxel_size);
+    const float half_band = closing_half_band(config);
+    auto xform = openvdb::math::Transform::createLinearTransform(
+        static_cast<double>(vox));
+
+    const uint64_t settings = settings_key(config);
+    std::vector<std::string> paths(meshes.size());
+    std::vector<uint64_t>    keys(meshes.size());
+    tbb::parallel_for(size_t(0), meshes.size(), [&](size_t i) {
+        paths[i] = meshes[i].GetPath().GetString();
+        keys[i]  = hash_bytes(&half_band, sizeof(half_band),
+                   hash_bytes(&config.voxel_size, sizeof(config.voxel_size),
+                              world_geometry_hash(geoms[i])));
+    });
+
+    const MeshSdfStore::Build previous = store.last_build();
+    bool splice = previous.closed && previous.settings_key == settings;
+
+    // Region touched by changes, in index space: old bounds first, before
+    // the new SDFs replace the stored ones.
+    openvdb::CoordBBox dirty;
+    std::unordered_map<std::string, size_t> current;
+    for (size_t i = 0; i < paths.size(); ++i) current.emplace(paths[i], i);
+    for (const auto& [path, key] : previous.mesh_keys) {
+        auto it = current.find(path);
+        if (it != current.end() && keys[it->second] == key) continue;
+        if (auto old = store.find(path, key)) {
+            dirty.expand(old->evalActiveVoxelBoundingBox());
         } else {
-            openvdb::tools::csgUnion(*sdf, *mesh_sdf);
+            splice = false;
         }
+        if (it == current.end()) store.erase(path);
     }
 
-    if (!sdf || sdf->empty()) return {};
+    std::vector<openvdb::FloatGrid::Ptr> sdfs(meshes.size());
+    std::vector<size_t> misses;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        sdfs[i] = store.find(paths[i], keys[i]);
+        if (!sdfs[i]) misses.push_back(i);
+    }
+    {
+        ScopedPhase phase("voxelization");
+        tbb::parallel_for(size_t(0), misses.size(), [&](size_t m) {
+            const size_t i = misses[m];
+            UFD_TRACE_SCOPE_ARG("mesh_sdf", "mesh", i);
+            sdfs[i] = voxelize_mesh(*xform, geoms[i], half_band);
+            store.put(paths[i], keys[i], sdfs[i]);
+        });
+    }
+    for (size_t i : misses) dirty.expand(sdfs[i]->evalActiveVoxelBoundingBox());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        auto it = previous.mesh_keys.find(paths[i]);
+        if (it == previous.mesh_keys.end() || it->second != keys[i])
+            dirty.expand(sdfs[i]->evalActiveVoxelBoundingBox());
+    }
 
-    // Morphological closing: dilate then erode by close_world (world units).
-    // Bridges holes/gaps smaller than hole_threshold.
-    if (close_world > 0.0f) {
-        {
-            openvdb::tools::LevelSetFilter<openvdb::FloatGrid> f(*sdf);
-            f.offset(-close_world);  // dilate
+    std::cerr << "EnvelopeBuilder: incremental build, re-voxelized "
+              << misses.size() << " of " << meshes.size() << " meshes\n";
+    if (stats) {
+        stats->mode              = VoxelizeMode::PerMesh;
+        stats->mesh_count        = geoms.size();
+        stats->face_count        = 0;
+        for (const auto& geom : geoms) stats->face_count += face_count(geom);
+        stats->voxelized_count   = misses.size();
+        stats->reused_mesh_count = meshes.size() - misses.size();
+    }
+
+    // Stored SDFs are shared; the union works on copies clipped to a box
+    const auto union_within = [&](const openvdb::CoordBBox* box) {
+        ScopedPhase phase("voxelization");
+        std::vector<openvdb::FloatGrid::Ptr> inputs;
+        const openvdb::BBoxd world = box ? xform->indexToWorld(*box)
+                                         : openvdb::BBoxd();
+        for (const auto& sdf : sdfs) {
+            if (box && !box->hasOverlap(sdf->evalActiveVoxelBoundingBox()))
+                continue;
+            inputs.push_back(sdf);
         }
-        sdf = openvdb::tools::levelSetRebuild(*sdf, 0.0f, half_band, half_band);
-        {
-            openvdb::tools::LevelSetFilter<openvdb::FloatGrid> f(*sdf);
-            f.offset(close_world);   // erode
+        if (inputs.empty()) return openvdb::FloatGrid::Ptr();
+        return voxelize_and_union([&](size_t i) {
+            return box ? openvdb::tools::clip(*inputs[i], world)
+                       : inputs[i]->deepCopy();
+        }, 0, inputs.size());
+    };
+
+    // Recorded even when the envelope comes out empty, so the next build
+    // starts from the SDFs this one stored; an empty result has no closed
+    // SDF to splice into and makes the next build a full one.
+    MeshSdfStore::Build build;
+    build.settings_key = settings;
+    for (size_t i = 0; i < paths.size(); ++i) build.mesh_keys[paths[i]] = keys[i];
+    const auto empty_result = [&] {
+        store.set_last_build(build);
+        return openvdb::FloatGrid::Ptr();
+    };
+
+    openvdb::FloatGrid::Ptr sdf;
+    if (!splice) {
+        sdf = union_within(nullptr);
+        if (!sdf || sdf->empty()) return empty_result();
+        sdf = close_sdf(config, sdf, half_band);
+    } else if (dirty.empty()) {
+        sdf = previous.closed;
+    } else {
+        const int reach = closing_reach(config);
+        openvdb::CoordBBox region = dirty;
+        region.expand(reach);
+        openvdb::CoordBBox context = region;
+        context.expand(reach);
+
+        // Outside the region the previous result stands; the patch overlaps
+        // it by a voxel so the two leave no seam.
+        sdf = openvdb::tools::clip(*previous.closed,
+                                   xform->indexToWorld(region), false);
+        if (auto patch = union_within(&context)) {
+            patch = close_sdf(config, patch, half_band);
+            openvdb::CoordBBox overlap = region;
+            overlap.expand(1);
+            patch = openvdb::tools::clip(*patch, xform->indexToWorld(overlap));
+            openvdb::tools::compReplace(*sdf, *patch);
         }
-        sdf = openvdb::tools::levelSetRebuild(*sdf, 0.0f, half_band, half_band);
+        openvdb::tools::signedFloodFill(sdf->tree());
+        openvdb::tools::pruneLevelSet(sdf->tree());
+        if (sdf->empty()) return empty_result();
+    }
+
+    build.closed = sdf;
+    store.set_last_build(build);
+    return sdf;
+}
+
+// Curvature radius, in voxels, below which the surface counts as a feature.
+constexpr float k_feature_radius_vox = 4.0f;
+// Bisection steps when searching adaptivity for a face budget; 2^-7 is finer
+// than the face count responds to.
+constexpr int k_adaptivity_search_steps = 7;
+
+// Per-voxel adaptivity multiplier for VolumeToMesh: 1 on flat patches,
+// falling to 0 where the surface bends within k_feature_radius_vox voxels, so
+// adaptive meshing merges flat regions but keeps edges and thin parts.
+openvdb::FloatGrid::Ptr feature_adaptivity(const openvdb::FloatGrid& sdf)
+{
+    UFD_TRACE_SCOPE("feature_adaptivity");
+    auto mask = openvdb::tools::meanCurvature(sdf);
+    const float vox = static_cast<float>(sdf.voxelSize()[0]);
+    openvdb::tools::foreach(mask->beginValueOn(),
+        [vox](const openvdb::FloatGrid::ValueOnIter& it) {
+            const float bend = std::abs(*it) * vox * k_feature_radius_vox;
+            it.setValue(std::max(0.0f, 1.0f - bend));
+        });
+    // Voxels outside the band are far from any feature
+    openvdb::tools::changeBackground(mask->tree(), 1.0f);
+    return mask;
+}
+
+size_t polygon_count(const openvdb::tools::VolumeToMesh& mesher) {
+    size_t n = 0;
+    const auto& pools = mesher.polygonPoolList();
+    for (size_t i = 0; i < mesher.polygonPoolListSize(); ++i)
+        n += pools[i].numQuads() + pools[i].numTriangles();
+    return n;
+}
+
+std::unique_ptr<openvdb::tools::VolumeToMesh> mesh_sdf(
+    const openvdb::FloatGrid& sdf,
+    double adaptivity,
+    const openvdb::FloatGrid::ConstPtr& features)
+{
+    UFD_TRACE_SCOPE("volume_to_mesh");
+    auto mesher = std::make_unique<openvdb::tools::VolumeToMesh>(0.0, adaptivity);
+    if (features) mesher->setSpatialAdaptivity(features);
+    (*mesher)(sdf);
+    return mesher;
+}
+
+// Iso-surface the SDF at config.adaptivity.  With a face budget, bisect
+// adaptivity in [config.adaptivity, 1] for the smallest value whose output
+// fits; face count falls monotonically enough with adaptivity for this to
+// land within a few percent of the budget.  adaptivity receives the value
+// used.
+std::unique_ptr<openvdb::tools::VolumeToMesh> mesh_envelope(
+    const EnvelopeConfig& config,
+    const openvdb::FloatGrid& sdf,
+    double& adaptivity)
+{
+    const size_t budget = config.target_face_count;
+    double lo = std::clamp(config.adaptivity, 0.0, 1.0);
+
+    openvdb::FloatGrid::ConstPtr features;
+    if (config.preserve_features && (lo > 0.0 || budget > 0))
+        features = feature_adaptivity(sdf);
+
+    adaptivity = lo;
+    auto best = mesh_sdf(sdf, lo, features);
+    if (budget == 0 || polygon_count(*best) <= budget) return best;
+
+    double hi = 1.0;
+    auto coarsest = mesh_sdf(sdf, hi, features);
+    if (polygon_count(*coarsest) > budget && features) {
+        // Preserved features alone exceed the budget; let them coarsen too
+        std::cerr << "EnvelopeBuilder: face budget " << budget
+                  << " unreachable with features preserved; ignoring them\n";
+        features.reset();
+        coarsest = mesh_sdf(sdf, hi, features);
+    }
+    adaptivity = hi;
+    if (polygon_count(*coarsest) > budget) {
+        std::cerr << "EnvelopeBuilder: " << polygon_count(*coarsest)
+                  << " faces at full adaptivity exceeds the budget of "
+                  << budget << "\n";
+        return coarsest;
+    }
+    best = std::move(coarsest);
+
+    for (int step = 0; step < k_adaptivity_search_steps; ++step) {
+        const double mid = 0.5 * (lo + hi);
+        auto mesher = mesh_sdf(sdf, mid, features);
+        if (polygon_count(*mesher) <= budget) {
+            hi = mid;
+            adaptivity = mid;
+            best = std::move(mesher);
+        } else {
+            lo = mid;
+        }
+    }
+    return best;
+}
+
+// Largest |SDF| (world units) over the mesher's vertices and polygon
+// centroids: how far the emitted surface strays from the zero level set.
+double max_deviation(const openvdb::FloatGrid& sdf,
+                     const openvdb::tools::VolumeToMesh& mesher)
+{
+    UFD_TRACE_SCOPE("max_deviation");
+    using Sampler = openvdb::tools::GridSampler<
+        openvdb::FloatGrid::ConstAccessor, openvdb::tools::BoxSampler>;
+    auto max_of = [](double a, double b) { return std::max(a, b); };
+
+    const auto& pts = mesher.pointList();
+    const double vertex_max = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, mesher.pointListSize()), 0.0,
+        [&](const tbb::blocked_range<size_t>& r, double m) {
+            Sampler sampler(sdf.getConstAccessor(), sdf.transform());
+            for (size_t i = r.begin(); i < r.end(); ++i)
+                m = std::max(m, std::abs(double(sampler.wsSample(
+                                    openvdb::Vec3d(pts[i])))));
+            return m;
+        }, max_of);
+
+    const auto& pools = mesher.polygonPoolList();
+    const double centroid_max = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, mesher.polygonPoolListSize()), 0.0,
+        [&](const tbb::blocked_range<size_t>& r, double m) {
+            Sampler sampler(sdf.getConstAccessor(), sdf.transform());
+            auto sample = [&](const openvdb::Vec3d& p) {
+                m = std::max(m, std::abs(double(sampler.wsSample(p))));
+            };
+            for (size_t pi = r.begin(); pi < r.end(); ++pi) {
+                const auto& pool = pools[pi];
+                for (size_t qi = 0; qi < pool.numQuads(); ++qi) {
+                    const openvdb::Vec4I& q = pool.quad(qi);
+                    sample(0.25 * (openvdb::Vec3d(pts[q[0]]) + pts[q[1]]
+                                 + pts[q[2]] + pts[q[3]]));
+                }
+                for (size_t ti = 0; ti < pool.numTriangles(); ++ti) {
+                    const openvdb::Vec3I& t = pool.triangle(ti);
+                    sample((openvdb::Vec3d(pts[t[0]]) + pts[t[1]] + pts[t[2]])
+                           / 3.0);
+                }
+            }
+            return m;
+        }, max_of);
+
+    return std::max(vertex_max, centroid_max);
+}
+
+// Export sdf if sdf_path is set, iso-surface it and write the result to
+// stage as /Envelope: the shared tail of the untiled builds.
+std::string write_envelope(UsdStageRefPtr stage, const EnvelopeConfig& config,
+                           const openvdb::FloatGrid& sdf,
+                           const std::string& sdf_path, EnvelopeStats* stats)
+{
+    const std::string prim_path = "/Envelope";
+    if (stats) {
+        stats->active_voxel_count = sdf.activeVoxelCount();
+        stats->sdf_bytes          = sdf.memUsage();
     }
+    Metrics::global().record_grid("closed", sdf);
 
-    // Optionally save the SDF as a raw binary for Python (no pyopenvdb needed).
-    // Format: int32 nx,ny,nz  float32 ox,oy,oz,voxel_size,background  then nx*ny*nz float32
-    // Dense<LayoutZYX>: data[ix*ny*nz + iy*nz + iz] = value at (ix,iy,iz), C-order.
+    // Optionally save the SDF for Python (no pyopenvdb needed); see SdfFormat
+    // for the file layouts.
     if (!sdf_path.empty()) {
+        ScopedPhase phase("sdf_export");
         try {
-            openvdb::CoordBBox bbox = sdf->evalActiveVoxelBoundingBox();
-            openvdb::tools::Dense<float, openvdb::tools::LayoutZYX> dense(bbox);
-            openvdb::tools::copyToDense(*sdf, dense);
-
-            const int32_t nx = bbox.dim().x();
-            const int32_t ny = bbox.dim().y();
-            const int32_t nz = bbox.dim().z();
-            const float   ox = static_cast<float>(bbox.min().x()) * vox;
-            const float   oy = static_cast<float>(bbox.min().y()) * vox;
-            const float   oz = static_cast<float>(bbox.min().z()) * vox;
-            const float   bg = static_cast<float>(sdf->background());
-
-            std::ofstream out(sdf_path, std::ios::binary);
-            if (!out) throw std::runtime_error("cannot open " + sdf_path);
-
-            const auto write = [&out](const void* p, std::streamsize n) {
-                out.write(reinterpret_cast<const char*>(p), n);
-            };
-            write(&nx,  4);
-            write(&ny,  4);
-            write(&nz,  4);
-            write(&ox,  4);
-            write(&oy,  4);
-            write(&oz,  4);
-            write(&vox, 4);
-            write(&bg,  4);
-            write(dense.data(), static_cast<std::streamsize>(nx) * ny * nz * 4);
-            std::cerr << "EnvelopeBuilder: saved SDF binary to " << sdf_path
-                      << " (" << nx << "x" << ny << "x" << nz << ")\n";
+            write_sdf(sdf, sdf_path, config.sdf_format);
+            std::cerr << "EnvelopeBuilder: saved " << to_string(config.sdf_format)
+                      << " SDF to " << sdf_path << "\n";
         } catch (const std::exception& e) {
             std::cerr << "EnvelopeBuilder: failed to save SDF: " << e.what() << "\n";
         }
     }
 
-    // Iso-surface the SDF at the zero level set
-    openvdb::tools::VolumeToMesh mesher(0.0);
+    // Iso-surface the SDF at the zero level set, coarsening flat regions as
+    // far as the adaptivity settings allow, and gather the result into USD
+    // arrays with outward-facing winding
+    double adaptivity = 0.0;
+    std::unique_ptr<openvdb::tools::VolumeToMesh> mesher_ptr;
+    SurfaceData surface;
+    {
+        ScopedPhase phase("meshing");
+        mesher_ptr = mesh_envelope(config, sdf, adaptivity);
+        surface    = gather_mesh(*mesher_ptr);
+    }
+    const openvdb::tools::VolumeToMesh& mesher = *mesher_ptr;
+    if (adaptivity > 0.0) {
+        std::cerr << "EnvelopeBuilder: meshed at adaptivity " << adaptivity
+                  << " (" << polygon_count(mesher) << " faces)\n";
+    }
+    if (stats) {
+        stats->adaptivity          = adaptivity;
+        stats->envelope_face_count = polygon_count(mesher);
+        stats->max_deviation       = max_deviation(sdf, mesher);
+    }
+
+    // Write to stage
+    ScopedPhase phase("usd_authoring");
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath(prim_path));
+    mesh.GetPointsAttr().Set(surface.points);
+    mesh.GetFaceVertexCountsAttr().Set(surface.face_vertex_counts);
+    mesh.GetFaceVertexIndicesAttr().Set(surface.face_vertex_indices);
+    mesh.GetSubdivisionSchemeAttr().Set(UsdGeomTokens->none);
+
+    return prim_path;
+}
+
+// Grid memory per voxel of a padded brick when the band fills it: the
+// unioned SDF, meshToVolume's closest-primitive index grid and a
+// levelSetRebuild output, 4 bytes each.  This bounds the brick's own grids
+// only: a shell reaching the brick is voxelized whole before it is clipped,
+// so a shell larger than the brick adds its full SDF on top.
+constexpr double k_brick_bytes_per_voxel = 12.0;
+
+// Cubic, leaf-aligned bricks of a tiled build in index space: counts bricks
+// of brick_vox voxels per axis from origin.  Each brick is voxelized over
+// itself plus overlap voxels on every side.
+struct BrickLayout {
+    openvdb::Coord origin{0, 0, 0};
+    openvdb::Coord counts{0, 0, 0};
+    int            brick_vox = 0;
+    int            overlap   = 0;
+
+    size_t size() const {
+        return size_t(counts.x()) * size_t(counts.y()) * size_t(counts.z());
+    }
+
+    // Voxels brick k owns; only it emits polygons there.
+    openvdb::CoordBBox owned(size_t k) const {
+        const size_t nx = size_t(counts.x());
+        const size_t ny = size_t(counts.y());
+        const openvdb::Coord min(
+            origin.x() + static_cast<int>(k % nx) * brick_vox,
+            origin.y() + static_cast<int>(k / nx % ny) * brick_vox,
+            origin.z() + static_cast<int>(k / nx / ny) * brick_vox);
+        return openvdb::CoordBBox(min, min.offsetBy(brick_vox - 1));
+    }
+};
+
+// Index-space box around a mesh's points, one voxel wider each side.
+openvdb::CoordBBox index_bounds(const MeshGeometry& geom,
+                                const openvdb::math::Transform& xform)
+{
+    if (geom.points.empty()) return {};
+    openvdb::Vec3d lo(std::numeric_limits<double>::max());
+    openvdb::Vec3d hi(std::numeric_limits<double>::lowest());
+    for (const auto& p : geom.points) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], double(p[a]));
+            hi[a] = std::max(hi[a], double(p[a]));
+        }
+    }
+    openvdb::CoordBBox box(openvdb::Coord::floor(xform.worldToIndex(lo)),
+                           openvdb::Coord::ceil(xform.worldToIndex(hi)));
+    box.expand(1);
+    return box;
+}
+
+// One closed shell of a mesh in a tiled build: the whole mesh, or the
+// polygons of one connected component of a mesh larger than a brick.
+struct MeshShell {
+    size_t                mesh  = 0;
+    bool                  whole = true;
+    std::vector<uint32_t> triangles;  // indices into the mesh's polygons
+    std::vector<uint32_t> quads;
+};
+
+// Split geom into connected shells, polygons sharing a vertex being in the
+// same shell.  Each shell of a closed mesh is closed itself, so it
+// voxelizes on its own and the union of the shells' SDFs is the mesh's.
+std::vector<MeshShell> connected_shells(const MeshGeometry& geom, size_t mesh) {
+    std::vector<uint32_t> parent(geom.points.size());
+    std::iota(parent.begin(), parent.end(), 0u);
+    auto find = [&](uint32_t v) {
+        while (parent[v] != v) v = parent[v] = parent[parent[v]];
+        return v;
+    };
+    auto join = [&](uint32_t a, uint32_t b) { parent[find(a)] = find(b); };
+    for (const auto& t : geom.triangles) {
+        join(t[0], t[1]);
+        join(t[0], t[2]);
+    }
+    for (const auto& q : geom.quads) {
+        join(q[0], q[1]);
+        join(q[0], q[2]);
+        join(q[0], q[3]);
+    }
+
+    std::unordered_map<uint32_t, size_t> shell_of;  // root vertex -> shell
+    std::vector<MeshShell> shells;
+    auto shell = [&](uint32_t v) -> MeshShell& {
+        auto [it, inserted] = shell_of.emplace(find(v), shells.size());
+        if (inserted) {
+            shells.emplace_back();
+            shells.back().mesh  = mesh;
+            shells.back().whole = false;
+        }
+        return shells[it->second];
+    };
+    for (size_t t = 0; t < geom.triangles.size(); ++t)
+        shell(geom.triangles[t][0]).triangles.push_back(uint32_t(t));
+    for (size_t q = 0; q < geom.quads.size(); ++q)
+        shell(geom.quads[q][0]).quads.push_back(uint32_t(q));
+
+    if (shells.size() <= 1) {
+        MeshShell whole;
+        whole.mesh = mesh;
+        return {whole};
+    }
+    return shells;
+}
+
+// The polygons of shell as a mesh of their own, with only the points they
+// use.
+MeshGeometry shell_geometry(const MeshGeometry& geom, const MeshShell& shell) {
+    MeshGeometry out;
+    std::unordered_map<uint32_t, uint32_t> remap;
+    auto point = [&](uint32_t v) {
+        auto [it, inserted] = remap.emplace(v, uint32_t(out.points.size()));
+        if (inserted) out.points.push_back(geom.points[v]);
+        return it->second;
+    };
+    out.triangles.reserve(shell.triangles.size());
+    for (uint32_t t : shell.triangles) {
+        const auto& tri = geom.triangles[t];
+        out.triangles.emplace_back(point(tri[0]), point(tri[1]), point(tri[2]));
+    }
+    out.quads.reserve(shell.quads.size());
+    for (uint32_t q : shell.quads) {
+        const auto& quad = geom.quads[q];
+        out.quads.emplace_back(point(quad[0]), point(quad[1]), point(quad[2]),
+                               point(quad[3]));
+    }
+    return out;
+}
+
+// Index-space box around the points of shell, one voxel wider each side.
+openvdb::CoordBBox index_bounds(const MeshGeometry& geom, const MeshShell& shell,
+                                const openvdb::math::Transform& xform)
+{
+    if (shell.whole) return index_bounds(geom, xform);
+    openvdb::Vec3d lo(std::numeric_limits<double>::max());
+    openvdb::Vec3d hi(std::numeric_limits<double>::lowest());
+    auto add = [&](uint32_t v) {
+        const auto& p = geom.points[v];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], double(p[a]));
+            hi[a] = std::max(hi[a], double(p[a]));
+        }
+    };
+    for (uint32_t t : shell.triangles)
+        for (int c = 0; c < 3; ++c) add(geom.triangles[t][c]);
+    for (uint32_t q : shell.quads)
+        for (int c = 0; c < 4; ++c) add(geom.quads[q][c]);
+    openvdb::CoordBBox box(openvdb::Coord::floor(xform.worldToIndex(lo)),
+                           openvdb::Coord::ceil(xform.worldToIndex(hi)));
+    box.expand(1);
+    return box;
+}
+
+// Split the geometry's index bounds into bricks: of tiles.brick_size if set,
+// else as large as tiles.memory_budget allows, else one brick for everything.
+BrickLayout brick_layout(const EnvelopeConfig& config, const TileConfig& tiles,
+                         const std::vector<openvdb::CoordBBox>& bounds)
+{
+    constexpr int leaf = openvdb::FloatTree::LeafNodeType::DIM;
+
+    BrickLayout layout;
+    // One voxel more than the closing reach: cells meshed at a brick face
+    // read the voxel beyond it.
+    layout.overlap = closing_reach(config) + 1;
+
+    openvdb::CoordBBox domain;
+    for (const auto& box : bounds) domain.expand(box);
+    if (domain.empty()) return layout;
+
+    int brick = 0;
+    if (tiles.brick_size > 0.0) {
+        brick = static_cast<int>(std::ceil(tiles.brick_size / config.voxel_size));
+    } else if (tiles.memory_budget > 0) {
+        const double padded = std::cbrt(double(tiles.memory_budget)
+                                        / k_brick_bytes_per_voxel);
+        // Rounded down to whole leaves so the padded brick stays in budget
+        brick = (static_cast<int>(padded) - 2 * layout.overlap) / leaf * leaf;
+        if (brick < leaf) {
+            std::cerr << "EnvelopeBuilder: memory budget of "
+                      << tiles.memory_budget << " bytes is too small for the "
+                      << layout.overlap << "-voxel brick overlap; using "
+                      << leaf << "-voxel bricks\n";
+        }
+    } else {
+        const openvdb::Coord dim = domain.dim();
+        brick = std::max({dim.x(), dim.y(), dim.z()});
+    }
+    // Whole leaves, so brick faces fall on leaf boundaries
+    layout.brick_vox = std::max(leaf, (brick + leaf - 1) / leaf * leaf);
+
+    for (int a = 0; a < 3; ++a) {
+        const int min = domain.min()[a];
+        layout.origin[a] = (min >= 0 ? min : min - leaf + 1) / leaf * leaf;
+        layout.counts[a] = (domain.max()[a] - layout.origin[a])
+                         / layout.brick_vox + 1;
+    }
+    return layout;
+}
+
+// Active voxels of sdf inside box.
+uint64_t active_voxels_in(const openvdb::FloatGrid& sdf,
+                          const openvdb::CoordBBox& box)
+{
+    uint64_t n = 0;
+    for (auto leaf = sdf.tree().cbeginLeaf(); leaf; ++leaf) {
+        const openvdb::CoordBBox node = leaf->getNodeBoundingBox();
+        if (!box.hasOverlap(node)) continue;
+        if (box.isInside(node)) {
+            n += leaf->onVoxelCount();
+            continue;
+        }
+        for (auto it = leaf->cbeginValueOn(); it; ++it)
+            if (box.isInside(it.getCoord())) ++n;
+    }
+    return n;
+}
+
+// Voxelize brick k from the shells whose band reaches it, close it, and mesh
+// the part of the surface it owns.  The overlap covers everything the closed
+// SDF in the owned voxels depends on, so neighbouring bricks agree exactly
+// where they meet.
+SurfaceData build_brick(const EnvelopeConfig& config, const BrickLayout& layout,
+                        const std::vector<MeshGeometry>& geoms,
+                        const std::vector<MeshShell>& shells,
+                        const std::vector<openvdb::CoordBBox>& bounds,
+                        size_t k, uint64_t& active_voxels, uint64_t& sdf_bytes)
+{
+    UFD_TRACE_SCOPE_ARG("brick", "brick", k);
+    active_voxels = 0;
+    sdf_bytes     = 0;
+
+    const float half_band = closing_half_band(config);
+    auto xform = openvdb::math::Transform::createLinearTransform(
+        config.voxel_size);
+
+    const openvdb::CoordBBox owned = layout.owned(k);
+    openvdb::CoordBBox padded = owned;
+    padded.expand(layout.overlap);
+
+    std::vector<size_t> inputs;
+    const int band = static_cast<int>(std::ceil(half_band));
+    for (size_t i = 0; i < shells.size(); ++i) {
+        if (bounds[i].empty()) continue;
+        openvdb::CoordBBox reach = bounds[i];
+        reach.expand(band);
+        if (reach.hasOverlap(padded)) inputs.push_back(i);
+    }
+    if (inputs.empty()) return {};
+
+    // Shells are voxelized whole and clipped right after: meshToVolume signs
+    // distances by flood fill, which leaks through polygons cut open at the
+    // brick face.
+    const openvdb::BBoxd world = xform->indexToWorld(padded);
+    openvdb::FloatGrid::Ptr sdf;
+    {
+        ScopedPhase phase("voxelization");
+        sdf = voxelize_and_union([&](size_t j) {
+            const MeshShell& shell = shells[inputs[j]];
+            UFD_TRACE_SCOPE_ARG("mesh_sdf", "mesh", shell.mesh);
+            auto grid = shell.whole
+                ? voxelize_mesh(*xform, geoms[shell.mesh], half_band)
+                : voxelize_mesh(*xform, shell_geometry(geoms[shell.mesh], shell),
+                                half_band);
+            return openvdb::tools::clip(*grid, world);
+        }, 0, inputs.size());
+    }
+    if (sdf->empty()) return {};
+
+    sdf = close_sdf(config, sdf, half_band);
+    active_voxels = active_voxels_in(*sdf, owned);
+    sdf_bytes     = sdf->memUsage();
+
+    auto mask = openvdb::BoolGrid::create(false);
+    mask->setTransform(xform->copy());
+    mask->fill(owned, true);
+
+    ScopedPhase phase("meshing");
+    openvdb::tools::VolumeToMesh mesher(0.0, 0.0);
+    mesher.setSurfaceMask(mask);
     mesher(*sdf);
+    return gather_mesh(mesher);
+}
 
-    // Collect points
-    const size_t npts = mesher.pointListSize();
-    VtVec3fArray points(static_cast<unsigned>(npts));
-    const auto& vdb_pts = mesher.pointList();
-    for (size_t i = 0; i < npts; ++i) {
-        points[static_cast<unsigned>(i)] =
-            GfVec3f(vdb_pts[i][0], vdb_pts[i][1], vdb_pts[i][2]);
+// Spill file of brick k: a header, then points, face vertex counts and face
+// vertex indices as raw arrays.
+struct BrickHeader {
+    char     magic[8];
+    uint64_t active_voxels;
+    uint64_t sdf_bytes;
+    uint64_t points;
+    uint64_t counts;
+    uint64_t indices;
+};
+
+constexpr char k_brick_magic[8] = {'U', 'F', 'D', 'B', 'R', 'K', '0', '1'};
+
+std::string brick_file(const std::string& dir, size_t k) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "brick_%06zu.bin", k);
+    return (std::filesystem::path(dir) / name).string();
+}
+
+// Write a brick via a temporary file renamed into place, so a stitch never
+// reads a brick another process is still writing.
+bool write_brick(const std::string& path, const SurfaceData& surface,
+                 uint64_t active_voxels, uint64_t sdf_bytes)
+{
+    BrickHeader header;
+    std::memcpy(header.magic, k_brick_magic, sizeof(header.magic));
+    header.active_voxels = active_voxels;
+    header.sdf_bytes     = sdf_bytes;
+    header.points        = surface.points.size();
+    header.counts        = surface.face_vertex_counts.size();
+    header.indices       = surface.face_vertex_indices.size();
+
+    const std::string tmp = unique_temp_path(path);
+    std::error_code ec;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(surface.points.cdata()),
+                  header.points * sizeof(GfVec3f));
+        out.write(reinterpret_cast<const char*>(surface.face_vertex_counts.cdata()),
+                  header.counts * sizeof(int));
+        out.write(reinterpret_cast<const char*>(surface.face_vertex_indices.cdata()),
+                  header.indices * sizeof(int));
+        if (!out) {
+            std::cerr << "EnvelopeBuilder: failed to write " << tmp << "\n";
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
     }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::cerr << "EnvelopeBuilder: failed to write " << path << ": "
+                  << ec.message() << "\n";
+        return false;
+    }
+    return true;
+}
 
-    // Collect face topology
-    VtIntArray face_vertex_counts;
-    VtIntArray face_vertex_indices;
-    const auto& pools = mesher.polygonPoolList();
-    for (size_t pi = 0; pi < mesher.polygonPoolListSize(); ++pi) {
-        const auto& pool = pools[pi];
+bool read_brick(const std::string& path, SurfaceData& surface,
+                BrickHeader& header)
+{
+    std::ifstream in(path, std::ios::binary);
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, k_brick_magic, sizeof(header.magic))) {
+        std::cerr << "EnvelopeBuilder: missing or corrupt brick " << path << "\n";
+        return false;
+    }
+    surface.points.resize(header.points);
+    surface.face_vertex_counts.resize(header.counts);
+    surface.face_vertex_indices.resize(header.indices);
+    in.read(reinterpret_cast<char*>(surface.points.data()),
+            header.points * sizeof(GfVec3f));
+    in.read(reinterpret_cast<char*>(surface.face_vertex_counts.data()),
+            header.counts * sizeof(int));
+    in.read(reinterpret_cast<char*>(surface.face_vertex_indices.data()),
+            header.indices * sizeof(int));
+    if (!in) {
+        std::cerr << "EnvelopeBuilder: truncated brick " << path << "\n";
+        return false;
+    }
+    return true;
+}
 
-        // VolumeToMesh winds polygons with normals pointing inward; reverse to get outward normals.
-        for (size_t qi = 0; qi < pool.numQuads(); ++qi) {
-            const openvdb::Vec4I& q = pool.quad(qi);
-            face_vertex_counts.push_back(4);
-            face_vertex_indices.push_back(static_cast<int>(q[3]));
-            face_vertex_indices.push_back(static_cast<int>(q[2]));
-            face_vertex_indices.push_back(static_cast<int>(q[1]));
-            face_vertex_indices.push_back(static_cast<int>(q[0]));
+// Index bounds of every mesh of geometry.
+std::vector<openvdb::CoordBBox> mesh_index_bounds(const EnvelopeConfig& config,
+                                                  const GeometryCache& geometry)
+{
+    auto xform = openvdb::math::Transform::createLinearTransform(
+        config.voxel_size);
+    const auto& geoms = geometry.geometry();
+    std::vector<openvdb::CoordBBox> bounds(geoms.size());
+    tbb::parallel_for(size_t(0), geoms.size(), [&](size_t i) {
+        bounds[i] = index_bounds(geoms[i], *xform);
+    });
+    return bounds;
+}
+
+BrickLayout layout_of(const TilePlan& plan) {
+    BrickLayout layout;
+    layout.origin    = openvdb::Coord(plan.origin[0], plan.origin[1],
+                                      plan.origin[2]);
+    layout.counts    = openvdb::Coord(plan.counts[0], plan.counts[1],
+                                      plan.counts[2]);
+    layout.brick_vox = plan.brick_vox;
+    layout.overlap   = plan.overlap;
+    return layout;
+}
+
+// World geometry of the meshes, split into the shells bricks voxelize, with
+// the shells' index bounds and the brick layout.
+struct TiledInput {
+    const std::vector<MeshGeometry>& geoms;
+    std::vector<MeshShell>           shells;
+    std::vector<openvdb::CoordBBox>  bounds;  // per shell
+    BrickLayout                      layout;
+};
+
+// Meshes wider than a padded brick are split into their connected shells,
+// so a brick voxelizes only the shells that reach it.  A single shell
+// wider than a brick is still voxelized whole, and is reported.
+TiledInput tiled_input(const EnvelopeConfig& config, const BrickLayout& layout,
+                       const GeometryCache& geometry)
+{
+    TiledInput input{geometry.geometry(), {}, {}, layout};
+    auto xform = openvdb::math::Transform::createLinearTransform(
+        config.voxel_size);
+    const size_t nmeshes = input.geoms.size();
+    const std::vector<openvdb::CoordBBox> mesh_bounds =
+        mesh_index_bounds(config, geometry);
+
+    const int padded = input.layout.brick_vox + 2 * input.layout.overlap;
+    auto wider = [padded](const openvdb::CoordBBox& box) {
+        const openvdb::Coord dim = box.dim();
+        return std::max({dim.x(), dim.y(), dim.z()}) > padded;
+    };
+    std::vector<std::vector<MeshShell>> split(nmeshes);
+    tbb::parallel_for(size_t(0), nmeshes, [&](size_t i) {
+        if (input.layout.size() > 1 && wider(mesh_bounds[i])) {
+            split[i] = connected_shells(input.geoms[i], i);
+        } else {
+            split[i].emplace_back();
+            split[i].back().mesh = i;
         }
+    });
+    for (size_t i = 0; i < nmeshes; ++i) {
+        if (split[i].size() == 1) {
+            input.shells.push_back(std::move(split[i].front()));
+            input.bounds.push_back(mesh_bounds[i]);
+            continue;
+        }
+        for (auto& shell : split[i]) {
+            input.bounds.push_back(index_bounds(input.geoms[i], shell, *xform));
+            input.shells.push_back(std::move(shell));
+        }
+    }
 
-        for (size_t ti = 0; ti < pool.numTriangles(); ++ti) {
-            const openvdb::Vec3I& t = pool.triangle(ti);
-            face_vertex_counts.push_back(3);
-            face_vertex_indices.push_back(static_cast<int>(t[2]));
-            face_vertex_indices.push_back(static_cast<int>(t[1]));
-            face_vertex_indices.push_back(static_cast<int>(t[0]));
+    if (input.layout.size() > 1) {
+        size_t oversized = 0;
+        for (const auto& box : input.bounds)
+            if (wider(box)) ++oversized;
+        if (oversized > 0) {
+            std::cerr << "EnvelopeBuilder: " << oversized << " of "
+                      << input.shells.size() << " mesh shells are wider than"
+                      << " a brick and are voxelized whole; a brick's peak"
+                      << " memory includes their full SDFs\n";
         }
     }
+    return input;
+}
 
-    // Write to stage
+// Build and spill bricks [first, last), one at a time so only one brick's
+// grids are alive.
+bool spill_bricks(const EnvelopeConfig& config, const TileConfig& tiles,
+                  const TiledInput& input, size_t first, size_t last)
+{
+    std::error_code ec;
+    std::filesystem::create_directories(tiles.spill_dir, ec);
+
+    const size_t count = input.layout.size();
+    for (size_t k = first; k < last; ++k) {
+        uint64_t active_voxels = 0;
+        uint64_t sdf_bytes     = 0;
+        const SurfaceData surface = build_brick(config, input.layout,
+                                                input.geoms, input.shells,
+                                                input.bounds, k,
+                                                active_voxels, sdf_bytes);
+        if (!write_brick(brick_file(tiles.spill_dir, k), surface,
+                         active_voxels, sdf_bytes))
+            return false;
+        std::cerr << "EnvelopeBuilder: brick " << k + 1 << "/" << count << ": "
+                  << surface.face_vertex_counts.size() << " faces\n";
+    }
+    return true;
+}
+
+// Concatenate the spilled bricks into one surface, welding the vertices
+// bricks share on their seams.  VolumeToMesh places each vertex inside a
+// cell of eight voxels, from their values alone, and the overlap gives
+// neighbouring bricks the same closed SDF values around the face they
+// share, so a seam vertex comes out bit-identical from both.  Only vertices
+// in cells next to a face between two bricks are welded, matched on their
+// integer cell and exact position; vertices elsewhere are never merged,
+// however close.  Points no polygon uses are dropped.
+bool stitch_spilled_bricks(const EnvelopeConfig& config,
+                           const TileConfig& tiles, const TilePlan& plan,
+                           SurfaceData& out, EnvelopeStats* stats)
+{
+    struct Key {
+        int32_t  cell[3];
+        uint32_t bits[3];
+        bool operator==(const Key& o) const {
+            return std::memcmp(this, &o, sizeof(Key)) == 0;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            uint64_t h = hash_mix(uint64_t(uint32_t(k.cell[0])));
+            for (int a = 1; a < 3; ++a) h = hash_combine(h, uint32_t(k.cell[a]));
+            for (int a = 0; a < 3; ++a) h = hash_combine(h, k.bits[a]);
+            return size_t(h);
+        }
+    };
+
+    // Cell c along an axis spans voxels c and c + 1.  Bricks meet between
+    // voxels P - 1 and P, P = origin + m * brick_vox for 0 < m < count;
+    // the quads there use cells P - 2 to P.
+    auto seam_cell = [&](int c, int a) {
+        const int d = c + 1 - plan.origin[a];
+        if (d < 0) return false;
+        const int m = (d + plan.brick_vox / 2) / plan.brick_vox;  // nearest
+        return m > 0 && m < plan.counts[a]
+            && std::abs(d - m * plan.brick_vox) <= 1;
+    };
+
+    const double inv_voxel = 1.0 / config.voxel_size;
+    const size_t count = plan.brick_count();
+    std::unordered_map<Key, int, KeyHash> welded;
+    std::vector<GfVec3f> points;
+    std::vector<int>     counts;
+    std::vector<int>     indices;
+    uint64_t active_voxels = 0;
+    uint64_t max_bytes     = 0;
+
+    for (size_t k = 0; k < count; ++k) {
+        SurfaceData brick;
+        BrickHeader header;
+        if (!read_brick(brick_file(tiles.spill_dir, k), brick, header))
+            return false;
+        active_voxels += header.active_voxels;
+        max_bytes      = std::max(max_bytes, header.sdf_bytes);
+
+        std::vector<int> remap(brick.points.size(), -1);
+        counts.insert(counts.end(), brick.face_vertex_counts.begin(),
+                      brick.face_vertex_counts.end());
+        for (int index : brick.face_vertex_indices) {
+            int& to = remap[index];
+            if (to < 0) {
+                const GfVec3f& p = brick.points[index];
+                Key key;
+                bool seam = false;
+                for (int a = 0; a < 3; ++a) {
+                    key.cell[a] = static_cast<int32_t>(
+                        std::floor(double(p[a]) * inv_voxel));
+                    std::memcpy(&key.bits[a], &p[a], sizeof(float));
+                    seam = seam || seam_cell(key.cell[a], a);
+                }
+                if (seam) {
+                    auto [it, inserted] = welded.emplace(
+                        key, static_cast<int>(points.size()));
+                    if (inserted) points.push_back(p);
+                    to = it->second;
+                } else {
+                    to = static_cast<int>(points.size());
+                    points.push_back(p);
+                }
+            }
+            indices.push_back(to);
+        }
+    }
+
+    out.points.assign(points.begin(), points.end());
+    out.face_vertex_counts.assign(counts.begin(), counts.end());
+    out.face_vertex_indices.assign(indices.begin(), indices.end());
+    if (stats) {
+        stats->active_voxel_count  = active_voxels;
+        stats->sdf_bytes           = max_bytes;
+        stats->envelope_face_count = counts.size();
+    }
+    return true;
+}
+
+// Stitch the spilled bricks of plan and write them to stage as /Envelope.
+std::string write_stitched(UsdStageRefPtr stage, const EnvelopeConfig& config,
+                           const TileConfig& tiles, const TilePlan& plan,
+                           EnvelopeStats* stats)
+{
+    const std::string prim_path = "/Envelope";
+    SurfaceData surface;
+    if (!stitch_spilled_bricks(config, tiles, plan, surface, stats))
+        return {};
+
+    std::cerr << "EnvelopeBuilder: stitched " << plan.brick_count()
+              << " bricks into " << surface.face_vertex_counts.size()
+              << " faces\n";
+    if (stats) {
+        stats->mode        = VoxelizeMode::PerMesh;
+        stats->mesh_count  = plan.mesh_paths.size();
+        stats->face_count  = plan.face_count;
+        stats->brick_count = plan.brick_count();
+    }
+
+    ScopedPhase phase("usd_authoring");
     auto mesh = UsdGeomMesh::Define(stage, SdfPath(prim_path));
-    mesh.GetPointsAttr().Set(points);
-    mesh.GetFaceVertexCountsAttr().Set(face_vertex_counts);
-    mesh.GetFaceVertexIndicesAttr().Set(face_vertex_indices);
+    mesh.GetPointsAttr().Set(surface.points);
+    mesh.GetFaceVertexCountsAttr().Set(surface.face_vertex_counts);
+    mesh.GetFaceVertexIndicesAttr().Set(surface.face_vertex_indices);
     mesh.GetSubdivisionSchemeAttr().Set(UsdGeomTokens->none);
+    return prim_path;
+}
+
+} // namespace
+
+const char* to_string(ClosingMode mode) {
+    switch (mode) {
+    case ClosingMode::LevelSet: return "level-set";
+    case ClosingMode::Topology: return "topology";
+    }
+    return "unknown";
+}
+
+const char* to_string(VoxelizeMode mode) {
+    switch (mode) {
+    case VoxelizeMode::Auto:    return "auto";
+    case VoxelizeMode::PerMesh: return "per-mesh";
+    case VoxelizeMode::Soup:    return "soup";
+    }
+    return "unknown";
+}
+
+EnvelopeBuilder::EnvelopeBuilder(const EnvelopeConfig& config, SdfCache* cache,
+                                 MeshSdfStore* store)
+    : config_(config), cache_(cache), store_(store) {}
+
+std::string EnvelopeBuilder::build(
+    UsdStageRefPtr stage,
+    const std::vector<UsdGeomMesh>& meshes,
+    const std::string& sdf_path,
+    EnvelopeStats* stats) const
+{
+    if (meshes.empty()) return {};
+    return build(stage, GeometryCache(meshes), sdf_path, stats);
+}
+
+std::string EnvelopeBuilder::build(
+    UsdStageRefPtr stage,
+    const GeometryCache& geometry,
+    const std::string& sdf_path,
+    EnvelopeStats* stats) const
+{
+    if (geometry.empty()) return {};
 
+    openvdb::initialize();
+
+    const std::vector<UsdGeomMesh>&  meshes       = geometry.meshes();
+    const std::vector<GfMatrix4d>&   world_xforms = geometry.world_xforms();
+    const std::vector<MeshGeometry>& geoms        = geometry.geometry();
+
+    openvdb::FloatGrid::Ptr sdf;
+    uint64_t key = 0;
+    if (cache_) {
+        key = cache_key(config_, geoms);
+        sdf = cache_->load(key);
+    }
+    if (stats) stats->cache_hit = static_cast<bool>(sdf);
+
+    // On a cache hit the stored SDF is already closed; go straight to export
+    // and meshing.
+    if (!sdf) {
+        if (store_ && config_.coarse_factor <= 1) {
+            sdf = incremental_sdf(config_, meshes, geoms, *store_, stats);
+            if (!sdf) return {};
+        } else if (config_.coarse_factor > 1) {
+            EnvelopeConfig coarse_config = config_;
+            coarse_config.voxel_size *= config_.coarse_factor;
+            sdf = closed_sdf(coarse_config, geoms, world_xforms, stats);
+            if (!sdf) return {};
+            sdf = refine_sdf(config_, geoms, *sdf, stats);
+        } else {
+            sdf = closed_sdf(config_, geoms, world_xforms, stats);
+            if (!sdf) return {};
+        }
+        if (cache_) cache_->store(key, sdf);
+    }
+    return write_envelope(stage, config_, *sdf, sdf_path, stats);
+}
+
+std::string EnvelopeBuilder::build_streamed(
+    UsdStageRefPtr stage,
+    MeshStream& meshes,
+    const std::string& sdf_path,
+    EnvelopeStats* stats,
+    GfRange3d* bounds) const
+{
+    openvdb::initialize();
+
+    const float half_band = closing_half_band(config_);
+    const auto  xform     = openvdb::math::Transform::createLinearTransform(
+        config_.voxel_size);
+
+    // Each batch is read and voxelized in parallel and unioned pairwise into
+    // one grid, which is folded into the running union before the next batch
+    // starts; only one batch's grids are alive at a time.
+    openvdb::FloatGrid::Ptr sdf;
+    GfRange3d world_bounds;
+    size_t    total_faces = 0;
+    const size_t mesh_count = meshes.for_each_batch(
+        [&](const std::vector<UsdGeomMesh>& batch,
+            const std::vector<GfMatrix4d>& world_xforms) {
+            ScopedPhase phase("voxelization");
+            UFD_TRACE_SCOPE_ARG("batch", "meshes", batch.size());
+            std::vector<GfRange3d> mesh_bounds(batch.size());
+            std::vector<size_t>    mesh_faces(batch.size(), 0);
+            auto grid = voxelize_and_union([&](size_t i) {
+                UFD_TRACE_SCOPE_ARG("mesh_sdf", "mesh", i);
+                MeshGeometry geom;
+                {
+                    ScopedPhase phase("extraction");
+                    geom = read_mesh_geometry(batch[i], world_xforms[i]);
+                }
+                for (const auto& pt : geom.points)
+                    mesh_bounds[i].UnionWith(GfVec3d(pt[0], pt[1], pt[2]));
+                mesh_faces[i] = face_count(geom);
+                return voxelize_mesh(*xform, geom, half_band);
+            }, 0, batch.size());
+
+            for (size_t i = 0; i < batch.size(); ++i) {
+                world_bounds.UnionWith(mesh_bounds[i]);
+                total_faces += mesh_faces[i];
+            }
+            if (!sdf) {
+                sdf = grid;
+            } else {
+                union_into(*sdf, *grid);
+            }
+        });
+
+    std::cerr << "EnvelopeBuilder: streamed " << mesh_count << " meshes ("
+              << total_faces << " faces) in " << to_string(VoxelizeMode::PerMesh)
+              << " mode\n";
+    if (bounds) *bounds = world_bounds;
+    if (stats) {
+        stats->mode       = VoxelizeMode::PerMesh;
+        stats->mesh_count = mesh_count;
+        stats->face_count = total_faces;
+    }
+    if (!sdf || sdf->empty()) return {};
+    Metrics::global().record_grid("unioned", *sdf);
+
+    sdf = close_sdf(config_, sdf, half_band);
+    return write_envelope(stage, config_, *sdf, sdf_path, stats);
+}
+
+std::string EnvelopeBuilder::build_animated(
+    UsdStageRefPtr stage,
+    const std::vector<UsdGeomMesh>& meshes,
+    const std::vector<UsdTimeCode>& times,
+    std::vector<EnvelopeStats>* stats) const
+{
+    const std::string prim_path = "/Envelope";
+    if (meshes.empty() || times.empty()) return {};
+
+    openvdb::initialize();
+
+    const size_t nframes = times.size();
+    const size_t nmeshes = meshes.size();
+
+    // UsdGeomXformCache is not thread-safe and holds one time; resolve every
+    // frame's world transforms up front.
+    std::vector<std::vector<GfMatrix4d>> world_xforms(nframes);
+    for (size_t f = 0; f < nframes; ++f) {
+        UsdGeomXformCache xform_cache(times[f]);
+        world_xforms[f].reserve(nmeshes);
+        for (const auto& mesh : meshes) {
+            world_xforms[f].push_back(
+                xform_cache.GetLocalToWorldTransform(mesh.GetPrim()));
+        }
+    }
+
+    // Per mesh, find the distinct world-space samples: a part whose points
+    // and transform do not change is voxelized once for all frames.  Only
+    // hashes are kept here; a sample's geometry is read again from its first
+    // frame when its SDF is needed.  slot[i][f] numbers mesh i's samples.
+    std::vector<std::vector<size_t>> slot(nmeshes, std::vector<size_t>(nframes));
+    std::vector<std::vector<bool>>   first_use(nmeshes,
+                                               std::vector<bool>(nframes));
+    std::vector<std::vector<size_t>> sample_frame(nmeshes);  // first frame
+    std::vector<std::vector<size_t>> sample_faces(nmeshes);
+    tbb::parallel_for(size_t(0), nmeshes, [&](size_t i) {
+        std::unordered_map<uint64_t, size_t> seen;
+        for (size_t f = 0; f < nframes; ++f) {
+            const MeshGeometry geom = read_mesh_geometry(
+                meshes[i], world_xforms[f][i], times[f]);
+            auto [it, inserted] = seen.emplace(world_geometry_hash(geom),
+                                               sample_frame[i].size());
+            if (inserted) {
+                sample_frame[i].push_back(f);
+                sample_faces[i].push_back(face_count(geom));
+            }
+            slot[i][f]      = it->second;
+            first_use[i][f] = inserted;
+        }
+    });
+
+    size_t sample_count = 0;
+    for (size_t i = 0; i < nmeshes; ++i) sample_count += sample_frame[i].size();
+    std::cerr << "EnvelopeBuilder: " << nframes << " frames, voxelizing "
+              << sample_count << " of " << nframes * nmeshes
+              << " mesh samples\n";
+
+    // Frames whose every mesh uses the same samples are identical; build one
+    // and share it.
+    std::vector<size_t> rep(nframes);
+    std::vector<size_t> built;  // frames with rep[f] == f, in order
+    {
+        std::map<std::vector<size_t>, size_t> first_frame;
+        std::vector<size_t> slots(nmeshes);
+        for (size_t f = 0; f < nframes; ++f) {
+            for (size_t i = 0; i < nmeshes; ++i) slots[i] = slot[i][f];
+            rep[f] = first_frame.emplace(slots, f).first->second;
+            if (rep[f] == f) built.push_back(f);
+        }
+    }
+
+    // Index in built of the last frame using each sample, after which its
+    // SDF is released
+    std::vector<std::vector<size_t>> last_use(nmeshes);
+    for (size_t i = 0; i < nmeshes; ++i) {
+        last_use[i].assign(sample_frame[i].size(), 0);
+        for (size_t b = 0; b < built.size(); ++b)
+            last_use[i][slot[i][built[b]]] = b;
+    }
+
+    // Frames are built in batches of one per thread.  A batch voxelizes the
+    // samples its frames need that no earlier batch did, then unions,
+    // closes and meshes its frames in parallel; sample SDFs no later frame
+    // uses are dropped before the next batch, so the grids alive are those
+    // of one batch plus the samples still shared with later frames.
+    const float half_band = closing_half_band(config_);
+    auto xform = openvdb::math::Transform::createLinearTransform(
+        config_.voxel_size);
+    const size_t batch_frames = static_cast<size_t>(
+        std::max(1, tbb::this_task_arena::max_concurrency()));
+    std::vector<std::vector<openvdb::FloatGrid::Ptr>> sdfs(nmeshes);
+    for (size_t i = 0; i < nmeshes; ++i) sdfs[i].resize(sample_frame[i].size());
+
+    std::vector<SurfaceData> surfaces(nframes);
+    std::vector<EnvelopeStats> frame_stats(nframes);
+    for (size_t b0 = 0; b0 < built.size(); b0 += batch_frames) {
+        const size_t b1 = std::min(built.size(), b0 + batch_frames);
+
+        std::vector<std::pair<size_t, size_t>> samples;  // (mesh, slot)
+        for (size_t i = 0; i < nmeshes; ++i) {
+            for (size_t b = b0; b < b1; ++b) {
+                if (first_use[i][built[b]])
+                    samples.emplace_back(i, slot[i][built[b]]);
+            }
+        }
+        {
+            ScopedPhase phase("voxelization");
+            tbb::parallel_for(size_t(0), samples.size(), [&](size_t k) {
+                const auto [i, u] = samples[k];
+                UFD_TRACE_SCOPE_ARG("mesh_sdf", "mesh", i);
+                const size_t f = sample_frame[i][u];
+                sdfs[i][u] = voxelize_mesh(
+                    *xform,
+                    read_mesh_geometry(meshes[i], world_xforms[f][i], times[f]),
+                    half_band);
+            });
+        }
+
+        tbb::parallel_for(b0, b1, [&](size_t b) {
+            const size_t f = built[b];
+            UFD_TRACE_SCOPE_ARG("frame", "frame", f);
+            EnvelopeStats& fs = frame_stats[f];
+            fs.mode       = VoxelizeMode::PerMesh;
+            fs.mesh_count = nmeshes;
+
+            // csgUnion consumes its operands, and samples are shared by frames
+            openvdb::FloatGrid::Ptr sdf;
+            {
+                ScopedPhase phase("voxelization");
+                sdf = voxelize_and_union([&](size_t i) {
+                    return sdfs[i][slot[i][f]]->deepCopy();
+                }, 0, nmeshes);
+            }
+            if (sdf->empty()) return;
+            sdf = close_sdf(config_, sdf, half_band);
+            fs.active_voxel_count = sdf->activeVoxelCount();
+            fs.sdf_bytes          = sdf->memUsage();
+
+            double adaptivity = 0.0;
+            std::unique_ptr<openvdb::tools::VolumeToMesh> mesher;
+            {
+                ScopedPhase phase("meshing");
+                mesher      = mesh_envelope(config_, *sdf, adaptivity);
+                surfaces[f] = gather_mesh(*mesher);
+            }
+            fs.adaptivity          = adaptivity;
+            fs.envelope_face_count = polygon_count(*mesher);
+            if (stats) fs.max_deviation = max_deviation(*sdf, *mesher);
+        });
+
+        for (size_t i = 0; i < nmeshes; ++i) {
+            for (size_t u = 0; u < sdfs[i].size(); ++u) {
+                if (sdfs[i][u] && last_use[i][u] < b1) sdfs[i][u].reset();
+            }
+        }
+    }
+
+    // An empty frame is still authored, so it does not hold the previous
+    // frame's envelope, but it is most likely a scene or time range error
+    std::vector<size_t> empty_frames;
+    for (size_t f = 0; f < nframes; ++f) {
+        if (surfaces[rep[f]].points.empty()) empty_frames.push_back(f);
+    }
+    if (!empty_frames.empty()) {
+        std::cerr << "EnvelopeBuilder: warning: " << empty_frames.size()
+                  << " of " << nframes << " frames have an empty envelope"
+                  << " (time codes";
+        for (size_t k = 0; k < std::min<size_t>(empty_frames.size(), 8); ++k)
+            std::cerr << " " << times[empty_frames[k]].GetValue();
+        if (empty_frames.size() > 8) std::cerr << " ...";
+        std::cerr << ")\n";
+    }
+
+    // USD authoring is single-threaded
+    ScopedPhase phase("usd_authoring");
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath(prim_path));
+    mesh.GetSubdivisionSchemeAttr().Set(UsdGeomTokens->none);
+    for (size_t f = 0; f < nframes; ++f) {
+        const SurfaceData& surface = surfaces[rep[f]];
+        mesh.GetPointsAttr().Set(surface.points, times[f]);
+        mesh.GetFaceVertexCountsAttr().Set(surface.face_vertex_counts, times[f]);
+        mesh.GetFaceVertexIndicesAttr().Set(surface.face_vertex_indices, times[f]);
+    }
+
+    if (stats) {
+        stats->resize(nframes);
+        for (size_t f = 0; f < nframes; ++f) {
+            EnvelopeStats& out = (*stats)[f];
+            out = frame_stats[rep[f]];
+            out.face_count = 0;
+            out.voxelized_count = 0;
+            for (size_t i = 0; i < nmeshes; ++i) {
+                out.face_count += sample_faces[i][slot[i][f]];
+                if (first_use[i][f]) ++out.voxelized_count;
+            }
+            out.reused_mesh_count = nmeshes - out.voxelized_count;
+        }
+    }
     return prim_path;
 }
 
+std::string EnvelopeBuilder::build_tiled(
+    UsdStageRefPtr stage,
+    const GeometryCache& geometry,
+    const TileConfig& tiles,
+    EnvelopeStats* stats) const
+{
+    if (geometry.empty()) return {};
+    openvdb::initialize();
+
+    const TilePlan plan = plan_tiles(geometry, tiles);
+    if (!build_bricks(geometry, plan, tiles)) return {};
+    return write_stitched(stage, config_, tiles, plan, stats);
+}
+
+TilePlan EnvelopeBuilder::plan_tiles(
+    const GeometryCache& geometry,
+    const TileConfig& tiles) const
+{
+    const std::vector<openvdb::CoordBBox> bounds =
+        mesh_index_bounds(config_, geometry);
+    const BrickLayout layout = brick_layout(config_, tiles, bounds);
+
+    TilePlan plan;
+    plan.voxel_size = config_.voxel_size;
+    for (int a = 0; a < 3; ++a) {
+        plan.origin[a] = layout.origin[a];
+        plan.counts[a] = layout.counts[a];
+    }
+    plan.brick_vox  = layout.brick_vox;
+    plan.overlap    = layout.overlap;
+    plan.face_count = geometry.face_count();
+
+    // A mesh reaches brick b when its band overlaps b's padded box
+    const int band = static_cast<int>(std::ceil(closing_half_band(config_)))
+                   + layout.overlap;
+    plan.mesh_paths.reserve(geometry.size());
+    plan.mesh_bricks.reserve(geometry.size());
+    for (size_t i = 0; i < geometry.size(); ++i) {
+        plan.mesh_paths.push_back(geometry.meshes()[i].GetPath().GetString());
+        std::array<int, 6> range = {0, 0, 0, -1, -1, -1};
+        if (!bounds[i].empty() && layout.brick_vox > 0) {
+            openvdb::CoordBBox reach = bounds[i];
+            reach.expand(band);
+            for (int a = 0; a < 3; ++a) {
+                auto brick = [&](int v) {
+                    const int d = v - layout.origin[a];
+                    const int b = d >= 0 ? d / layout.brick_vox
+                                         : -((-d + layout.brick_vox - 1)
+                                             / layout.brick_vox);
+                    return std::clamp(b, 0, layout.counts[a] - 1);
+                };
+                range[a]     = brick(reach.min()[a]);
+                range[a + 3] = brick(reach.max()[a]);
+            }
+        }
+        plan.mesh_bricks.push_back(range);
+    }
+    return plan;
+}
+
+bool EnvelopeBuilder::build_bricks(
+    const GeometryCache& geometry,
+    const TilePlan& plan,
+    const TileConfig& tiles,
+    size_t worker,
+    size_t workers) const
+{
+    if (workers == 0 || worker >= workers) return false;
+    if (plan.voxel_size != config_.voxel_size) {
+        std::cerr << "EnvelopeBuilder: tile plan was laid out for voxel size "
+                  << plan.voxel_size << ", not " << config_.voxel_size << "\n";
+        return false;
+    }
+    openvdb::initialize();
+
+    const TiledInput input = tiled_input(config_, layout_of(plan), geometry);
+    const auto [first, last] = plan.worker_bricks(worker, workers);
+    std::cerr << "EnvelopeBuilder: bricks " << first << " to " << last
+              << " of " << input.layout.size() << ", "
+              << input.layout.brick_vox << " voxels, overlap "
+              << input.layout.overlap << ", from " << geometry.size()
+              << " meshes\n";
+    return spill_bricks(config_, tiles, input, first, last);
+}
+
+std::string EnvelopeBuilder::stitch_bricks(
+    UsdStageRefPtr stage,
+    const TilePlan& plan,
+    const TileConfig& tiles,
+    EnvelopeStats* stats) const
+{
+    if (plan.brick_count() == 0) return {};
+    return write_stitched(stage, config_, tiles, plan, stats);
+}
+
+size_t TilePlan::brick_count() const {
+    return size_t(std::max(0, counts[0])) * size_t(std::max(0, counts[1]))
+         * size_t(std::max(0, counts[2]));
+}
+
+std::pair<size_t, size_t> TilePlan::worker_bricks(size_t worker,
+                                                  size_t workers) const
+{
+    const size_t count = brick_count();
+    if (workers == 0 || worker >= workers) return {0, 0};
+    return {count * worker / workers, count * (worker + 1) / workers};
+}
+
+std::vector<size_t> TilePlan::worker_meshes(size_t worker, size_t workers) const {
+    const auto [first, last] = worker_bricks(worker, workers);
+    const size_t nx = size_t(std::max(0, counts[0]));
+    const size_t ny = size_t(std::max(0, counts[1]));
+
+    // Brick k is x + nx * (y + ny * z); a mesh reaching bricks x0..x1 in row
+    // (y, z) needs worker if that run of indices meets [first, last)
+    std::vector<size_t> meshes;
+    for (size_t i = 0; i < mesh_bricks.size(); ++i) {
+        const auto& r = mesh_bricks[i];
+        if (r[0] > r[3] || r[1] > r[4] || r[2] > r[5]) continue;
+        bool needed = false;
+        for (int z = r[2]; z <= r[5] && !needed; ++z) {
+            for (int y = r[1]; y <= r[4] && !needed; ++y) {
+                const size_t row = nx * (size_t(y) + ny * size_t(z));
+                needed = row + size_t(r[0]) < last && row + size_t(r[3]) >= first;
+            }
+        }
+        if (needed) meshes.push_back(i);
+    }
+    return meshes;
+}
+
+bool TilePlan::write(const std::string& path) const {
+    std::error_code ec;
+    const auto dir = std::filesystem::path(path).parent_path();
+    if (!dir.empty()) std::filesystem::create_directories(dir, ec);
+
+    std::ofstream out(path, std::ios::trunc);
+    out.precision(std::numeric_limits<double>::max_digits10);
+    out << "ufd_tile_plan 1\n"
+        << voxel_size << "\n"
+        << origin[0] << " " << origin[1] << " " << origin[2] << "\n"
+        << counts[0] << " " << counts[1] << " " << counts[2] << "\n"
+        << brick_vox << " " << overlap << " " << face_count << "\n"
+        << mesh_paths.size() << "\n";
+    for (size_t i = 0; i < mesh_paths.size(); ++i) {
+        for (int v : mesh_bricks[i]) out << v << " ";
+        out << mesh_paths[i] << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+bool TilePlan::read(const std::string& path) {
+    std::ifstream in(path);
+    std::string magic;
+    int version = 0;
+    size_t meshes = 0;
+    in >> magic >> version >> voxel_size
+       >> origin[0] >> origin[1] >> origin[2]
+       >> counts[0] >> counts[1] >> counts[2]
+       >> brick_vox >> overlap >> face_count >> meshes;
+    if (!in || magic != "ufd_tile_plan" || version != 1) return false;
+
+    mesh_paths.assign(meshes, {});
+    mesh_bricks.assign(meshes, {});
+    for (size_t i = 0; i < meshes; ++i) {
+        for (int& v : mesh_bricks[i]) in >> v;
+        in >> mesh_paths[i];
+    }
+    return static_cast<bool>(in);
+}
+
 } // namespace ufd
@@ -0,0 +1,224 @@
+#include <ufd/EnvelopeEstimator.h>
+
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ufd {
+
+namespace {
+
+constexpr double k_pi = 3.14159265358979323846;
+
+// FloatTree node footprints as counted by memUsage(): values and masks for
+// leaves, one 8-byte table slot per child plus masks for internal nodes.
+constexpr double k_leaf_voxels = 512.0;                // 8^3
+constexpr double k_leaf_bytes  = 512 * 4 + 64 + 32;
+constexpr double k_lower_dim   = 128.0;                // voxels per edge
+constexpr double k_lower_bytes = 4096 * 8 + 2 * 512;
+constexpr double k_upper_dim   = 4096.0;
+constexpr double k_upper_bytes = 32768 * 8 + 2 * 4096;
+
+// Band the builder keeps when no closing band is needed.
+constexpr double k_min_half_band = 3.0;
+
+// Envelope quads per voxel face of surface: 1 on axis-aligned surfaces, 1.5
+// averaged over all orientations (the mean L1 norm of a unit normal).  1.2
+// leans toward the axis-aligned, blocky parts that dominate assemblies.
+constexpr double k_faces_per_voxel_area = 1.2;
+
+// meshToVolume keeps a closest-primitive Int32 grid beside the distances, and
+// levelSetRebuild holds its input and output; either doubles the band.
+constexpr double k_peak_factor = 2.0;
+
+struct Band {
+    double voxels = 0.0;
+    double bytes  = 0.0;
+};
+
+// Number of cells of `dim` voxels per edge that box overlaps.
+double cells(const GfRange3d& box, double vox, double dim) {
+    const double edge = vox * dim;
+    double n = 1.0;
+    for (int a = 0; a < 3; ++a) {
+        n *= std::floor(box.GetMax()[a] / edge)
+           - std::floor(box.GetMin()[a] / edge) + 1.0;
+    }
+    return n;
+}
+
+// Narrow band of half_band voxels either side of a closed surface with the
+// given area inside bounds.
+Band narrow_band(double area, const GfRange3d& bounds, double vox,
+                 double half_band)
+{
+    const GfVec3d size = bounds.GetSize();
+    const double  r    = half_band * vox;
+
+    const double inside = std::min(area * r, size[0] * size[1] * size[2]);
+    // Steiner formula for the box: volume within r outside it
+    const double outside = area * r
+                         + k_pi * (size[0] + size[1] + size[2]) * r * r
+                         + 4.0 / 3.0 * k_pi * r * r * r;
+
+    Band band;
+    band.voxels = (inside + outside) / (vox * vox * vox);
+
+    // A shell `width` voxels thick straddles leaf boundaries, touching about
+    // 1 + 8 / width leaves per leaf of active voxels.
+    const double    width  = 2.0 * half_band;
+    const double    leaves = band.voxels / k_leaf_voxels * (1.0 + 8.0 / width);
+    const GfRange3d padded(bounds.GetMin() - GfVec3d(r),
+                           bounds.GetMax() + GfVec3d(r));
+    const double lower = std::min(cells(padded, vox, k_lower_dim), leaves);
+    const double upper = std::min(cells(padded, vox, k_upper_dim), lower);
+    band.bytes = leaves * k_leaf_bytes + lower * k_lower_bytes
+               + upper * k_upper_bytes;
+    return band;
+}
+
+// Heap bytes of one mesh's world-space buffers.
+uint64_t geometry_bytes(const MeshGeometry& geom) {
+    return geom.points.capacity()    * sizeof(openvdb::Vec3s)
+         + geom.triangles.capacity() * sizeof(openvdb::Vec3I)
+         + geom.quads.capacity()     * sizeof(openvdb::Vec4I);
+}
+
+} // namespace
+
+EnvelopeEstimator::EnvelopeEstimator(double surface_area,
+                                     const GfRange3d& bounds)
+    : surface_area_(surface_area), bounds_(bounds) {}
+
+EnvelopeEstimator::EnvelopeEstimator(double surface_area,
+                                     const GfRange3d& bounds,
+                                     const GeometryCache& geometry)
+    : surface_area_(surface_area), bounds_(bounds),
+      mesh_count_(geometry.size()), face_count_(geometry.face_count())
+{
+    for (const auto& geom : geometry.geometry())
+        geometry_bytes_ += sizeof(MeshGeometry) + geometry_bytes(geom);
+}
+
+EnvelopeEstimate EnvelopeEstimator::estimate(const EnvelopeConfig& config) const
+{
+    EnvelopeEstimate est;
+    est.voxel_size = config.voxel_size;
+    if (bounds_.IsEmpty() || config.voxel_size <= 0.0) return est;
+
+    const double  vox  = config.voxel_size;
+    const GfVec3d size = bounds_.GetSize();
+    const double  box_area = 2.0 * (size[0] * size[1] + size[1] * size[2]
+                                  + size[2] * size[0]);
+    const double  envelope_area = std::min(surface_area_, box_area);
+
+    // Soup mode as choose_mode picks it, counting duplicates as distinct
+    const size_t meshes = std::max<size_t>(1, mesh_count_);
+    const bool soup = config.mode == VoxelizeMode::Soup
+        || (config.mode == VoxelizeMode::Auto && mesh_count_ > 0
+            && meshes >= std::max<size_t>(2, config.soup_min_meshes)
+            && face_count_ <= config.soup_max_mean_faces * meshes);
+
+    double final_band = k_min_half_band;
+    double peak_grids = 0.0;  // grids alone
+    double peak       = 0.0;  // grids, input buffers and soup copy
+    if (config.coarse_factor > 1) {
+        // Coarse pass as a single-level build, then the fine soup, the
+        // resampled shell and the rebuilt result at the minimal band.
+        EnvelopeConfig coarse_config = config;
+        coarse_config.voxel_size    *= config.coarse_factor;
+        coarse_config.coarse_factor  = 1;
+        const EnvelopeEstimate coarse = estimate(coarse_config);
+
+        const Band fine = narrow_band(envelope_area, bounds_, vox, final_band);
+        peak_grids = std::max(double(coarse.peak_grid_bytes),
+                              coarse.grid_bytes + 3.0 * fine.bytes);
+        // The fine pass merges the geometry near the coarse surface
+        peak = std::max(double(coarse.peak_bytes),
+                        coarse.grid_bytes + 3.0 * fine.bytes
+                        + 2.0 * geometry_bytes_);
+    } else {
+        const double close_vox = config.hole_threshold / vox;
+        const double half_band = config.closing == ClosingMode::LevelSet
+                               ? close_vox + k_min_half_band
+                               : k_min_half_band;
+        if (config.closing == ClosingMode::LevelSet && close_vox > 0.0)
+            final_band = half_band;
+
+        // Every input surface, hidden ones included, is voxelized first.  A
+        // soup or a single mesh is one meshToVolume call; otherwise the
+        // union so far sits beside the per-mesh grids in flight, one per
+        // worker thread when parallel, each about a mesh's share of the band.
+        const Band voxelized = narrow_band(surface_area_, bounds_, vox, half_band);
+        double voxelizing = k_peak_factor * voxelized.bytes;
+        if (!soup && meshes > 1) {
+            const size_t in_flight = config.parallel
+                ? std::min<size_t>(meshes, static_cast<size_t>(std::max(
+                      1, tbb::this_task_arena::max_concurrency())))
+                : 1;
+            voxelizing = voxelized.bytes
+                       + k_peak_factor * voxelized.bytes * in_flight / meshes;
+        }
+        // Without closing the voxelized union is meshed as it is
+        const Band closed  = narrow_band(envelope_area, bounds_, vox, final_band);
+        const double closing = close_vox > 0.0
+            ? k_peak_factor * std::max(voxelized.bytes, closed.bytes)
+            : voxelized.bytes;
+
+        peak_grids = std::max(voxelizing, closing);
+        peak = geometry_bytes_
+             + std::max(voxelizing + (soup ? geometry_bytes_ : 0.0), closing);
+    }
+
+    const Band closed = narrow_band(envelope_area, bounds_, vox, final_band);
+    est.active_voxels   = static_cast<uint64_t>(closed.voxels);
+    est.grid_bytes      = static_cast<uint64_t>(closed.bytes);
+    est.peak_grid_bytes = static_cast<uint64_t>(std::max(peak_grids, closed.bytes));
+    est.geometry_bytes  = geometry_bytes_;
+    est.peak_bytes      = static_cast<uint64_t>(std::max(
+        peak, double(geometry_bytes_) + closed.bytes));
+
+    // Dense export covers the active bounding box: bounds plus the band
+    uint64_t dense_voxels = 1;
+    for (int a = 0; a < 3; ++a) {
+        dense_voxels *= static_cast<uint64_t>(
+            std::ceil(size[a] / vox) + 2.0 * std::ceil(final_band) + 1.0);
+    }
+    est.dense_export_bytes = 32 + dense_voxels * sizeof(float);
+
+    est.face_count = static_cast<uint64_t>(
+        k_faces_per_voxel_area * envelope_area / (vox * vox));
+    if (config.target_face_count > 0)
+        est.face_count = std::min<uint64_t>(est.face_count,
+                                            config.target_face_count);
+    return est;
+}
+
+double EnvelopeEstimator::fit_voxel_size(const EnvelopeConfig& config,
+                                         uint64_t budget_bytes) const
+{
+    const GfVec3d size = bounds_.GetSize();
+    const double  longest = bounds_.IsEmpty()
+                          ? 1.0
+                          : std::max({size[0], size[1], size[2]});
+
+    EnvelopeConfig trial = config;
+    const auto fits = [&](double vox) {
+        trial.voxel_size = vox;
+        return estimate(trial).peak_bytes <= budget_bytes;
+    };
+
+    // Peak memory falls monotonically with voxel size; bisect in log space
+    double coarse = longest;
+    double fine   = longest / 1048576.0;
+    if (!fits(coarse)) return coarse;
+    for (int step = 0; step < 48; ++step) {
+        const double mid = std::sqrt(coarse * fine);
+        if (fits(mid)) coarse = mid;
+        else           fine   = mid;
+    }
+    return coarse;
+}
+
+} // namespace ufd
@@ -0,0 +1,98 @@
+#include <ufd/GeometryCache.h>
+#include <ufd/Hash.h>
+#include <ufd/Metrics.h>
+#include <ufd/Trace.h>
+#include <ufd/TransformKernel.h>
+
+#include <pxr/usd/usdGeom/xformCache.h>
+
+#include <tbb/parallel_for.h>
+
+namespace ufd {
+
+MeshGeometry read_mesh_geometry(const UsdGeomMesh& mesh,
+                                const GfMatrix4d& world_xform,
+                                UsdTimeCode time)
+{
+    VtVec3fArray usd_pts;
+    mesh.GetPointsAttr().Get(&usd_pts, time);
+
+    VtIntArray face_counts;
+    VtIntArray face_indices;
+    mesh.GetFaceVertexCountsAttr().Get(&face_counts, time);
+    mesh.GetFaceVertexIndicesAttr().Get(&face_indices, time);
+
+    MeshGeometry geom;
+    geom.content_hash = hash_array(face_indices,
+                        hash_array(face_counts,
+                        hash_array(usd_pts)));
+
+    // Convert USD points to world-space OpenVDB Vec3s
+    static_assert(sizeof(openvdb::Vec3s) == sizeof(GfVec3f),
+                  "points are transformed as packed float triples");
+    geom.points.resize(usd_pts.size());
+    transform_points(world_xform, reinterpret_cast<const float*>(usd_pts.cdata()),
+                     reinterpret_cast<float*>(geom.points.data()),
+                     usd_pts.size());
+
+    // Fan-triangulate faces; keep quads as quads
+    int cursor = 0;
+    for (int count : face_counts) {
+        if (count == 3) {
+            geom.triangles.emplace_back(
+                static_cast<uint32_t>(face_indices[cursor]),
+                static_cast<uint32_t>(face_indices[cursor + 1]),
+                static_cast<uint32_t>(face_indices[cursor + 2]));
+        } else if (count == 4) {
+            geom.quads.emplace_back(
+                static_cast<uint32_t>(face_indices[cursor]),
+                static_cast<uint32_t>(face_indices[cursor + 1]),
+                static_cast<uint32_t>(face_indices[cursor + 2]),
+                static_cast<uint32_t>(face_indices[cursor + 3]));
+        } else {
+            // Fan-triangulate n-gons (n > 4)
+            for (int i = 1; i < count - 1; ++i) {
+                geom.triangles.emplace_back(
+                    static_cast<uint32_t>(face_indices[cursor]),
+                    static_cast<uint32_t>(face_indices[cursor + i]),
+                    static_cast<uint32_t>(face_indices[cursor + i + 1]));
+            }
+        }
+        cursor += count;
+    }
+
+    return geom;
+}
+
+size_t face_count(const MeshGeometry& geom) {
+    return geom.triangles.size() + geom.quads.size();
+}
+
+GeometryCache::GeometryCache(const std::vector<UsdGeomMesh>& meshes,
+                             UsdTimeCode time)
+    : meshes_(meshes)
+{
+    ScopedPhase phase("extraction");
+    // UsdGeomXformCache is not thread-safe; resolve world transforms up front
+    // so the parallel reads below only touch attributes.
+    UsdGeomXformCache xform_cache(time);
+    world_xforms_.reserve(meshes_.size());
+    for (const auto& mesh : meshes_) {
+        world_xforms_.push_back(
+            xform_cache.GetLocalToWorldTransform(mesh.GetPrim()));
+    }
+
+    geometry_.resize(meshes_.size());
+    tbb::parallel_for(size_t(0), meshes_.size(), [&](size_t i) {
+        UFD_TRACE_SCOPE_ARG("read_mesh", "mesh", i);
+        geometry_[i] = read_mesh_geometry(meshes_[i], world_xforms_[i], time);
+    });
+}
+
+size_t GeometryCache::face_count() const {
+    size_t faces = 0;
+    for (const auto& geom : geometry_) faces += ufd::face_count(geom);
+    return faces;
+}
+
+} // namespace ufd
@@ -0,0 +1,70 @@
+#include <ufd/MeshGather.h>
+#include <ufd/Trace.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+#include <vector>
+
+namespace ufd {
+
+SurfaceData gather_mesh(const openvdb::tools::VolumeToMesh& mesher,
+                        bool flip_winding)
+{
+    UFD_TRACE_SCOPE("gather_mesh");
+    const size_t npools = mesher.polygonPoolListSize();
+    const auto&  pools  = mesher.polygonPoolList();
+
+    // Exclusive prefix sums of faces and face-vertex indices per pool
+    std::vector<size_t> face_offset(npools + 1, 0);
+    std::vector<size_t> index_offset(npools + 1, 0);
+    for (size_t pi = 0; pi < npools; ++pi) {
+        const auto& pool = pools[pi];
+        face_offset[pi + 1]  = face_offset[pi]
+                             + pool.numQuads() + pool.numTriangles();
+        index_offset[pi + 1] = index_offset[pi]
+                             + 4 * pool.numQuads() + 3 * pool.numTriangles();
+    }
+
+    const size_t npts = mesher.pointListSize();
+    SurfaceData surface;
+    surface.points.resize(npts);
+    surface.face_vertex_counts.resize(face_offset.back());
+    surface.face_vertex_indices.resize(index_offset.back());
+
+    // Take the mutable pointers once, outside the parallel loops; each
+    // non-const VtArray access would otherwise re-check for sharing.
+    GfVec3f* points  = surface.points.data();
+    int*     counts  = surface.face_vertex_counts.data();
+    int*     indices = surface.face_vertex_indices.data();
+
+    const auto& vdb_pts = mesher.pointList();
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, npts),
+        [&](const tbb::blocked_range<size_t>& r) {
+            for (size_t i = r.begin(); i < r.end(); ++i)
+                points[i] = GfVec3f(vdb_pts[i][0], vdb_pts[i][1], vdb_pts[i][2]);
+        });
+
+    tbb::parallel_for(size_t(0), npools, [&](size_t pi) {
+        const auto& pool  = pools[pi];
+        int*        count = counts + face_offset[pi];
+        int*        index = indices + index_offset[pi];
+
+        for (size_t qi = 0; qi < pool.numQuads(); ++qi) {
+            const openvdb::Vec4I& q = pool.quad(qi);
+            *count++ = 4;
+            for (int c = 0; c < 4; ++c)
+                *index++ = static_cast<int>(q[flip_winding ? 3 - c : c]);
+        }
+        for (size_t ti = 0; ti < pool.numTriangles(); ++ti) {
+            const openvdb::Vec3I& t = pool.triangle(ti);
+            *count++ = 3;
+            for (int c = 0; c < 3; ++c)
+                *index++ = static_cast<int>(t[flip_winding ? 2 - c : c]);
+        }
+    });
+
+    return surface;
+}
+
+} // namespace ufd
@@ -0,0 +1,193 @@
+#include <ufd/MeshSdfStore.h>
+#include <ufd/Hash.h>
+#include <ufd/ProcessStats.h>
+
+#include <openvdb/io/File.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace ufd {
+
+namespace {
+
+const char* const k_mesh_grid    = "sdf";
+const char* const k_closed_grid  = "closed";
+const char* const k_key_meta     = "ufd_key";
+const char* const k_path_meta    = "ufd_path";
+const char* const k_last_grid    = "last_build.vdb";
+const char* const k_last_meshes  = "last_build.txt";
+
+// Write grid under name to path, via a temporary file renamed into place so
+// readers in other processes never see a partial file.
+bool write_grid(const std::string& path, const openvdb::FloatGrid::Ptr& grid,
+                const std::string& name, uint64_t key,
+                const std::string& prim_path = {})
+{
+    const std::string tmp = unique_temp_path(path);
+
+    std::error_code ec;
+    try {
+        // Shares the tree; only the name and metadata differ
+        openvdb::GridBase::Ptr copy = grid->copyGrid();
+        copy->setName(name);
+        copy->insertMeta(k_key_meta,
+                         openvdb::Int64Metadata(static_cast<int64_t>(key)));
+        if (!prim_path.empty())
+            copy->insertMeta(k_path_meta, openvdb::StringMetadata(prim_path));
+        openvdb::io::File file(tmp);
+        file.write(openvdb::GridCPtrVec{copy});
+        file.close();
+        fs::rename(tmp, path);
+    } catch (const std::exception& e) {
+        std::cerr << "MeshSdfStore: failed to write " << path << ": "
+                  << e.what() << "\n";
+        fs::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+// Read grid name from path with its key metadata; nullptr if unreadable.
+openvdb::FloatGrid::Ptr read_grid(const std::string& path,
+                                  const std::string& name, uint64_t& key,
+                                  std::string* prim_path = nullptr)
+{
+    std::error_code ec;
+    if (!fs::exists(path, ec)) return nullptr;
+    try {
+        openvdb::io::File file(path);
+        file.open();
+        auto grid = openvdb::gridPtrCast<openvdb::FloatGrid>(file.readGrid(name));
+        file.close();
+        if (!grid) return nullptr;
+        key = static_cast<uint64_t>(grid->metaValue<int64_t>(k_key_meta));
+        if (prim_path) *prim_path = grid->metaValue<std::string>(k_path_meta);
+        return grid;
+    } catch (const std::exception& e) {
+        std::cerr << "MeshSdfStore: dropping unreadable entry " << path << ": "
+                  << e.what() << "\n";
+        fs::remove(path, ec);
+        return nullptr;
+    }
+}
+
+} // namespace
+
+MeshSdfStore::MeshSdfStore(const std::string& directory)
+    : directory_(directory) {
+    if (directory_.empty()) return;
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+}
+
+std::string MeshSdfStore::file_for(const std::string& path) const {
+    char name[40];
+    std::snprintf(name, sizeof(name), "mesh_%016llx.vdb",
+                  static_cast<unsigned long long>(
+                      hash_bytes(path.data(), path.size())));
+    return (fs::path(directory_) / name).string();
+}
+
+openvdb::FloatGrid::Ptr MeshSdfStore::find(const std::string& path,
+                                           uint64_t key)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(path);
+        if (it != entries_.end()) {
+            return it->second.key == key ? it->second.sdf : nullptr;
+        }
+    }
+    if (directory_.empty()) return nullptr;
+
+    uint64_t    stored_key = 0;
+    std::string stored_path;
+    auto sdf = read_grid(file_for(path), k_mesh_grid, stored_key, &stored_path);
+    if (!sdf || stored_path != path) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.emplace(path, Entry{stored_key, sdf});
+    return stored_key == key ? sdf : nullptr;
+}
+
+void MeshSdfStore::put(const std::string& path, uint64_t key,
+                       openvdb::FloatGrid::Ptr sdf)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[path] = Entry{key, sdf};
+    }
+    if (!directory_.empty()) write_grid(file_for(path), sdf, k_mesh_grid, key, path);
+}
+
+void MeshSdfStore::erase(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.erase(path);
+    }
+    if (directory_.empty()) return;
+    std::error_code ec;
+    fs::remove(file_for(path), ec);
+}
+
+MeshSdfStore::Build MeshSdfStore::read_last_build() const {
+    Build build;
+    const fs::path dir(directory_);
+    build.closed = read_grid((dir / k_last_grid).string(), k_closed_grid,
+                             build.settings_key);
+    if (!build.closed) return {};
+
+    std::ifstream in(dir / k_last_meshes);
+    std::string key_hex, path;
+    while (in >> key_hex >> path) {
+        build.mesh_keys[path] = std::stoull(key_hex, nullptr, 16);
+    }
+    return build;
+}
+
+MeshSdfStore::Build MeshSdfStore::last_build() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!last_loaded_ && !directory_.empty()) last_ = read_last_build();
+    last_loaded_ = true;
+    return last_;
+}
+
+void MeshSdfStore::set_last_build(const Build& build) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_        = build;
+        last_loaded_ = true;
+    }
+    if (directory_.empty()) return;
+
+    // Mesh list first: a crash in between leaves a list without its grid,
+    // which reads back as no previous build.  A build without a closed SDF
+    // only drops the old grid, so a later process rebuilds in full.
+    const fs::path dir(directory_);
+    std::error_code ec;
+    fs::remove(dir / k_last_grid, ec);
+    if (!build.closed) return;
+    {
+        std::ofstream out(dir / k_last_meshes, std::ios::trunc);
+        char key_hex[20];
+        for (const auto& [path, key] : build.mesh_keys) {
+            std::snprintf(key_hex, sizeof(key_hex), "%016llx",
+                          static_cast<unsigned long long>(key));
+            out << key_hex << ' ' << path << '\n';
+        }
+    }
+    write_grid((dir / k_last_grid).string(), build.closed, k_closed_grid,
+               build.settings_key);
+}
+
+size_t MeshSdfStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+} // namespace ufd
@@ -0,0 +1,217 @@
+#include <ufd/Metrics.h>
+#include <ufd/ProcessStats.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace ufd {
+
+namespace {
+
+// s as a JSON string literal.
+std::string quoted(const std::string& s) {
+    std::string out = "\"";
+    for (const char c : s) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out += escaped;
+            } else {
+                out += c;
+            }
+        }
+    }
+    return out + "\"";
+}
+
+// value as a JSON number, exact enough to compare runs.
+std::string number(double value) {
+    std::ostringstream out;
+    out.precision(9);
+    out << value;
+    return out.str();
+}
+
+} // namespace
+
+Metrics& Metrics::global() {
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::set_enabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Metrics::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    phases_.clear();
+    grids_.clear();
+    values_.clear();
+}
+
+Metrics::Phase& Metrics::phase(const char* name) {
+    auto it = std::find_if(phases_.begin(), phases_.end(), [&](const Phase& p) {
+        return p.metrics.name == name;
+    });
+    if (it != phases_.end()) return *it;
+    phases_.emplace_back();
+    phases_.back().metrics.name = name;
+    return phases_.back();
+}
+
+void Metrics::begin_phase(const char* name) {
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    Phase& p = phase(name);
+    ++p.metrics.count;
+    if (p.open++ > 0) return;
+    p.wall_start = Clock::now();
+    p.cpu_start  = process_cpu_seconds();
+    p.rss_start  = current_rss_bytes();
+}
+
+void Metrics::end_phase(const char* name, double seconds) {
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    Phase& p = phase(name);
+    p.metrics.busy_seconds += seconds;
+    p.metrics.max_seconds   = std::max(p.metrics.max_seconds, seconds);
+    // An entry begun before a reset closes nothing
+    if (p.open == 0 || --p.open > 0) return;
+    p.metrics.wall_seconds +=
+        std::chrono::duration<double>(Clock::now() - p.wall_start).count();
+    p.metrics.cpu_seconds   += process_cpu_seconds() - p.cpu_start;
+    // Current RSS, not ru_maxrss: the process peak never falls, so every
+    // phase closing after the largest one would report the same figure
+    p.metrics.rss_begin_bytes = p.rss_start;
+    p.metrics.rss_end_bytes   = current_rss_bytes();
+}
+
+void Metrics::record_grid(const char* name, const openvdb::GridBase& grid) {
+    if (!enabled()) return;
+    GridMetrics g;
+    g.name          = name;
+    g.active_voxels = grid.activeVoxelCount();
+    g.leaf_count    = grid.baseTree().leafCount();
+    g.mem_bytes     = grid.memUsage();
+    g.voxel_size    = grid.voxelSize()[0];
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    grids_.push_back(std::move(g));
+}
+
+void Metrics::set_value(const std::string& name, double value) {
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [key, json] : values_) {
+        if (key == name) {
+            json = number(value);
+            return;
+        }
+    }
+    values_.emplace_back(name, number(value));
+}
+
+void Metrics::set_value(const std::string& name, const std::string& value) {
+    if (!enabled()) return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [key, json] : values_) {
+        if (key == name) {
+            json = quoted(value);
+            return;
+        }
+    }
+    values_.emplace_back(name, quoted(value));
+}
+
+std::vector<PhaseMetrics> Metrics::phases() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PhaseMetrics> out;
+    out.reserve(phases_.size());
+    for (const auto& p : phases_) out.push_back(p.metrics);
+    return out;
+}
+
+std::vector<GridMetrics> Metrics::grids() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return grids_;
+}
+
+std::string Metrics::to_json() const {
+    const std::vector<PhaseMetrics> phase_list = phases();
+    const std::vector<GridMetrics>  grid_list  = grids();
+    std::vector<std::pair<std::string, std::string>> value_list;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        value_list = values_;
+    }
+
+    std::ostringstream out;
+    out << "{\n  \"peak_rss_bytes\": " << peak_rss_bytes()
+        << ",\n  \"phases\": [";
+    for (size_t i = 0; i < phase_list.size(); ++i) {
+        const PhaseMetrics& p = phase_list[i];
+        out << (i ? "," : "") << "\n    {\"name\": " << quoted(p.name)
+            << ", \"count\": " << p.count
+            << ", \"wall_seconds\": " << number(p.wall_seconds)
+            << ", \"cpu_seconds\": " << number(p.cpu_seconds)
+            << ", \"busy_seconds\": " << number(p.busy_seconds)
+            << ", \"max_seconds\": " << number(p.max_seconds)
+            << ", \"rss_begin_bytes\": " << p.rss_begin_bytes
+            << ", \"rss_end_bytes\": " << p.rss_end_bytes << "}";
+    }
+    out << (phase_list.empty() ? "" : "\n  ") << "],\n  \"grids\": [";
+    for (size_t i = 0; i < grid_list.size(); ++i) {
+        const GridMetrics& g = grid_list[i];
+        out << (i ? "," : "") << "\n    {\"name\": " << quoted(g.name)
+            << ", \"active_voxels\": " << g.active_voxels
+            << ", \"leaf_count\": " << g.leaf_count
+            << ", \"mem_bytes\": " << g.mem_bytes
+            << ", \"voxel_size\": " << number(g.voxel_size) << "}";
+    }
+    out << (grid_list.empty() ? "" : "\n  ") << "],\n  \"values\": {";
+    for (size_t i = 0; i < value_list.size(); ++i) {
+        out << (i ? "," : "") << "\n    " << quoted(value_list[i].first)
+            << ": " << value_list[i].second;
+    }
+    out << (value_list.empty() ? "" : "\n  ") << "}\n}\n";
+    return out.str();
+}
+
+bool Metrics::write_json(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    out << to_json();
+    return static_cast<bool>(out);
+}
+
+ScopedPhase::ScopedPhase(const char* name)
+    : ScopedPhase(Metrics::global(), name) {}
+
+ScopedPhase::ScopedPhase(Metrics& metrics, const char* name)
+    :
+#ifdef UFD_TRACING
+      span_(name),
+#endif
+      metrics_(metrics.enabled() ? &metrics : nullptr), name_(name) {
+    if (!metrics_) return;
+    metrics_->begin_phase(name_);
+    start_ = std::chrono::steady_clock::now();
+}
+
+ScopedPhase::~ScopedPhase() {
+    if (!metrics_) return;
+    metrics_->end_phase(
+        name_, std::chrono::duration<double>(
+                   std::chrono::steady_clock::now() - start_).count());
+}
+
+} // namespace ufd
@@ -0,0 +1,64 @@
+#include <ufd/ProcessStats.h>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdio>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+namespace ufd {
+
+uint64_t current_rss_bytes() {
+#if defined(__linux__)
+    // Second field of statm: resident pages
+    unsigned long long size = 0, resident = 0;
+    std::FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    const int fields = std::fscanf(statm, "%llu %llu", &size, &resident);
+    std::fclose(statm);
+    if (fields != 2) return 0;
+    return static_cast<uint64_t>(resident)
+         * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+        return 0;
+    return info.resident_size;
+#else
+    return 0;
+#endif
+}
+
+uint64_t peak_rss_bytes() {
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss);          // bytes
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;   // kilobytes
+#endif
+}
+
+double process_cpu_seconds() {
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    const auto seconds = [](const timeval& t) {
+        return static_cast<double>(t.tv_sec)
+             + 1e-6 * static_cast<double>(t.tv_usec);
+    };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+std::string unique_temp_path(const std::string& path) {
+    static std::atomic<uint64_t> counter{0};
+    return path + ".tmp." + std::to_string(static_cast<long>(getpid())) + "."
+         + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+} // namespace ufd
@@ -0,0 +1,139 @@
+#include <ufd/SdfCache.h>
+#include <ufd/ProcessStats.h>
+
+#include <openvdb/io/File.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace ufd {
+
+namespace {
+
+const char* const k_grid_name = "sdf";
+
+} // namespace
+
+SdfCache::SdfCache(const std::string& directory, uint64_t max_bytes)
+    : directory_(directory), max_bytes_(max_bytes) {
+    std::error_code ec;
+    fs::create_directories(directory_, ec);
+}
+
+std::string SdfCache::path_for(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.vdb",
+                  static_cast<unsigned long long>(key));
+    return (fs::path(directory_) / name).string();
+}
+
+openvdb::FloatGrid::Ptr SdfCache::load(uint64_t key) {
+    const std::string path = path_for(key);
+    openvdb::FloatGrid::Ptr grid;
+
+    std::error_code ec;
+    if (fs::exists(path, ec)) {
+        try {
+            openvdb::io::File file(path);
+            file.open();
+            grid = openvdb::gridPtrCast<openvdb::FloatGrid>(
+                file.readGrid(k_grid_name));
+            file.close();
+        } catch (const std::exception& e) {
+            std::cerr << "SdfCache: dropping unreadable entry " << path
+                      << ": " << e.what() << "\n";
+            fs::remove(path, ec);
+            grid.reset();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!grid) {
+        ++stats_.misses;
+        return nullptr;
+    }
+
+    // Mark as recently used for LRU eviction
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    ++stats_.hits;
+    stats_.bytes_saved += grid->memUsage();
+    return grid;
+}
+
+void SdfCache::store(uint64_t key, openvdb::FloatGrid::Ptr grid) {
+    const std::string path = path_for(key);
+
+    // Write under a unique temporary name and rename into place, so readers
+    // in other processes never see a partial file.
+    const std::string tmp = unique_temp_path(path);
+
+    std::error_code ec;
+    try {
+        // Shares the tree; only the name differs from the caller's grid
+        openvdb::GridBase::Ptr copy = grid->copyGrid();
+        copy->setName(k_grid_name);
+        openvdb::io::File file(tmp);
+        file.write(openvdb::GridCPtrVec{copy});
+        file.close();
+        fs::rename(tmp, path);
+    } catch (const std::exception& e) {
+        std::cerr << "SdfCache: failed to store " << path << ": "
+                  << e.what() << "\n";
+        fs::remove(tmp, ec);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.bytes_written += fs::file_size(path, ec);
+    }
+    evict();
+}
+
+SdfCacheStats SdfCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void SdfCache::evict() {
+    if (max_bytes_ == 0) return;
+
+    struct Entry {
+        fs::path            path;
+        uint64_t            size;
+        fs::file_time_type  used;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    std::error_code ec;
+    for (const auto& de : fs::directory_iterator(directory_, ec)) {
+        if (de.path().extension() != ".vdb") continue;
+        Entry e{de.path(), de.file_size(ec), de.last_write_time(ec)};
+        total += e.size;
+        entries.push_back(std::move(e));
+    }
+    if (total <= max_bytes_) return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.used < b.used; });
+
+    size_t evicted = 0;
+    for (const auto& e : entries) {
+        if (total <= max_bytes_) break;
+        if (fs::remove(e.path, ec)) {
+            total -= e.size;
+            ++evicted;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.evictions += evicted;
+}
+
+} // namespace ufd
@@ -0,0 +1,320 @@
+#include <ufd/SdfExport.h>
+
+#include <openvdb/tools/Dense.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace ufd {
+
+namespace {
+
+constexpr char     k_sparse_magic[8] = {'U', 'F', 'D', 'S', 'S', 'D', 'F', '\0'};
+constexpr uint32_t k_sparse_version  = 1;
+constexpr uint32_t k_block_dim       = 8;
+
+#pragma pack(push, 1)
+struct SparseHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t block_dim;
+    float    voxel_size;
+    float    background;
+    int32_t  bbox_min[3];
+    int32_t  bbox_max[3];
+    uint64_t leaf_count;
+    uint64_t tile_count;
+};
+
+struct SparseLeafRecord {
+    int32_t origin[3];
+    float   values[k_block_dim * k_block_dim * k_block_dim];
+};
+
+struct SparseTileRecord {
+    int32_t origin[3];
+    int32_t dim;
+    float   value;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(SparseHeader) == 64, "sparse SDF header layout");
+static_assert(sizeof(SparseLeafRecord) == 2060, "sparse SDF leaf layout");
+static_assert(sizeof(SparseTileRecord) == 20, "sparse SDF tile layout");
+
+std::ofstream open_output(const std::string& path) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("cannot open " + path);
+    return out;
+}
+
+void write_bytes(std::ofstream& out, const void* p, size_t n) {
+    out.write(reinterpret_cast<const char*>(p),
+              static_cast<std::streamsize>(n));
+}
+
+// Number of x-planes copied out of the tree per write; one leaf deep, so each
+// slab touches every leaf at most once.
+constexpr int32_t k_slab_planes = 8;
+
+// Stream the dense C-order (x slowest) contents of bbox to out, one x-slab at
+// a time.  Each slab is filled straight from the tree into a reused buffer,
+// so memory stays bounded by one slab regardless of the box size.
+void write_slabs(const openvdb::FloatGrid& grid,
+                 const openvdb::CoordBBox& bbox,
+                 std::ofstream& out)
+{
+    if (bbox.empty()) return;
+
+    const size_t plane = static_cast<size_t>(bbox.dim().y()) * bbox.dim().z();
+    std::vector<float> buffer(plane * k_slab_planes);
+
+    for (int32_t x0 = bbox.min().x(); x0 <= bbox.max().x(); x0 += k_slab_planes) {
+        const int32_t x1 = std::min(x0 + k_slab_planes - 1, bbox.max().x());
+        const openvdb::CoordBBox slab(
+            openvdb::Coord(x0, bbox.min().y(), bbox.min().z()),
+            openvdb::Coord(x1, bbox.max().y(), bbox.max().z()));
+
+        openvdb::tools::Dense<float, openvdb::tools::LayoutZYX> dense(
+            slab, buffer.data());
+        openvdb::tools::copyToDense(grid, dense);
+        write_bytes(out, buffer.data(),
+                    static_cast<size_t>(x1 - x0 + 1) * plane * sizeof(float));
+    }
+}
+
+void write_dense(const openvdb::FloatGrid& grid, const std::string& path) {
+    const openvdb::CoordBBox bbox = grid.evalActiveVoxelBoundingBox();
+
+    const float   vox = static_cast<float>(grid.voxelSize()[0]);
+    const int32_t nx  = bbox.dim().x();
+    const int32_t ny  = bbox.dim().y();
+    const int32_t nz  = bbox.dim().z();
+    const float   ox  = static_cast<float>(bbox.min().x()) * vox;
+    const float   oy  = static_cast<float>(bbox.min().y()) * vox;
+    const float   oz  = static_cast<float>(bbox.min().z()) * vox;
+    const float   bg  = grid.background();
+
+    auto out = open_output(path);
+    write_bytes(out, &nx,  4);
+    write_bytes(out, &ny,  4);
+    write_bytes(out, &nz,  4);
+    write_bytes(out, &ox,  4);
+    write_bytes(out, &oy,  4);
+    write_bytes(out, &oz,  4);
+    write_bytes(out, &vox, 4);
+    write_bytes(out, &bg,  4);
+    write_slabs(grid, bbox, out);
+    if (!out) throw std::runtime_error("write failed: " + path);
+}
+
+// NPY v1.0 preamble for a little-endian float32 C-order array of the given
+// shape, padded so the data starts on a 64-byte boundary.
+std::string npy_header(int32_t nx, int32_t ny, int32_t nz) {
+    std::ostringstream dict;
+    dict << "{'descr': '<f4', 'fortran_order': False, 'shape': ("
+         << nx << ", " << ny << ", " << nz << "), }";
+    std::string text = dict.str();
+
+    const size_t preamble = 10;  // magic (6) + version (2) + header length (2)
+    const size_t unpadded = preamble + text.size() + 1;
+    text.append((64 - unpadded % 64) % 64, ' ');
+    text.push_back('\n');
+
+    const auto len = static_cast<uint16_t>(text.size());
+    std::string header("\x93NUMPY\x01\x00", 8);
+    header.push_back(static_cast<char>(len & 0xff));
+    header.push_back(static_cast<char>(len >> 8));
+    return header + text;
+}
+
+void write_npy(const openvdb::FloatGrid& grid, const std::string& path) {
+    const openvdb::CoordBBox bbox = grid.evalActiveVoxelBoundingBox();
+    const double vox = grid.voxelSize()[0];
+
+    auto out = open_output(path);
+    const std::string header =
+        npy_header(bbox.dim().x(), bbox.dim().y(), bbox.dim().z());
+    write_bytes(out, header.data(), header.size());
+    write_slabs(grid, bbox, out);
+    if (!out) throw std::runtime_error("write failed: " + path);
+
+    // .npy has no room for spatial metadata; it goes in a JSON sidecar.
+    std::ofstream meta(path + ".json");
+    if (!meta) throw std::runtime_error("cannot open " + path + ".json");
+    meta.precision(9);
+    meta << "{\n"
+         << "  \"shape\": [" << bbox.dim().x() << ", " << bbox.dim().y()
+         << ", " << bbox.dim().z() << "],\n"
+         << "  \"index_min\": [" << bbox.min().x() << ", " << bbox.min().y()
+         << ", " << bbox.min().z() << "],\n"
+         << "  \"origin\": [" << bbox.min().x() * vox << ", "
+         << bbox.min().y() * vox << ", " << bbox.min().z() * vox << "],\n"
+         << "  \"voxel_size\": " << vox << ",\n"
+         << "  \"background\": " << grid.background() << "\n"
+         << "}\n";
+}
+
+void write_sparse(const openvdb::FloatGrid& grid, const std::string& path) {
+    const auto& tree = grid.tree();
+    const openvdb::CoordBBox bbox = grid.evalActiveVoxelBoundingBox();
+    const float bg = grid.background();
+
+    // Tiles equal to the background are implied; the rest (the interior of a
+    // level set, mostly) are stored explicitly.
+    std::vector<SparseTileRecord> tiles;
+    auto it = tree.cbeginValueAll();
+    it.setMaxDepth(openvdb::FloatTree::ValueAllCIter::LEAF_DEPTH - 1);
+    for (; it; ++it) {
+        if (*it == bg) continue;
+        const openvdb::CoordBBox tile = it.getBoundingBox();
+        tiles.push_back({{tile.min().x(), tile.min().y(), tile.min().z()},
+                         tile.dim().x(), *it});
+    }
+
+    SparseHeader header{};
+    std::memcpy(header.magic, k_sparse_magic, sizeof(header.magic));
+    header.version    = k_sparse_version;
+    header.block_dim  = k_block_dim;
+    header.voxel_size = static_cast<float>(grid.voxelSize()[0]);
+    header.background = bg;
+    for (int a = 0; a < 3; ++a) {
+        header.bbox_min[a] = bbox.min()[a];
+        header.bbox_max[a] = bbox.max()[a];
+    }
+    header.leaf_count = tree.leafCount();
+    header.tile_count = tiles.size();
+
+    auto out = open_output(path);
+    write_bytes(out, &header, sizeof(header));
+
+    // Leaf buffers are already [x][y][z] with z fastest, so each block is
+    // written straight from the tree.
+    for (auto leaf = tree.cbeginLeaf(); leaf; ++leaf) {
+        const openvdb::Coord origin = leaf->origin();
+        const int32_t o[3] = {origin.x(), origin.y(), origin.z()};
+        write_bytes(out, o, sizeof(o));
+        write_bytes(out, leaf->buffer().data(),
+                    openvdb::FloatTree::LeafNodeType::SIZE * sizeof(float));
+    }
+    write_bytes(out, tiles.data(), tiles.size() * sizeof(SparseTileRecord));
+    if (!out) throw std::runtime_error("write failed: " + path);
+}
+
+// Copy the part of a cube [origin, origin + dim) that overlaps [min, max]
+// into a dense C-order box, using value(x, y, z) for cube-local coordinates.
+template <typename ValueFn>
+void paste_cube(const std::array<int32_t, 3>& origin, int32_t dim,
+                const std::array<int32_t, 3>& min,
+                const std::array<int32_t, 3>& max,
+                std::vector<float>& dense, const ValueFn& value)
+{
+    std::array<int32_t, 3> lo, hi;
+    for (int a = 0; a < 3; ++a) {
+        lo[a] = std::max(origin[a], min[a]);
+        hi[a] = std::min(origin[a] + dim - 1, max[a]);
+        if (lo[a] > hi[a]) return;
+    }
+
+    const size_t ny = static_cast<size_t>(max[1] - min[1] + 1);
+    const size_t nz = static_cast<size_t>(max[2] - min[2] + 1);
+    for (int32_t x = lo[0]; x <= hi[0]; ++x)
+    for (int32_t y = lo[1]; y <= hi[1]; ++y)
+    for (int32_t z = lo[2]; z <= hi[2]; ++z) {
+        const size_t i = (static_cast<size_t>(x - min[0]) * ny
+                          + static_cast<size_t>(y - min[1])) * nz
+                          + static_cast<size_t>(z - min[2]);
+        dense[i] = value(x - origin[0], y - origin[1], z - origin[2]);
+    }
+}
+
+} // namespace
+
+const char* to_string(SdfFormat format) {
+    switch (format) {
+    case SdfFormat::Dense:  return "dense";
+    case SdfFormat::Sparse: return "sparse";
+    case SdfFormat::Npy:    return "npy";
+    }
+    return "unknown";
+}
+
+void write_sdf(const openvdb::FloatGrid& grid,
+               const std::string& path,
+               SdfFormat format)
+{
+    switch (format) {
+    case SdfFormat::Dense:  write_dense(grid, path);  break;
+    case SdfFormat::Sparse: write_sparse(grid, path); break;
+    case SdfFormat::Npy:    write_npy(grid, path);    break;
+    }
+}
+
+std::vector<float> SparseSdf::dense(const std::array<int32_t, 3>& min,
+                                    const std::array<int32_t, 3>& max) const
+{
+    size_t count = 1;
+    for (int a = 0; a < 3; ++a) {
+        if (max[a] < min[a]) return {};
+        count *= static_cast<size_t>(max[a] - min[a] + 1);
+    }
+    std::vector<float> out(count, background);
+
+    for (const auto& tile : tiles) {
+        paste_cube(tile.origin, tile.dim, min, max, out,
+                   [&](int32_t, int32_t, int32_t) { return tile.value; });
+    }
+    const int32_t n = static_cast<int32_t>(k_block_dim);
+    for (const auto& leaf : leaves) {
+        paste_cube(leaf.origin, n, min, max, out,
+                   [&](int32_t x, int32_t y, int32_t z) {
+                       return leaf.values[(x * n + y) * n + z];
+                   });
+    }
+    return out;
+}
+
+SparseSdf read_sparse_sdf(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot open " + path);
+
+    const auto read_bytes = [&in, &path](void* p, size_t n) {
+        in.read(reinterpret_cast<char*>(p), static_cast<std::streamsize>(n));
+        if (!in) throw std::runtime_error("truncated sparse SDF: " + path);
+    };
+
+    SparseHeader header;
+    read_bytes(&header, sizeof(header));
+    if (std::memcmp(header.magic, k_sparse_magic, sizeof(header.magic)) != 0 ||
+        header.version != k_sparse_version || header.block_dim != k_block_dim) {
+        throw std::runtime_error("not a sparse SDF file: " + path);
+    }
+
+    SparseSdf sdf;
+    sdf.voxel_size = header.voxel_size;
+    sdf.background = header.background;
+    for (int a = 0; a < 3; ++a) {
+        sdf.bbox_min[a] = header.bbox_min[a];
+        sdf.bbox_max[a] = header.bbox_max[a];
+    }
+
+    sdf.leaves.resize(header.leaf_count);
+    for (auto& leaf : sdf.leaves) {
+        read_bytes(leaf.origin.data(), sizeof(int32_t) * 3);
+        read_bytes(leaf.values.data(), sizeof(float) * leaf.values.size());
+    }
+
+    std::vector<SparseTileRecord> records(header.tile_count);
+    read_bytes(records.data(), records.size() * sizeof(SparseTileRecord));
+    sdf.tiles.reserve(records.size());
+    for (const auto& r : records) {
+        sdf.tiles.push_back({{r.origin[0], r.origin[1], r.origin[2]},
+                             r.dim, r.value});
+    }
+    return sdf;
+}
+
+} // namespace ufd
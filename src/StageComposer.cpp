@@ -1,4 +1,6 @@
 #include <ufd/StageComposer.h>
+#include <ufd/Metrics.h>
+#include <ufd/Trace.h>
 
 #include <pxr/usd/sdf/layer.h>
 #include <pxr/usd/sdf/path.h>
@@ -88,7 +90,15 @@ bool StageComposer::write() const {
     for (const auto& [type, stage] : components_) {
         if (type != ComponentType::InputGeometry &&
             type != ComponentType::CfdResults) {
-            apply_material(type, stage, prim_path_for(type));
+            {
+                ScopedPhase phase("usd_authoring");
+                UFD_TRACE_SCOPE_ARG("apply_material", "component",
+                                    static_cast<int>(type));
+                apply_material(type, stage, prim_path_for(type));
+            }
+            ScopedPhase phase("layer_save");
+            UFD_TRACE_SCOPE_ARG("save_layer", "component",
+                                static_cast<int>(type));
             stage->GetRootLayer()->Save();
         }
     }
@@ -103,11 +113,26 @@ bool StageComposer::write() const {
     auto root_layer = SdfLayer::CreateNew(root_path_);
     if (!root_layer) return false;
 
+    // Playback range of the root covers every animated component
+    bool   animated = false;
+    double start = 0.0, end = 0.0;
     for (const auto& [type, stage] : sorted) {
         root_layer->GetSubLayerPaths().push_back(
             stage->GetRootLayer()->GetIdentifier());
+        if (!stage->HasAuthoredTimeCodeRange()) continue;
+        start = animated ? std::min(start, stage->GetStartTimeCode())
+                         : stage->GetStartTimeCode();
+        end   = animated ? std::max(end, stage->GetEndTimeCode())
+                         : stage->GetEndTimeCode();
+        animated = true;
+    }
+    if (animated) {
+        root_layer->SetStartTimeCode(start);
+        root_layer->SetEndTimeCode(end);
     }
 
+    ScopedPhase phase("layer_save");
+    UFD_TRACE_SCOPE("save_root_layer");
     return root_layer->Save();
 }
 
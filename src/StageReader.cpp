@@ -1,26 +1,337 @@
 #include <ufd/StageReader.h>
+#include <ufd/Metrics.h>
+#include <ufd/ProcessStats.h>
+#include <ufd/Trace.h>
 
+#include <pxr/usd/kind/registry.h>
+#include <pxr/usd/usd/modelAPI.h>
 #include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/stageCache.h>
+#include <pxr/usd/usd/stageCacheContext.h>
+#include <pxr/usd/usd/stagePopulationMask.h>
+#include <pxr/usd/usdGeom/imageable.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdGeom/xformCache.h>
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <optional>
+
+#include <fnmatch.h>
 
 namespace ufd {
 
-bool StageReader::open(const std::string& usd_file_path) {
-    stage_ = UsdStage::Open(usd_file_path);
-    return static_cast<bool>(stage_);
+namespace {
+
+// Children at or above this count are traversed as parallel tasks; smaller
+// sibling sets stay on the current thread.
+constexpr size_t k_parallel_children = 8;
+
+// Default MeshStream batch: enough meshes per worker thread to even out
+// meshes of different sizes.
+constexpr size_t k_stream_batch_per_thread = 4;
+
+// Stages opened with use_stage_cache, for the life of the process.
+UsdStageCache& stage_cache() {
+    static UsdStageCache cache;
+    return cache;
+}
+
+// Load the payloads under roots.  A root below a payload that is not loaded
+// yet is not on the stage; its nearest ancestor that is gets loaded instead,
+// which the population mask still limits to the root's subtree.
+void load_roots(const UsdStageRefPtr& stage, const std::vector<SdfPath>& roots) {
+    SdfPathSet load;
+    for (SdfPath path : roots) {
+        while (!path.IsAbsoluteRootPath() && !stage->GetPrimAtPath(path))
+            path = path.GetParentPath();
+        load.insert(path);
+    }
+    stage->LoadAndUnload(load, SdfPathSet());
+}
+
+// What a prim passes down to its subtree.
+struct VisitState {
+    UsdGeomImageable::PurposeInfo purpose;
+    bool included  = false;  // an include pattern matched here or above
+    bool kind_kept = false;  // a wanted kind was found here or above
+};
+
+bool matches_any(const std::vector<std::string>& patterns,
+                 const std::string& path) {
+    return std::any_of(patterns.begin(), patterns.end(),
+                       [&](const std::string& p) {
+                           return fnmatch(p.c_str(), path.c_str(), 0) == 0;
+                       });
+}
+
+bool is_any_kind(const TfToken& kind, const std::vector<TfToken>& kinds) {
+    return std::any_of(kinds.begin(), kinds.end(), [&](const TfToken& k) {
+        return KindRegistry::IsA(kind, k);
+    });
+}
+
+class MeshCollector {
+public:
+    explicit MeshCollector(const TraversalFilter& filter) : filter_(filter) {}
+
+    // Append the kept meshes at and below prim to out, in stage order.
+    void visit(const UsdPrim& prim, VisitState state,
+               std::vector<UsdGeomMesh>& out) const {
+        if (!enter(prim, state)) return;
+        if (prim.IsA<UsdGeomMesh>() && keep(state)) out.emplace_back(prim);
+        visit_children(prim, state, out);
+    }
+
+    // The same for every child of prim.
+    void visit_children(const UsdPrim& prim, const VisitState& state,
+                        std::vector<UsdGeomMesh>& out) const {
+        const auto children = prim.GetFilteredChildren(
+            UsdTraverseInstanceProxies());
+        std::vector<UsdPrim> list(children.begin(), children.end());
+        if (list.size() < k_parallel_children) {
+            for (const auto& child : list) visit(child, state, out);
+            return;
+        }
+
+        // One output per child, concatenated afterwards to keep stage order
+        std::vector<std::vector<UsdGeomMesh>> found(list.size());
+        tbb::parallel_for(size_t(0), list.size(), [&](size_t i) {
+            UFD_TRACE_SCOPE_ARG("visit_subtree", "child", i);
+            visit(list[i], state, found[i]);
+        });
+        for (auto& meshes : found) {
+            out.insert(out.end(), std::make_move_iterator(meshes.begin()),
+                       std::make_move_iterator(meshes.end()));
+        }
+    }
+
+    // Update state for prim; false if its subtree is pruned.
+    bool enter(const UsdPrim& prim, VisitState& state) const {
+        if (prim.IsA<UsdGeomImageable>()) {
+            const UsdGeomImageable imageable(prim);
+            state.purpose = imageable.ComputePurposeInfo(state.purpose);
+            // An inheritable purpose holds for every descendant
+            if (state.purpose.isInheritable && !purpose_kept(state)) return false;
+
+            if (filter_.visible_only) {
+                TfToken visibility;
+                imageable.GetVisibilityAttr().Get(&visibility);
+                if (visibility == UsdGeomTokens->invisible) return false;
+            }
+        }
+
+        if (!filter_.include.empty() || !filter_.exclude.empty()) {
+            const std::string& path = prim.GetPath().GetString();
+            if (matches_any(filter_.exclude, path)) return false;
+            if (!state.included && matches_any(filter_.include, path))
+                state.included = true;
+        }
+
+        if (!filter_.kinds.empty() || !filter_.exclude_kinds.empty()) {
+            TfToken kind;
+            if (UsdModelAPI(prim).GetKind(&kind) && !kind.IsEmpty()) {
+                if (is_any_kind(kind, filter_.exclude_kinds)) return false;
+                if (!state.kind_kept && is_any_kind(kind, filter_.kinds))
+                    state.kind_kept = true;
+            }
+        }
+        return true;
+    }
+
+    // True if a mesh reached with state is kept.
+    bool keep(const VisitState& state) const {
+        return purpose_kept(state)
+            && (filter_.include.empty() || state.included)
+            && (filter_.kinds.empty() || state.kind_kept);
+    }
+
+    // State above the pseudo-root's children.
+    VisitState root_state() const {
+        VisitState root;
+        root.included  = filter_.include.empty();
+        root.kind_kept = filter_.kinds.empty();
+        return root;
+    }
+
+private:
+    bool purpose_kept(const VisitState& state) const {
+        if (filter_.purposes.empty()) return true;
+        const TfToken& purpose = state.purpose.purpose.IsEmpty()
+                               ? UsdGeomTokens->default_
+                               : state.purpose.purpose;
+        return std::find(filter_.purposes.begin(), filter_.purposes.end(),
+                         purpose) != filter_.purposes.end();
+    }
+
+    const TraversalFilter& filter_;
+};
+
+} // namespace
+
+bool StageReader::open(const std::string& usd_file_path,
+                       const StageOpenOptions& options,
+                       StageOpenStats* stats) {
+    ScopedPhase phase("stage_open");
+    const auto t0 = std::chrono::steady_clock::now();
+    const uint64_t rss0 = current_rss_bytes();
+
+    // Masked stages load payloads per root below, not all at once
+    const auto load = options.load_payloads && options.roots.empty()
+                    ? UsdStage::LoadAll : UsdStage::LoadNone;
+
+    std::optional<UsdStageCacheContext> context;
+    size_t cached = 0;
+    if (options.use_stage_cache) {
+        cached = stage_cache().Size();
+        context.emplace(stage_cache());
+    }
+
+    if (options.roots.empty()) {
+        stage_ = UsdStage::Open(usd_file_path, load);
+    } else {
+        UsdStagePopulationMask mask;
+        for (const auto& root : options.roots) mask.Add(root);
+        stage_ = UsdStage::OpenMasked(usd_file_path, mask, load);
+    }
+    if (!stage_) return false;
+
+    // A cached stage keeps the load state of whichever open created it, so
+    // the load set is normalized on every cached open rather than only on
+    // an inferred hit.  The hit is inferred from the cache not growing,
+    // which concurrent opens can blur; it only feeds the stats.
+    const bool cache_hit = options.use_stage_cache
+                        && stage_cache().Size() == cached;
+    if (!options.load_payloads) {
+        if (options.use_stage_cache)
+            stage_->Unload(SdfPath::AbsoluteRootPath());
+    } else if (!options.roots.empty()) {
+        load_roots(stage_, options.roots);
+    } else if (options.use_stage_cache) {
+        stage_->Load();
+    }
+
+    if (stats) {
+        stats->seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - t0).count();
+        stats->rss_bytes = static_cast<int64_t>(current_rss_bytes())
+                         - static_cast<int64_t>(rss0);
+        stats->cache_hit = cache_hit;
+    }
+    return true;
 }
 
-std::vector<UsdGeomMesh> StageReader::collect_meshes() const {
+std::vector<UsdGeomMesh> StageReader::collect_meshes(
+    const TraversalFilter& filter) const {
     std::vector<UsdGeomMesh> meshes;
     if (!stage_) {
         return meshes;
     }
+    ScopedPhase phase("traversal");
+
+    // Instance proxies are included so meshes under instanceable prims are
+    // collected like any other geometry.
+    const MeshCollector collector(filter);
+    collector.visit_children(stage_->GetPseudoRoot(), collector.root_state(),
+                             meshes);
+    return meshes;
+}
+
+// The serial walk: a UsdPrimRange whose subtrees are pruned as the filter
+// fails, with the state of the current prim's ancestors on a stack.
+struct MeshStream::Impl {
+    struct Entry {
+        SdfPath    path;
+        VisitState state;
+    };
 
-    for (const auto& prim : stage_->Traverse()) {
-        if (prim.IsA<UsdGeomMesh>()) {
-            meshes.emplace_back(prim);
+    Impl(const UsdStageRefPtr& stage, const TraversalFilter& f)
+        : filter(f), collector(filter),
+          range(UsdPrimRange::Stage(stage, UsdTraverseInstanceProxies())),
+          it(range.begin()) {
+        stack.push_back({SdfPath::AbsoluteRootPath(), collector.root_state()});
+    }
+
+    TraversalFilter         filter;  // collector refers to this copy
+    MeshCollector           collector;
+    UsdPrimRange            range;
+    UsdPrimRange::iterator  it;
+    std::vector<Entry>      stack;
+};
+
+MeshStream::MeshStream(UsdStageRefPtr stage, const TraversalFilter& filter) {
+    if (stage) impl_ = std::make_unique<Impl>(stage, filter);
+}
+
+MeshStream::~MeshStream() = default;
+
+bool MeshStream::next(UsdGeomMesh& mesh) {
+    if (!impl_) return false;
+    Impl& s = *impl_;
+    for (; s.it != s.range.end(); ++s.it) {
+        const UsdPrim prim = *s.it;
+        // Leave the subtrees the walk has moved past
+        const SdfPath parent = prim.GetPath().GetParentPath();
+        while (s.stack.back().path != parent) s.stack.pop_back();
+
+        VisitState state = s.stack.back().state;
+        if (!s.collector.enter(prim, state)) {
+            s.it.PruneChildren();
+            continue;
+        }
+        s.stack.push_back({prim.GetPath(), state});
+        if (prim.IsA<UsdGeomMesh>() && s.collector.keep(state)) {
+            mesh = UsdGeomMesh(prim);
+            ++s.it;
+            ++count_;
+            return true;
         }
     }
-    return meshes;
+    return false;
+}
+
+size_t MeshStream::for_each_batch(const BatchFn& fn, UsdTimeCode time,
+                                  size_t batch_size) {
+    if (batch_size == 0) {
+        batch_size = k_stream_batch_per_thread
+                   * static_cast<size_t>(tbb::this_task_arena::max_concurrency());
+    }
+
+    struct Batch {
+        std::vector<UsdGeomMesh> meshes;
+        std::vector<GfMatrix4d>  world_xforms;
+    };
+
+    // Only the pulling side touches the xform cache, one batch at a time
+    UsdGeomXformCache xform_cache(time);
+    const auto pull = [&](Batch& batch) {
+        ScopedPhase phase("traversal");
+        batch.meshes.clear();
+        batch.world_xforms.clear();
+        UsdGeomMesh mesh;
+        while (batch.meshes.size() < batch_size && next(mesh)) {
+            batch.world_xforms.push_back(
+                xform_cache.GetLocalToWorldTransform(mesh.GetPrim()));
+            batch.meshes.push_back(mesh);
+        }
+    };
+
+    Batch current, upcoming;
+    size_t handed = 0;
+    pull(current);
+    while (!current.meshes.empty()) {
+        tbb::parallel_invoke(
+            [&] { fn(current.meshes, current.world_xforms); },
+            [&] { pull(upcoming); });
+        handed += current.meshes.size();
+        std::swap(current, upcoming);
+    }
+    return handed;
 }
 
 } // namespace ufd
@@ -1,7 +1,21 @@
 #include <ufd/SurfaceExtractor.h>
-
+#include <ufd/GeometryCache.h>
+#include <ufd/Metrics.h>
+#include <ufd/StageReader.h>
+#include <ufd/Trace.h>
+#include <ufd/TransformKernel.h>
+
+#include <pxr/usd/usdGeom/bboxCache.h>
+#include <pxr/usd/usdGeom/tokens.h>
 #include <pxr/usd/usdGeom/xformCache.h>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <functional>
+
 //#define UFD_DEBUG_TRANSFORMS
 #ifdef UFD_DEBUG_TRANSFORMS
 #include <iostream>
@@ -10,46 +24,73 @@
 namespace ufd {
 
 SurfaceData SurfaceExtractor::extract(
-    const std::vector<UsdGeomMesh>& meshes) const {
-    SurfaceData result;
-    UsdGeomXformCache xform_cache;
-
+    const std::vector<UsdGeomMesh>& meshes, UsdTimeCode time) const {
+    ScopedPhase phase("extraction");
+    // UsdGeomXformCache is not thread-safe; resolve world transforms first
+    UsdGeomXformCache xform_cache(time);
+    std::vector<GfMatrix4d> world_xforms;
+    world_xforms.reserve(meshes.size());
     for (const auto& mesh : meshes) {
-        VtVec3fArray points;
-        mesh.GetPointsAttr().Get(&points);
-
-        VtIntArray face_vertex_counts;
-        mesh.GetFaceVertexCountsAttr().Get(&face_vertex_counts);
-
-        VtIntArray face_vertex_indices;
-        mesh.GetFaceVertexIndicesAttr().Get(&face_vertex_indices);
-
-        GfMatrix4d world_xform =
-            xform_cache.GetLocalToWorldTransform(mesh.GetPrim());
-
+        world_xforms.push_back(
+            xform_cache.GetLocalToWorldTransform(mesh.GetPrim()));
 #ifdef UFD_DEBUG_TRANSFORMS
         std::cerr << "[SurfaceExtractor] " << mesh.GetPrim().GetPath()
-                  << "\n  world_xform:\n" << world_xform << "\n";
+                  << "\n  world_xform:\n" << world_xforms.back() << "\n";
 #endif
+    }
 
-        int point_offset = static_cast<int>(result.points.size());
-
-        for (const auto& pt : points) {
-            GfVec3d world_pt = world_xform.Transform(
-                GfVec3d(pt[0], pt[1], pt[2]));
-            result.points.push_back(
-                GfVec3f(world_pt[0], world_pt[1], world_pt[2]));
-        }
-
-        for (const auto& count : face_vertex_counts) {
-            result.face_vertex_counts.push_back(count);
-        }
-
-        for (const auto& idx : face_vertex_indices) {
-            result.face_vertex_indices.push_back(idx + point_offset);
-        }
+    // Sizing pass: read every mesh's attributes in parallel
+    struct MeshArrays {
+        VtVec3fArray points;
+        VtIntArray   face_vertex_counts;
+        VtIntArray   face_vertex_indices;
+    };
+    std::vector<MeshArrays> arrays(meshes.size());
+    tbb::parallel_for(size_t(0), meshes.size(), [&](size_t i) {
+        UFD_TRACE_SCOPE_ARG("read_mesh", "mesh", i);
+        meshes[i].GetPointsAttr().Get(&arrays[i].points, time);
+        meshes[i].GetFaceVertexCountsAttr().Get(&arrays[i].face_vertex_counts, time);
+        meshes[i].GetFaceVertexIndicesAttr().Get(&arrays[i].face_vertex_indices, time);
+    });
+
+    // Each mesh's slice of the merged arrays, by prefix sum
+    struct Offsets { size_t points = 0, counts = 0, indices = 0; };
+    std::vector<Offsets> offsets(meshes.size() + 1);
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        offsets[i + 1].points  = offsets[i].points  + arrays[i].points.size();
+        offsets[i + 1].counts  = offsets[i].counts
+                               + arrays[i].face_vertex_counts.size();
+        offsets[i + 1].indices = offsets[i].indices
+                               + arrays[i].face_vertex_indices.size();
     }
 
+    SurfaceData result;
+    result.points.resize(offsets.back().points);
+    result.face_vertex_counts.resize(offsets.back().counts);
+    result.face_vertex_indices.resize(offsets.back().indices);
+
+    // Non-const data() may detach; take the pointers once, before the tasks
+    GfVec3f* points  = result.points.data();
+    int*     counts  = result.face_vertex_counts.data();
+    int*     indices = result.face_vertex_indices.data();
+
+    tbb::parallel_for(size_t(0), meshes.size(), [&](size_t i) {
+        UFD_TRACE_SCOPE_ARG("fill_mesh", "mesh", i);
+        const MeshArrays& in  = arrays[i];
+        const Offsets&    off = offsets[i];
+        const int point_offset = static_cast<int>(off.points);
+
+        transform_points(world_xforms[i],
+                         reinterpret_cast<const float*>(in.points.cdata()),
+                         reinterpret_cast<float*>(points + off.points),
+                         in.points.size());
+        std::copy(in.face_vertex_counts.cbegin(), in.face_vertex_counts.cend(),
+                  counts + off.counts);
+        std::transform(in.face_vertex_indices.cbegin(),
+                       in.face_vertex_indices.cend(), indices + off.indices,
+                       [point_offset](int idx) { return idx + point_offset; });
+    });
+
     return result;
 }
 
@@ -62,4 +103,151 @@ GfRange3d SurfaceExtractor::compute_bounding_box(
     return bbox;
 }
 
+GfRange3d SurfaceExtractor::compute_bounding_box(
+    const std::vector<UsdGeomMesh>& meshes,
+    const std::vector<UsdTimeCode>& times, bool trust_extents) const {
+    GfRange3d bbox;
+    for (const auto& time : times) {
+        bbox.UnionWith(compute_world_bounds(meshes, time, trust_extents));
+    }
+    return bbox;
+}
+
+GfRange3d SurfaceExtractor::compute_world_bounds(
+    const std::vector<UsdGeomMesh>& meshes, UsdTimeCode time,
+    bool trust_extents) const {
+    GfRange3d bbox;
+
+    // Neither cache is thread-safe; take authored extents and the world
+    // transforms of the remaining meshes serially
+    UsdGeomBBoxCache bbox_cache(time, {UsdGeomTokens->default_,
+                                       UsdGeomTokens->render,
+                                       UsdGeomTokens->proxy,
+                                       UsdGeomTokens->guide});
+    UsdGeomXformCache xform_cache(time);
+    std::vector<size_t>     by_points;
+    std::vector<GfMatrix4d> world_xforms;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        if (trust_extents && meshes[i].GetExtentAttr().HasAuthoredValue()) {
+            bbox.UnionWith(bbox_cache.ComputeWorldBound(meshes[i].GetPrim())
+                               .ComputeAlignedRange());
+            continue;
+        }
+        by_points.push_back(i);
+        world_xforms.push_back(
+            xform_cache.GetLocalToWorldTransform(meshes[i].GetPrim()));
+    }
+
+    const GfRange3d from_points = tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, by_points.size()), GfRange3d(),
+        [&](const tbb::blocked_range<size_t>& r, GfRange3d range) {
+            UFD_TRACE_SCOPE_ARG("mesh_bounds", "meshes", r.size());
+            for (size_t k = r.begin(); k < r.end(); ++k) {
+                VtVec3fArray points;
+                meshes[by_points[k]].GetPointsAttr().Get(&points, time);
+                range.UnionWith(transform_bounds(
+                    world_xforms[k],
+                    reinterpret_cast<const float*>(points.cdata()),
+                    points.size()));
+            }
+            return range;
+        },
+        [](const GfRange3d& a, const GfRange3d& b) {
+            return GfRange3d::GetUnion(a, b);
+        });
+    bbox.UnionWith(from_points);
+    return bbox;
+}
+
+GfRange3d SurfaceExtractor::compute_world_bounds(MeshStream& meshes,
+                                                UsdTimeCode time) const {
+    GfRange3d bbox;
+    meshes.for_each_batch(
+        [&](const std::vector<UsdGeomMesh>& batch,
+            const std::vector<GfMatrix4d>& world_xforms) {
+            bbox.UnionWith(tbb::parallel_reduce(
+                tbb::blocked_range<size_t>(0, batch.size()), GfRange3d(),
+                [&](const tbb::blocked_range<size_t>& r, GfRange3d range) {
+                    UFD_TRACE_SCOPE_ARG("mesh_bounds", "meshes", r.size());
+                    for (size_t i = r.begin(); i < r.end(); ++i) {
+                        VtVec3fArray points;
+                        batch[i].GetPointsAttr().Get(&points, time);
+                        range.UnionWith(transform_bounds(
+                            world_xforms[i],
+                            reinterpret_cast<const float*>(points.cdata()),
+                            points.size()));
+                    }
+                    return range;
+                },
+                [](const GfRange3d& a, const GfRange3d& b) {
+                    return GfRange3d::GetUnion(a, b);
+                }));
+        },
+        time);
+    return bbox;
+}
+
+double SurfaceExtractor::compute_surface_area(
+    const SurfaceData& surface) const {
+    double area = 0.0;
+    size_t cursor = 0;
+    for (int count : surface.face_vertex_counts) {
+        const GfVec3d p0(surface.points[surface.face_vertex_indices[cursor]]);
+        for (int i = 1; i + 1 < count; ++i) {
+            const GfVec3d p1(
+                surface.points[surface.face_vertex_indices[cursor + i]]);
+            const GfVec3d p2(
+                surface.points[surface.face_vertex_indices[cursor + i + 1]]);
+            area += 0.5 * GfCross(p1 - p0, p2 - p0).GetLength();
+        }
+        cursor += count;
+    }
+    return area;
+}
+
+GfRange3d SurfaceExtractor::compute_bounding_box(
+    const GeometryCache& geometry) const {
+    const auto& geoms = geometry.geometry();
+    return tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, geoms.size()), GfRange3d(),
+        [&](const tbb::blocked_range<size_t>& r, GfRange3d bbox) {
+            for (size_t i = r.begin(); i < r.end(); ++i) {
+                for (const auto& pt : geoms[i].points)
+                    bbox.UnionWith(GfVec3d(pt[0], pt[1], pt[2]));
+            }
+            return bbox;
+        },
+        [](const GfRange3d& a, const GfRange3d& b) {
+            return GfRange3d::GetUnion(a, b);
+        });
+}
+
+double SurfaceExtractor::compute_surface_area(
+    const GeometryCache& geometry) const {
+    const auto& geoms = geometry.geometry();
+    return tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, geoms.size()), 0.0,
+        [&](const tbb::blocked_range<size_t>& r, double area) {
+            for (size_t i = r.begin(); i < r.end(); ++i) {
+                const MeshGeometry& geom = geoms[i];
+                const auto tri_area = [&](uint32_t a, uint32_t b, uint32_t c) {
+                    const GfVec3d p0(geom.points[a][0], geom.points[a][1],
+                                     geom.points[a][2]);
+                    const GfVec3d p1(geom.points[b][0], geom.points[b][1],
+                                     geom.points[b][2]);
+                    const GfVec3d p2(geom.points[c][0], geom.points[c][1],
+                                     geom.points[c][2]);
+                    return 0.5 * GfCross(p1 - p0, p2 - p0).GetLength();
+                };
+                for (const auto& t : geom.triangles)
+                    area += tri_area(t[0], t[1], t[2]);
+                // Fan-triangulated like compute_surface_area(SurfaceData)
+                for (const auto& q : geom.quads)
+                    area += tri_area(q[0], q[1], q[2]) + tri_area(q[0], q[2], q[3]);
+            }
+            return area;
+        },
+        std::plus<double>());
+}
+
 } // namespace ufd
@@ -0,0 +1,207 @@
+#include <ufd/Trace.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace ufd {
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* arg_name;
+    int64_t     arg;
+    uint64_t    begin_ns;
+    uint64_t    end_ns;
+};
+
+// A block of one thread's events.  Only the owning thread writes; it
+// publishes each event by a release store of count, and each new block by
+// one of next, so a dump taken while other threads trace reads only
+// complete events.
+struct TraceChunk {
+    static constexpr size_t k_capacity = 4096;
+
+    TraceEvent               events[k_capacity];
+    std::atomic<size_t>      count{0};
+    std::atomic<TraceChunk*> next{nullptr};
+};
+
+class ThreadBuffer {
+public:
+    explicit ThreadBuffer(uint32_t tid) : tid_(tid) {}
+    ~ThreadBuffer() { drop_chain(); }
+
+    uint32_t tid() const { return tid_; }
+
+    void append(const TraceEvent& event) {
+        size_t n = tail_->count.load(std::memory_order_relaxed);
+        if (n == TraceChunk::k_capacity) {
+            auto* chunk = new TraceChunk;
+            tail_->next.store(chunk, std::memory_order_release);
+            tail_ = chunk;
+            n = 0;
+        }
+        tail_->events[n] = event;
+        tail_->count.store(n + 1, std::memory_order_release);
+    }
+
+    template <typename Fn>
+    void for_each(const Fn& fn) const {
+        for (const TraceChunk* chunk = &head_; chunk;
+             chunk = chunk->next.load(std::memory_order_acquire)) {
+            const size_t n = chunk->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; ++i) fn(chunk->events[i]);
+        }
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for_each([&](const TraceEvent&) { ++n; });
+        return n;
+    }
+
+    void clear() {
+        drop_chain();
+        head_.count.store(0, std::memory_order_release);
+        tail_ = &head_;
+    }
+
+private:
+    void drop_chain() {
+        TraceChunk* chunk = head_.next.exchange(nullptr);
+        while (chunk) {
+            TraceChunk* next = chunk->next.load();
+            delete chunk;
+            chunk = next;
+        }
+    }
+
+    uint32_t    tid_;
+    TraceChunk  head_;
+    TraceChunk* tail_ = &head_;  // owner only
+};
+
+struct Registry {
+    std::atomic<bool> enabled{false};
+    const std::chrono::steady_clock::time_point epoch =
+        std::chrono::steady_clock::now();
+
+    // Guards buffers, which a thread joins on its first span; the buffers
+    // outlive their threads so a dump still sees exited threads' spans.
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - registry().epoch).count());
+}
+
+ThreadBuffer& thread_buffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        const auto tid = static_cast<uint32_t>(r.buffers.size() + 1);
+        r.buffers.push_back(std::make_unique<ThreadBuffer>(tid));
+        buffer = r.buffers.back().get();
+    }
+    return *buffer;
+}
+
+// Nanoseconds as microseconds, the trace-event time unit.
+std::string micros(uint64_t ns) {
+    std::ostringstream out;
+    out << ns / 1000 << '.';
+    const uint64_t frac = ns % 1000;
+    out << char('0' + frac / 100) << char('0' + frac / 10 % 10)
+        << char('0' + frac % 10);
+    return out.str();
+}
+
+} // namespace
+
+void set_tracing(bool enabled) {
+    registry().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool tracing_enabled() {
+    return registry().enabled.load(std::memory_order_relaxed);
+}
+
+void reset_trace() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& buffer : r.buffers) buffer->clear();
+}
+
+size_t trace_event_count() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    size_t n = 0;
+    for (const auto& buffer : r.buffers) n += buffer->size();
+    return n;
+}
+
+std::string trace_json() {
+    Registry& r = registry();
+    const long pid = static_cast<long>(getpid());
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+    const char* sep = "\n";
+    for (const auto& buffer : r.buffers) {
+        if (buffer->size() == 0) continue;
+        out << sep << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": "
+            << pid << ", \"tid\": " << buffer->tid()
+            << ", \"args\": {\"name\": \"thread " << buffer->tid() << "\"}}";
+        sep = ",\n";
+        buffer->for_each([&](const TraceEvent& e) {
+            out << sep << "{\"name\": \"" << e.name
+                << "\", \"cat\": \"ufd\", \"ph\": \"X\", \"ts\": "
+                << micros(e.begin_ns) << ", \"dur\": "
+                << micros(e.end_ns - e.begin_ns) << ", \"pid\": " << pid
+                << ", \"tid\": " << buffer->tid();
+            if (e.arg_name)
+                out << ", \"args\": {\"" << e.arg_name << "\": " << e.arg << "}";
+            out << "}";
+        });
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+bool write_trace(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    out << trace_json();
+    return static_cast<bool>(out);
+}
+
+TraceScope::TraceScope(const char* name, const char* arg_name, int64_t arg)
+    : name_(tracing_enabled() ? name : nullptr), arg_name_(arg_name),
+      arg_(arg) {
+    if (name_) begin_ns_ = now_ns();
+}
+
+TraceScope::~TraceScope() {
+    if (!name_) return;
+    const uint64_t end_ns = now_ns();
+    thread_buffer().append({name_, arg_name_, arg_, begin_ns_, end_ns});
+}
+
+} // namespace ufd
@@ -0,0 +1,237 @@
+#include <ufd/TransformKernel.h>
+
+#include <pxr/base/gf/vec3d.h>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define UFD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ufd {
+
+namespace {
+
+// Points per TBB task; below this a call stays on the calling thread.
+constexpr size_t k_grain = size_t(1) << 16;
+
+// Points transform_bounds transforms into its stack buffer at a time.
+constexpr size_t k_bounds_chunk = 1024;
+
+// Rows of an affine matrix act as out = x*row0 + y*row1 + z*row2 + row3,
+// summed left to right as GfMatrix4d::Transform does.  a is the row-major
+// GfMatrix4d array.
+
+void transform_scalar(const double* a, const float* in, float* out,
+                      size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i) {
+        const double x = in[3 * i], y = in[3 * i + 1], z = in[3 * i + 2];
+        out[3 * i]     = static_cast<float>(x * a[0] + y * a[4] + z * a[8]  + a[12]);
+        out[3 * i + 1] = static_cast<float>(x * a[1] + y * a[5] + z * a[9]  + a[13]);
+        out[3 * i + 2] = static_cast<float>(x * a[2] + y * a[6] + z * a[10] + a[14]);
+    }
+}
+
+// Projective matrices go through GfMatrix4d itself for its perspective
+// divide.
+void transform_projective(const GfMatrix4d& m, const float* in, float* out,
+                          size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i) {
+        const GfVec3d p = m.Transform(
+            GfVec3d(in[3 * i], in[3 * i + 1], in[3 * i + 2]));
+        out[3 * i]     = static_cast<float>(p[0]);
+        out[3 * i + 1] = static_cast<float>(p[1]);
+        out[3 * i + 2] = static_cast<float>(p[2]);
+    }
+}
+
+#ifdef UFD_X86
+
+// The SIMD paths hold one point per iteration, one matrix row per register
+// (the w lane is computed and dropped).  Their targets leave out FMA, so the
+// compiler cannot contract the multiplies and adds and change the rounding.
+// Each point is fully loaded before its two stores, so in may equal out.
+
+__attribute__((target("sse2")))
+void transform_sse2(const double* a, const float* in, float* out,
+                    size_t begin, size_t end)
+{
+    const __m128d r0xy = _mm_loadu_pd(a),      r0zw = _mm_loadu_pd(a + 2);
+    const __m128d r1xy = _mm_loadu_pd(a + 4),  r1zw = _mm_loadu_pd(a + 6);
+    const __m128d r2xy = _mm_loadu_pd(a + 8),  r2zw = _mm_loadu_pd(a + 10);
+    const __m128d r3xy = _mm_loadu_pd(a + 12), r3zw = _mm_loadu_pd(a + 14);
+
+    for (size_t i = begin; i < end; ++i) {
+        const float*  p = in + 3 * i;
+        const __m128d x = _mm_set1_pd(p[0]);
+        const __m128d y = _mm_set1_pd(p[1]);
+        const __m128d z = _mm_set1_pd(p[2]);
+
+        __m128d xy = _mm_mul_pd(x, r0xy);
+        xy = _mm_add_pd(xy, _mm_mul_pd(y, r1xy));
+        xy = _mm_add_pd(xy, _mm_mul_pd(z, r2xy));
+        xy = _mm_add_pd(xy, r3xy);
+        __m128d zw = _mm_mul_pd(x, r0zw);
+        zw = _mm_add_pd(zw, _mm_mul_pd(y, r1zw));
+        zw = _mm_add_pd(zw, _mm_mul_pd(z, r2zw));
+        zw = _mm_add_pd(zw, r3zw);
+
+        float* q = out + 3 * i;
+        _mm_storel_pi(reinterpret_cast<__m64*>(q), _mm_cvtpd_ps(xy));
+        _mm_store_ss(q + 2, _mm_cvtpd_ps(zw));
+    }
+}
+
+__attribute__((target("avx2")))
+void transform_avx2(const double* a, const float* in, float* out,
+                    size_t begin, size_t end)
+{
+    const __m256d r0 = _mm256_loadu_pd(a);
+    const __m256d r1 = _mm256_loadu_pd(a + 4);
+    const __m256d r2 = _mm256_loadu_pd(a + 8);
+    const __m256d r3 = _mm256_loadu_pd(a + 12);
+
+    for (size_t i = begin; i < end; ++i) {
+        const float* p = in + 3 * i;
+        __m256d v = _mm256_mul_pd(_mm256_set1_pd(p[0]), r0);
+        v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_set1_pd(p[1]), r1));
+        v = _mm256_add_pd(v, _mm256_mul_pd(_mm256_set1_pd(p[2]), r2));
+        v = _mm256_add_pd(v, r3);
+
+        const __m128 f = _mm256_cvtpd_ps(v);
+        float* q = out + 3 * i;
+        _mm_storel_pi(reinterpret_cast<__m64*>(q), f);
+        _mm_store_ss(q + 2, _mm_movehl_ps(f, f));
+    }
+}
+
+#endif // UFD_X86
+
+SimdLevel detect_simd_level() {
+#ifdef UFD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+bool is_affine(const GfMatrix4d& m) {
+    return m[0][3] == 0.0 && m[1][3] == 0.0 && m[2][3] == 0.0
+        && m[3][3] == 1.0;
+}
+
+// Transform points [begin, end) of in to out at level.
+void transform_range(const GfMatrix4d& m, bool affine, SimdLevel level,
+                     const float* in, float* out, size_t begin, size_t end)
+{
+    if (!affine) return transform_projective(m, in, out, begin, end);
+#ifdef UFD_X86
+    const double* a = m.GetArray();
+    switch (level) {
+    case SimdLevel::AVX2: return transform_avx2(a, in, out, begin, end);
+    case SimdLevel::SSE2: return transform_sse2(a, in, out, begin, end);
+    default:              return transform_scalar(a, in, out, begin, end);
+    }
+#else
+    (void)level;
+    transform_scalar(m.GetArray(), in, out, begin, end);
+#endif
+}
+
+// Bounds of points [begin, end) of in once transformed, a chunk at a time
+// through a buffer that stays in L1.
+GfRange3d bounds_range(const GfMatrix4d& m, bool affine, SimdLevel level,
+                       const float* in, size_t begin, size_t end)
+{
+    float buffer[3 * k_bounds_chunk];
+    float lo[3], hi[3];
+    std::fill(lo, lo + 3,  std::numeric_limits<float>::infinity());
+    std::fill(hi, hi + 3, -std::numeric_limits<float>::infinity());
+
+    for (size_t b = begin; b < end; b += k_bounds_chunk) {
+        const size_t n = std::min(k_bounds_chunk, end - b);
+        transform_range(m, affine, level, in + 3 * b, buffer, 0, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                lo[c] = std::min(lo[c], buffer[3 * i + c]);
+                hi[c] = std::max(hi[c], buffer[3 * i + c]);
+            }
+        }
+    }
+    if (begin == end) return GfRange3d();
+    return GfRange3d(GfVec3d(lo[0], lo[1], lo[2]), GfVec3d(hi[0], hi[1], hi[2]));
+}
+
+} // namespace
+
+const char* to_string(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::SSE2:   return "sse2";
+    case SimdLevel::AVX2:   return "avx2";
+    }
+    return "unknown";
+}
+
+SimdLevel detected_simd_level() {
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
+
+void transform_points(const GfMatrix4d& m, const float* in, float* out,
+                      size_t count)
+{
+    transform_points(m, in, out, count, detected_simd_level());
+}
+
+void transform_points(const GfMatrix4d& m, const float* in, float* out,
+                      size_t count, SimdLevel level)
+{
+    level = std::min(level, detected_simd_level());
+    const bool affine = is_affine(m);
+
+    if (count <= k_grain) {
+        transform_range(m, affine, level, in, out, 0, count);
+        return;
+    }
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, count, k_grain),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                          transform_range(m, affine, level, in, out,
+                                          r.begin(), r.end());
+                      });
+}
+
+GfRange3d transform_bounds(const GfMatrix4d& m, const float* in, size_t count)
+{
+    return transform_bounds(m, in, count, detected_simd_level());
+}
+
+GfRange3d transform_bounds(const GfMatrix4d& m, const float* in, size_t count,
+                           SimdLevel level)
+{
+    level = std::min(level, detected_simd_level());
+    const bool affine = is_affine(m);
+
+    if (count <= k_grain) return bounds_range(m, affine, level, in, 0, count);
+    return tbb::parallel_reduce(
+        tbb::blocked_range<size_t>(0, count, k_grain), GfRange3d(),
+        [&](const tbb::blocked_range<size_t>& r, GfRange3d bbox) {
+            bbox.UnionWith(bounds_range(m, affine, level, in,
+                                        r.begin(), r.end()));
+            return bbox;
+        },
+        [](const GfRange3d& a, const GfRange3d& b) {
+            return GfRange3d::GetUnion(a, b);
+        });
+}
+
+} // namespace ufd
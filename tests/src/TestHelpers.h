@@ -0,0 +1,81 @@
+#pragma once
+
+// Fixtures shared by several test files.
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tools/LevelSetSphere.h>
+
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/xform.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/gf/vec3f.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Helper: empty directory under the system temp dir, named after the test
+// plus this process's pid and a counter, so tests run in parallel (ctest -j
+// runs each test in its own process) never share one.  Removed at exit.
+inline std::string fresh_temp_dir(const std::string& name) {
+    struct Registry {
+        std::mutex                         mutex;
+        std::vector<std::filesystem::path> dirs;
+        ~Registry() {
+            std::error_code ec;
+            for (const auto& dir : dirs) std::filesystem::remove_all(dir, ec);
+        }
+    };
+    static Registry registry;
+    static std::atomic<int> counter{0};
+
+    const auto dir = std::filesystem::temp_directory_path()
+        / ("ufd_" + name + "_" + std::to_string(getpid()) + "_"
+           + std::to_string(counter++));
+    std::filesystem::remove_all(dir);
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.dirs.push_back(dir);
+    return dir.string();
+}
+
+// Helper: narrow-band level-set sphere about the origin
+inline openvdb::FloatGrid::Ptr make_sphere(float radius, float voxel_size = 1.0f) {
+    openvdb::initialize();
+    return openvdb::tools::createLevelSetSphere<openvdb::FloatGrid>(
+        radius, openvdb::Vec3f(0.0f), voxel_size);
+}
+
+// Helper: unit cube mesh at part/mesh under a Xform part translated by offset
+inline void define_unit_cube(pxr::UsdStageRefPtr stage, const std::string& part,
+                             const pxr::GfVec3d& offset) {
+    using namespace pxr;
+    static const VtVec3fArray points = {
+        GfVec3f(0, 0, 0), GfVec3f(1, 0, 0), GfVec3f(1, 1, 0), GfVec3f(0, 1, 0),
+        GfVec3f(0, 0, 1), GfVec3f(1, 0, 1), GfVec3f(1, 1, 1), GfVec3f(0, 1, 1),
+    };
+    static const VtIntArray counts  = {4, 4, 4, 4, 4, 4};
+    static const VtIntArray indices = {
+        0, 3, 2, 1,  4, 5, 6, 7,  0, 1, 5, 4,
+        3, 7, 6, 2,  0, 4, 7, 3,  1, 2, 6, 5,
+    };
+    auto xf = UsdGeomXform::Define(stage, SdfPath(part));
+    xf.AddTranslateOp().Set(offset);
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath(part + "/mesh"));
+    mesh.GetPointsAttr().Set(points);
+    mesh.GetFaceVertexCountsAttr().Set(counts);
+    mesh.GetFaceVertexIndicesAttr().Set(indices);
+}
+
+// Helper: collect every mesh prim on a stage
+inline std::vector<pxr::UsdGeomMesh> stage_meshes(pxr::UsdStageRefPtr stage) {
+    std::vector<pxr::UsdGeomMesh> meshes;
+    for (const auto& prim : stage->Traverse())
+        if (prim.IsA<pxr::UsdGeomMesh>()) meshes.emplace_back(prim);
+    return meshes;
+}
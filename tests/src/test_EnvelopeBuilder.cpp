@@ -1,21 +1,38 @@
+#include "TestHelpers.h"
+
 #include <ufd/StageReader.h>
 #include <ufd/SurfaceExtractor.h>
 #include <ufd/EnvelopeBuilder.h>
+#include <ufd/GeometryCache.h>
+#include <ufd/Metrics.h>
 
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/xform.h>
 #include <pxr/usd/sdf/path.h>
+#include <pxr/base/gf/matrix4d.h>
 #include <pxr/base/gf/range3d.h>
+#include <pxr/base/gf/rotation.h>
 #include <pxr/base/gf/vec3f.h>
 
 #include <gtest/gtest.h>
 
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <numeric>
+#include <set>
+
 static const std::string BOX_USD =
     std::string(TEST_RESOURCES_DIR) + "/box.usda";
 static const std::string BOX_X2_DISJOINT_USD =
     std::string(TEST_RESOURCES_DIR) + "/box_x2_disjoint.usda";
 static const std::string BOX_X2_INTERSECTED_USD =
     std::string(TEST_RESOURCES_DIR) + "/box_x2_intersected.usda";
+static const std::string BOX_X3_INSTANCED_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box_x3_instanced.usda";
 
 // Helper: get /Envelope mesh from an in-memory stage
 static UsdGeomMesh envelope_mesh(UsdStageRefPtr stage) {
@@ -38,6 +55,91 @@ static GfRange3d input_bbox(const std::vector<UsdGeomMesh>& meshes) {
     return ext.compute_bounding_box(ext.extract(meshes));
 }
 
+// Helper: in-memory stage with nx*ny*nz unit cubes on a grid of the given
+// pitch, each under its own translated Xform — a stand-in for many-part
+// assemblies.
+static UsdStageRefPtr make_cube_grid_stage(int nx, int ny, int nz, double pitch) {
+    auto stage = pxr::UsdStage::CreateInMemory();
+    for (int i = 0; i < nx; ++i)
+    for (int j = 0; j < ny; ++j)
+    for (int k = 0; k < nz; ++k) {
+        define_unit_cube(stage, "/Scene/part_" + std::to_string(i) + "_"
+                                + std::to_string(j) + "_" + std::to_string(k),
+                         GfVec3d(i * pitch, j * pitch, k * pitch));
+    }
+    return stage;
+}
+
+// Helper: two unit cubes turned so their x axes point along the body
+// diagonal (1,1,1), facing each other across a slab-shaped gap of the given
+// width whose normal is that diagonal.
+static UsdStageRefPtr make_diagonal_gap_stage(double gap) {
+    auto stage = pxr::UsdStage::CreateInMemory();
+    const GfVec3d diagonal = GfVec3d(1, 1, 1).GetNormalized();
+    GfMatrix4d turn;
+    turn.SetRotate(GfRotation(GfVec3d(1, 0, 0), diagonal));
+    for (int i = 0; i < 2; ++i) {
+        const std::string part = "/Scene/part_" + std::to_string(i);
+        define_unit_cube(stage, part, i * (1.0 + gap) * diagonal);
+        UsdGeomXform(stage->GetPrimAtPath(SdfPath(part)))
+            .AddTransformOp().Set(turn);
+    }
+    return stage;
+}
+
+// Helper: number of edge-connected pieces of the /Envelope mesh
+static size_t envelope_component_count(UsdStageRefPtr stage) {
+    VtVec3fArray pts;
+    VtIntArray counts, indices;
+    envelope_mesh(stage).GetPointsAttr().Get(&pts);
+    envelope_mesh(stage).GetFaceVertexCountsAttr().Get(&counts);
+    envelope_mesh(stage).GetFaceVertexIndicesAttr().Get(&indices);
+
+    std::vector<int> parent(pts.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    const auto root = [&](int v) {
+        while (parent[v] != v) v = parent[v] = parent[parent[v]];
+        return v;
+    };
+    size_t cursor = 0;
+    for (int n : counts) {
+        for (int c = 1; c < n; ++c)
+            parent[root(indices[cursor + c])] = root(indices[cursor]);
+        cursor += n;
+    }
+    size_t components = 0;
+    for (size_t v = 0; v < parent.size(); ++v)
+        if (root(static_cast<int>(v)) == static_cast<int>(v)) ++components;
+    return components;
+}
+
+// Helper: build serially and in parallel and check the envelopes agree to
+// within one voxel.
+static void expect_parallel_matches_serial(const std::vector<UsdGeomMesh>& meshes,
+                                           ufd::EnvelopeConfig cfg) {
+    cfg.mode     = ufd::VoxelizeMode::PerMesh;
+    cfg.parallel = false;
+    auto serial_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(serial_stage, meshes);
+
+    cfg.parallel = true;
+    auto parallel_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(parallel_stage, meshes);
+
+    VtIntArray serial_counts, parallel_counts;
+    envelope_mesh(serial_stage).GetFaceVertexCountsAttr().Get(&serial_counts);
+    envelope_mesh(parallel_stage).GetFaceVertexCountsAttr().Get(&parallel_counts);
+    EXPECT_FALSE(parallel_counts.empty());
+    EXPECT_EQ(serial_counts.size(), parallel_counts.size());
+
+    auto serial_bb   = surface_bbox(serial_stage);
+    auto parallel_bb = surface_bbox(parallel_stage);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(serial_bb.GetMin()[a], parallel_bb.GetMin()[a], cfg.voxel_size);
+        EXPECT_NEAR(serial_bb.GetMax()[a], parallel_bb.GetMax()[a], cfg.voxel_size);
+    }
+}
+
 // ---- Single box ----
 
 TEST(EnvelopeBuilderTest, SingleBoxReturnsNonEmptySurface) {
@@ -213,3 +315,956 @@ TEST(EnvelopeBuilderTest, EmptyMeshListReturnsEmptyPath) {
 
     EXPECT_TRUE(path.empty());
 }
+
+// ---- Parallel voxelization ----
+
+TEST(EnvelopeBuilderTest, DefaultConfigIsParallel) {
+    ufd::EnvelopeConfig cfg;
+
+    EXPECT_TRUE(cfg.parallel);
+}
+
+TEST(EnvelopeBuilderTest, ParallelMatchesSerialOnDisjointBoxes) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.5;
+    cfg.hole_threshold = 1.0;
+
+    expect_parallel_matches_serial(reader.collect_meshes(), cfg);
+}
+
+TEST(EnvelopeBuilderTest, ParallelMatchesSerialOnIntersectedBoxes) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_INTERSECTED_USD);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.5;
+    cfg.hole_threshold = 0.0;
+
+    expect_parallel_matches_serial(reader.collect_meshes(), cfg);
+}
+
+TEST(EnvelopeBuilderTest, ParallelMatchesSerialOnManyParts) {
+    // 10x10x4 = 400 unit cubes with 0.5-unit gaps
+    auto scene  = make_cube_grid_stage(10, 10, 4, 1.5);
+    auto meshes = stage_meshes(scene);
+    ASSERT_EQ(meshes.size(), 400);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.0;
+
+    expect_parallel_matches_serial(meshes, cfg);
+}
+
+// ---- Voxelize mode ----
+
+TEST(EnvelopeBuilderTest, DefaultModeIsAuto) {
+    ufd::EnvelopeConfig cfg;
+
+    EXPECT_EQ(cfg.mode, ufd::VoxelizeMode::Auto);
+}
+
+TEST(EnvelopeBuilderTest, AutoModeUsesPerMeshForSingleMesh) {
+    ufd::StageReader reader;
+    reader.open(BOX_USD);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 1.0;
+    cfg.hole_threshold = 0.0;
+
+    ufd::EnvelopeStats stats;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(stage, reader.collect_meshes(), {}, &stats);
+
+    EXPECT_EQ(stats.mode, ufd::VoxelizeMode::PerMesh);
+    EXPECT_EQ(stats.mesh_count, 1);
+    EXPECT_EQ(stats.face_count, 12);
+}
+
+TEST(EnvelopeBuilderTest, AutoModeUsesSoupForManySmallMeshes) {
+    auto scene  = make_cube_grid_stage(4, 4, 4, 1.5);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size       = 0.25;
+    cfg.hole_threshold   = 0.0;
+    cfg.reuse_prototypes = false;  // the cubes are identical
+
+    ufd::EnvelopeStats stats;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(stage, meshes, {}, &stats);
+
+    EXPECT_EQ(stats.mode, ufd::VoxelizeMode::Soup);
+    EXPECT_EQ(stats.mesh_count, 64);
+    EXPECT_EQ(stats.face_count, 64 * 6);
+}
+
+TEST(EnvelopeBuilderTest, AutoModeUsesPerMeshForFewMeshes) {
+    // Two small cubes: too few meshes for the soup to pay off
+    auto scene  = make_cube_grid_stage(2, 1, 1, 1.5);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.25;
+    cfg.hole_threshold = 0.0;
+
+    ufd::EnvelopeStats stats;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(stage, meshes, {}, &stats);
+
+    EXPECT_EQ(stats.mode, ufd::VoxelizeMode::PerMesh);
+}
+
+TEST(EnvelopeBuilderTest, AutoModeUsesPerMeshForLargeMeshes) {
+    auto scene  = make_cube_grid_stage(4, 4, 4, 1.5);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size          = 0.25;
+    cfg.hole_threshold      = 0.0;
+    cfg.soup_max_mean_faces = 4;  // each cube has 6 faces
+    cfg.reuse_prototypes    = false;
+
+    ufd::EnvelopeStats stats;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(stage, meshes, {}, &stats);
+
+    EXPECT_EQ(stats.mode, ufd::VoxelizeMode::PerMesh);
+}
+
+TEST(EnvelopeBuilderTest, AutoModeStampsDuplicatedSmallParts) {
+    // 64 identical small cubes: default config stamps them from one
+    // prototype rather than voxelizing them all as a soup
+    auto scene  = make_cube_grid_stage(4, 4, 4, 1.5);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.25;
+    cfg.hole_threshold = 0.0;
+
+    ufd::EnvelopeStats stats;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(stage, meshes, {}, &stats);
+
+    EXPECT_EQ(stats.prototype_count, 1);
+    EXPECT_EQ(stats.stamped_count, 63);
+    EXPECT_EQ(stats.mode, ufd::VoxelizeMode::PerMesh);
+
+    auto env_bb = surface_bbox(stage);
+    auto inp_bb = input_bbox(meshes);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_LE(env_bb.GetMin()[a], inp_bb.GetMin()[a] + 1e-3);
+        EXPECT_GE(env_bb.GetMax()[a], inp_bb.GetMax()[a] - 1e-3);
+    }
+}
+
+TEST(EnvelopeBuilderTest, SoupModeMatchesPerMeshMode) {
+    auto scene  = make_cube_grid_stage(6, 6, 3, 1.5);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.0;
+
+    cfg.mode = ufd::VoxelizeMode::PerMesh;
+    auto per_mesh_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(per_mesh_stage, meshes);
+
+    cfg.mode = ufd::VoxelizeMode::Soup;
+    auto soup_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(soup_stage, meshes);
+
+    auto per_mesh_bb = surface_bbox(per_mesh_stage);
+    auto soup_bb     = surface_bbox(soup_stage);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(per_mesh_bb.GetMin()[a], soup_bb.GetMin()[a], cfg.voxel_size);
+        EXPECT_NEAR(per_mesh_bb.GetMax()[a], soup_bb.GetMax()[a], cfg.voxel_size);
+    }
+}
+
+// ---- Prototype reuse ----
+
+TEST(EnvelopeBuilderTest, InstancedBoxesReuseOnePrototype) {
+    // Three instances of one prototype, the third rotated 90 degrees about Z
+    ufd::StageReader reader;
+    reader.open(BOX_X3_INSTANCED_USD);
+    auto meshes = reader.collect_meshes();
+    ASSERT_EQ(meshes.size(), 3);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.5;
+    cfg.hole_threshold = 0.0;
+
+    ufd::EnvelopeStats stats;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(stage, meshes, {}, &stats);
+
+    EXPECT_EQ(stats.prototype_count, 1);
+    EXPECT_EQ(stats.stamped_count, 2);
+
+    auto env_bb = surface_bbox(stage);
+    auto inp_bb = input_bbox(meshes);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_LE(env_bb.GetMin()[a], inp_bb.GetMin()[a] + 1e-3);
+        EXPECT_GE(env_bb.GetMax()[a], inp_bb.GetMax()[a] - 1e-3);
+    }
+}
+
+TEST(EnvelopeBuilderTest, DisabledReuseVoxelizesEveryMesh) {
+    ufd::StageReader reader;
+    reader.open(BOX_X3_INSTANCED_USD);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size       = 0.5;
+    cfg.hole_threshold   = 0.0;
+    cfg.reuse_prototypes = false;
+
+    ufd::EnvelopeStats stats;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(stage, reader.collect_meshes(), {}, &stats);
+
+    EXPECT_EQ(stats.prototype_count, 0);
+    EXPECT_EQ(stats.stamped_count, 0);
+}
+
+TEST(EnvelopeBuilderTest, PrototypeReuseMatchesDirectVoxelization) {
+    auto scene  = make_cube_grid_stage(8, 8, 4, 1.5);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.0;
+
+    cfg.reuse_prototypes = false;
+    auto direct_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(direct_stage, meshes);
+
+    cfg.reuse_prototypes = true;
+    ufd::EnvelopeStats stats;
+    auto reuse_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(reuse_stage, meshes, {}, &stats);
+
+    EXPECT_EQ(stats.prototype_count, 1);
+    EXPECT_EQ(stats.stamped_count, 255);
+
+    auto direct_bb = surface_bbox(direct_stage);
+    auto reuse_bb  = surface_bbox(reuse_stage);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(direct_bb.GetMin()[a], reuse_bb.GetMin()[a], cfg.voxel_size);
+        EXPECT_NEAR(direct_bb.GetMax()[a], reuse_bb.GetMax()[a], cfg.voxel_size);
+    }
+}
+
+// ---- Closing mode ----
+
+TEST(EnvelopeBuilderTest, DefaultClosingIsLevelSet) {
+    ufd::EnvelopeConfig cfg;
+
+    EXPECT_EQ(cfg.closing, ufd::ClosingMode::LevelSet);
+}
+
+TEST(EnvelopeBuilderTest, TopologyClosingBridgesGapBetweenDisjointBoxes) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::EnvelopeConfig cfg_open;
+    cfg_open.voxel_size     = 0.5;
+    cfg_open.hole_threshold = 0.0;
+
+    ufd::EnvelopeConfig cfg_closed = cfg_open;
+    cfg_closed.hole_threshold = 1.0;
+    cfg_closed.closing        = ufd::ClosingMode::Topology;
+
+    auto stage_open   = pxr::UsdStage::CreateInMemory();
+    auto stage_closed = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg_open).build(stage_open, meshes);
+    ufd::EnvelopeBuilder(cfg_closed).build(stage_closed, meshes);
+
+    VtVec3fArray pts_open, pts_closed;
+    envelope_mesh(stage_open).GetPointsAttr().Get(&pts_open);
+    envelope_mesh(stage_closed).GetPointsAttr().Get(&pts_closed);
+
+    EXPECT_NE(pts_open.size(), pts_closed.size());
+}
+
+TEST(EnvelopeBuilderTest, TopologyClosingMatchesLevelSetClosing) {
+    // 5x5x2 unit cubes 0.3 apart: every gap is bridged for the thresholds
+    // below, so both modes must produce the same outer envelope.
+    auto scene  = make_cube_grid_stage(5, 5, 2, 1.3);
+    auto meshes = stage_meshes(scene);
+
+    for (double threshold : {0.2, 0.4, 0.8}) {
+        ufd::EnvelopeConfig cfg;
+        cfg.voxel_size     = 0.05;
+        cfg.hole_threshold = threshold;
+
+        cfg.closing = ufd::ClosingMode::LevelSet;
+        auto level_set_stage = pxr::UsdStage::CreateInMemory();
+        ufd::EnvelopeStats level_set;
+        ufd::EnvelopeBuilder(cfg).build(level_set_stage, meshes, {}, &level_set);
+
+        cfg.closing = ufd::ClosingMode::Topology;
+        auto topology_stage = pxr::UsdStage::CreateInMemory();
+        ufd::EnvelopeStats topology;
+        ufd::EnvelopeBuilder(cfg).build(topology_stage, meshes, {}, &topology);
+
+        // One closed block either way, with the same surface to within the
+        // bridges' voxel staircase: a filled-in gap or a leftover cavity
+        // would change the face count by far more
+        EXPECT_EQ(envelope_component_count(level_set_stage), 1u);
+        EXPECT_EQ(envelope_component_count(topology_stage), 1u);
+        const double faces = double(level_set.envelope_face_count);
+        EXPECT_NEAR(double(topology.envelope_face_count), faces, 0.1 * faces)
+            << "hole_threshold " << threshold;
+    }
+}
+
+TEST(EnvelopeBuilderTest, TopologyClosingBridgesDiagonalGap) {
+    // A gap of 1.5 * hole_threshold across the body diagonal: a ball of
+    // radius hole_threshold bridges it, as LevelSet closing does, while
+    // face-neighbour steps alone reach only 1/sqrt(3) of the way along the
+    // diagonal and would leave the cubes apart.
+    auto scene  = make_diagonal_gap_stage(0.3);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.05;
+    cfg.hole_threshold = 0.0;
+    auto open_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(open_stage, meshes);
+    EXPECT_EQ(envelope_component_count(open_stage), 2u);
+
+    cfg.hole_threshold = 0.2;
+    for (auto closing : {ufd::ClosingMode::LevelSet, ufd::ClosingMode::Topology}) {
+        cfg.closing = closing;
+        auto stage = pxr::UsdStage::CreateInMemory();
+        ufd::EnvelopeBuilder(cfg).build(stage, meshes);
+        EXPECT_EQ(envelope_component_count(stage), 1u) << ufd::to_string(closing);
+    }
+}
+
+// ---- Adaptive meshing ----
+
+TEST(EnvelopeBuilderTest, DefaultMeshingIsNotAdaptive) {
+    ufd::EnvelopeConfig cfg;
+
+    EXPECT_EQ(cfg.adaptivity, 0.0);
+    EXPECT_EQ(cfg.target_face_count, 0u);
+}
+
+TEST(EnvelopeBuilderTest, StatsReportEnvelopeFaceCountAndDeviation) {
+    ufd::StageReader reader;
+    reader.open(BOX_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.5;
+
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats stats;
+    ufd::EnvelopeBuilder(cfg).build(stage, meshes, {}, &stats);
+
+    VtIntArray counts;
+    envelope_mesh(stage).GetFaceVertexCountsAttr().Get(&counts);
+    EXPECT_EQ(stats.envelope_face_count, counts.size());
+    EXPECT_EQ(stats.adaptivity, 0.0);
+    EXPECT_LT(stats.max_deviation, cfg.voxel_size);
+}
+
+TEST(EnvelopeBuilderTest, AdaptivityReducesFaceCount) {
+    ufd::StageReader reader;
+    reader.open(BOX_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.2;
+
+    ufd::EnvelopeStats uniform, adaptive;
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(),
+                                    meshes, {}, &uniform);
+    cfg.adaptivity = 0.5;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(stage, meshes, {}, &adaptive);
+
+    EXPECT_LT(adaptive.envelope_face_count, uniform.envelope_face_count);
+
+    // Flat faces collapse; the outline stays where it was
+    auto bb = surface_bbox(stage);
+    auto in = input_bbox(meshes);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(bb.GetMin()[a], in.GetMin()[a], 2 * cfg.voxel_size);
+        EXPECT_NEAR(bb.GetMax()[a], in.GetMax()[a], 2 * cfg.voxel_size);
+    }
+}
+
+TEST(EnvelopeBuilderTest, TargetFaceCountIsMet) {
+    auto scene  = make_cube_grid_stage(3, 3, 1, 1.3);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.05;
+    cfg.hole_threshold = 0.4;
+
+    ufd::EnvelopeStats uniform;
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(),
+                                    meshes, {}, &uniform);
+
+    cfg.target_face_count = uniform.envelope_face_count / 4;
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats budgeted;
+    ufd::EnvelopeBuilder(cfg).build(stage, meshes, {}, &budgeted);
+
+    VtIntArray counts;
+    envelope_mesh(stage).GetFaceVertexCountsAttr().Get(&counts);
+    EXPECT_EQ(budgeted.envelope_face_count, counts.size());
+    EXPECT_LE(budgeted.envelope_face_count, cfg.target_face_count);
+    EXPECT_GT(budgeted.adaptivity, 0.0);
+    EXPECT_GE(budgeted.max_deviation, uniform.max_deviation);
+}
+
+TEST(EnvelopeBuilderTest, FeaturePreservationKeepsEdgesCloserToSdf) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_INTERSECTED_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+    cfg.adaptivity = 0.8;
+
+    ufd::EnvelopeStats preserved, plain;
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(),
+                                    meshes, {}, &preserved);
+    cfg.preserve_features = false;
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(),
+                                    meshes, {}, &plain);
+
+    EXPECT_GE(preserved.envelope_face_count, plain.envelope_face_count);
+    EXPECT_LE(preserved.max_deviation, plain.max_deviation);
+}
+
+// ---- Coarse-to-fine ----
+
+TEST(EnvelopeBuilderTest, DefaultIsSingleLevel) {
+    ufd::EnvelopeConfig cfg;
+
+    EXPECT_EQ(cfg.coarse_factor, 1);
+}
+
+TEST(EnvelopeBuilderTest, CoarseToFineBridgesGapBetweenDisjointBoxes) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.25;
+    cfg.hole_threshold = 1.0;
+
+    auto single_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(single_stage, meshes);
+
+    cfg.coarse_factor = 2;
+    auto refined_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(refined_stage, meshes);
+
+    auto single_bb  = surface_bbox(single_stage);
+    auto refined_bb = surface_bbox(refined_stage);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(single_bb.GetMin()[a], refined_bb.GetMin()[a],
+                    cfg.coarse_factor * cfg.voxel_size);
+        EXPECT_NEAR(single_bb.GetMax()[a], refined_bb.GetMax()[a],
+                    cfg.coarse_factor * cfg.voxel_size);
+    }
+}
+
+TEST(EnvelopeBuilderTest, CoarseToFineSkipsBuriedGeometry) {
+    // 5x5x5 unit cubes 0.3 apart, closed into one block: the centre cube is
+    // deeper inside than the coarse band and never reaches the fine pass.
+    auto scene  = make_cube_grid_stage(5, 5, 5, 1.3);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.4;
+
+    auto single_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats single;
+    ufd::EnvelopeBuilder(cfg).build(single_stage, meshes, {}, &single);
+
+    cfg.coarse_factor = 4;
+    auto refined_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats refined;
+    ufd::EnvelopeBuilder(cfg).build(refined_stage, meshes, {}, &refined);
+
+    EXPECT_LT(refined.refined_face_count, refined.face_count);
+    EXPECT_LT(refined.active_voxel_count, single.active_voxel_count);
+
+    auto single_bb  = surface_bbox(single_stage);
+    auto refined_bb = surface_bbox(refined_stage);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(single_bb.GetMin()[a], refined_bb.GetMin()[a],
+                    2 * cfg.voxel_size);
+        EXPECT_NEAR(single_bb.GetMax()[a], refined_bb.GetMax()[a],
+                    2 * cfg.voxel_size);
+    }
+}
+
+// ---- Time-sampled envelopes ----
+
+// Helper: two unit cubes; /Scene/part_0_0_0 stays put, /Scene/part_1_0_0
+// slides from x = 1.3 at time 0 to x = 3.3 at time 10.
+static UsdStageRefPtr make_sliding_cube_stage() {
+    auto stage = make_cube_grid_stage(2, 1, 1, 1.3);
+    UsdGeomXform moving(stage->GetPrimAtPath(SdfPath("/Scene/part_1_0_0")));
+    bool reset = false;
+    auto op = moving.GetOrderedXformOps(&reset)[0];
+    op.Set(GfVec3d(1.3, 0, 0), UsdTimeCode(0));
+    op.Set(GfVec3d(3.3, 0, 0), UsdTimeCode(10));
+    return stage;
+}
+
+// Helper: AABB of /Envelope points at a time
+static GfRange3d surface_bbox_at(UsdStageRefPtr stage, UsdTimeCode time) {
+    VtVec3fArray pts;
+    envelope_mesh(stage).GetPointsAttr().Get(&pts, time);
+    GfRange3d bbox;
+    for (const auto& p : pts)
+        bbox.UnionWith(GfVec3d(p[0], p[1], p[2]));
+    return bbox;
+}
+
+TEST(EnvelopeBuilderTest, AnimatedBuildWritesOneSamplePerTime) {
+    auto scene  = make_sliding_cube_stage();
+    auto meshes = stage_meshes(scene);
+    const std::vector<UsdTimeCode> times = {
+        UsdTimeCode(0), UsdTimeCode(5), UsdTimeCode(10)};
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.0;
+
+    auto stage = pxr::UsdStage::CreateInMemory();
+    auto path  = ufd::EnvelopeBuilder(cfg).build_animated(stage, meshes, times);
+    ASSERT_EQ(path, "/Envelope");
+
+    std::vector<double> samples;
+    envelope_mesh(stage).GetPointsAttr().GetTimeSamples(&samples);
+    EXPECT_EQ(samples, (std::vector<double>{0, 5, 10}));
+
+    // The moving cube ends at x = 4.3
+    EXPECT_NEAR(surface_bbox_at(stage, UsdTimeCode(0)).GetMax()[0],  2.3,
+                2 * cfg.voxel_size);
+    EXPECT_NEAR(surface_bbox_at(stage, UsdTimeCode(10)).GetMax()[0], 4.3,
+                2 * cfg.voxel_size);
+}
+
+TEST(EnvelopeBuilderTest, AnimatedBuildReusesStaticMeshes) {
+    auto scene  = make_sliding_cube_stage();
+    auto meshes = stage_meshes(scene);
+    const std::vector<UsdTimeCode> times = {
+        UsdTimeCode(0), UsdTimeCode(5), UsdTimeCode(10)};
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+
+    std::vector<ufd::EnvelopeStats> stats;
+    ufd::EnvelopeBuilder(cfg).build_animated(
+        pxr::UsdStage::CreateInMemory(), meshes, times, &stats);
+
+    ASSERT_EQ(stats.size(), 3u);
+    EXPECT_EQ(stats[0].voxelized_count, 2u);
+    EXPECT_EQ(stats[1].voxelized_count, 1u);  // only the moving cube
+    EXPECT_EQ(stats[2].voxelized_count, 1u);
+    EXPECT_EQ(stats[1].reused_mesh_count, 1u);
+}
+
+TEST(EnvelopeBuilderTest, AnimatedFrameMatchesSingleBuild) {
+    auto scene  = make_sliding_cube_stage();
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+
+    auto animated = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build_animated(
+        animated, meshes, {UsdTimeCode(0), UsdTimeCode(10)});
+
+    // At time 0 the moving cube is where the static layout puts it
+    auto posed  = make_cube_grid_stage(2, 1, 1, 1.3);
+    auto single = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(single, stage_meshes(posed));
+
+    VtIntArray animated_counts, single_counts;
+    envelope_mesh(animated).GetFaceVertexCountsAttr().Get(&animated_counts,
+                                                          UsdTimeCode(0));
+    envelope_mesh(single).GetFaceVertexCountsAttr().Get(&single_counts);
+    EXPECT_EQ(animated_counts.size(), single_counts.size());
+}
+
+TEST(EnvelopeBuilderTest, AnimatedBuildInBatchesMatchesOneBatch) {
+    auto scene  = make_sliding_cube_stage();
+    auto meshes = stage_meshes(scene);
+    std::vector<UsdTimeCode> times;
+    for (int t = 0; t <= 10; t += 2) times.emplace_back(t);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+
+    // One thread builds one frame per batch, dropping each sample of the
+    // moving cube once its frame is done
+    std::vector<ufd::EnvelopeStats> batched, whole;
+    auto batched_stage = pxr::UsdStage::CreateInMemory();
+    tbb::task_arena(1).execute([&] {
+        ufd::EnvelopeBuilder(cfg).build_animated(batched_stage, meshes, times,
+                                                 &batched);
+    });
+    ufd::EnvelopeBuilder(cfg).build_animated(pxr::UsdStage::CreateInMemory(),
+                                             meshes, times, &whole);
+
+    ASSERT_EQ(batched.size(), times.size());
+    ASSERT_EQ(whole.size(), times.size());
+    for (size_t f = 0; f < times.size(); ++f) {
+        EXPECT_EQ(batched[f].envelope_face_count, whole[f].envelope_face_count);
+        EXPECT_EQ(batched[f].voxelized_count, whole[f].voxelized_count);
+        EXPECT_GT(batched[f].envelope_face_count, 0u);
+    }
+    EXPECT_NEAR(surface_bbox_at(batched_stage, UsdTimeCode(10)).GetMax()[0],
+                4.3, 2 * cfg.voxel_size);
+}
+
+// ---- Streamed builds ----
+
+TEST(EnvelopeBuilderTest, StreamedBuildMatchesPerMeshBuild) {
+    auto scene  = make_cube_grid_stage(6, 6, 3, 1.5);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size       = 0.1;
+    cfg.mode             = ufd::VoxelizeMode::PerMesh;
+    cfg.reuse_prototypes = false;
+
+    auto collected_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats collected;
+    ufd::EnvelopeBuilder(cfg).build(collected_stage, meshes, {}, &collected);
+
+    auto streamed_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats streamed;
+    GfRange3d bounds;
+    ufd::MeshStream stream(scene);
+    auto path = ufd::EnvelopeBuilder(cfg).build_streamed(
+        streamed_stage, stream, {}, &streamed, &bounds);
+
+    EXPECT_EQ(path, "/Envelope");
+    EXPECT_EQ(streamed.mesh_count, meshes.size());
+    EXPECT_EQ(streamed.face_count, collected.face_count);
+    // Unions are minimums, so batching does not change the SDF
+    EXPECT_EQ(streamed.envelope_face_count, collected.envelope_face_count);
+    EXPECT_EQ(surface_bbox(streamed_stage), surface_bbox(collected_stage));
+    EXPECT_EQ(bounds, ufd::SurfaceExtractor().compute_world_bounds(meshes));
+}
+
+TEST(EnvelopeBuilderTest, StreamedBuildOfEmptyStageReturnsEmptyPath) {
+    auto scene = pxr::UsdStage::CreateInMemory();
+    ufd::MeshStream stream(scene);
+    ufd::EnvelopeStats stats;
+    EXPECT_EQ(ufd::EnvelopeBuilder().build_streamed(
+                  pxr::UsdStage::CreateInMemory(), stream, {}, &stats), "");
+    EXPECT_EQ(stats.mesh_count, 0u);
+}
+
+// ---- Metrics ----
+
+TEST(EnvelopeBuilderTest, MetricsRecordPhasesAndGrids) {
+    auto scene = make_cube_grid_stage(2, 2, 1, 1.3);
+    const auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+    cfg.mode       = ufd::VoxelizeMode::PerMesh;
+    cfg.reuse_prototypes = false;
+
+    auto& metrics = ufd::Metrics::global();
+    metrics.reset();
+    metrics.set_enabled(true);
+    ufd::EnvelopeStats stats;
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(),
+                                    ufd::GeometryCache(meshes), {}, &stats);
+    metrics.set_enabled(false);
+
+    std::map<std::string, ufd::PhaseMetrics> phases;
+    for (const auto& p : metrics.phases()) phases[p.name] = p;
+    for (const char* name : {"extraction", "voxelization", "voxelize_mesh",
+                             "union", "closing", "meshing", "usd_authoring"}) {
+        ASSERT_TRUE(phases.count(name)) << name;
+        EXPECT_GT(phases[name].wall_seconds, 0.0) << name;
+    }
+    EXPECT_EQ(phases["voxelize_mesh"].count, meshes.size());
+    EXPECT_EQ(phases["union"].count, meshes.size() - 1);
+    EXPECT_LE(phases["voxelize_mesh"].wall_seconds,
+              phases["voxelization"].wall_seconds);
+
+    const auto grids = metrics.grids();
+    ASSERT_EQ(grids.size(), 2u);
+    EXPECT_EQ(grids[0].name, "unioned");
+    EXPECT_EQ(grids[1].name, "closed");
+    EXPECT_EQ(grids[1].active_voxels, stats.active_voxel_count);
+    EXPECT_EQ(grids[1].mem_bytes, stats.sdf_bytes);
+    EXPECT_GT(grids[1].leaf_count, 0u);
+    metrics.reset();
+}
+
+TEST(EnvelopeBuilderTest, DisabledMetricsRecordNothing) {
+    auto scene = make_cube_grid_stage(2, 1, 1, 1.3);
+    auto& metrics = ufd::Metrics::global();
+    metrics.reset();
+    ufd::EnvelopeBuilder().build(pxr::UsdStage::CreateInMemory(),
+                                 stage_meshes(scene));
+    EXPECT_TRUE(metrics.phases().empty());
+    EXPECT_TRUE(metrics.grids().empty());
+}
+
+// ---- Tiled builds ----
+
+// Helper: number of /Envelope edges used by a single polygon
+static size_t open_edge_count(UsdStageRefPtr stage) {
+    VtIntArray counts, indices;
+    envelope_mesh(stage).GetFaceVertexCountsAttr().Get(&counts);
+    envelope_mesh(stage).GetFaceVertexIndicesAttr().Get(&indices);
+
+    std::map<std::pair<int, int>, int> uses;
+    size_t cursor = 0;
+    for (int n : counts) {
+        for (int c = 0; c < n; ++c) {
+            const int a = indices[cursor + c];
+            const int b = indices[cursor + (c + 1) % n];
+            ++uses[{std::min(a, b), std::max(a, b)}];
+        }
+        cursor += n;
+    }
+    size_t open = 0;
+    for (const auto& [edge, n] : uses)
+        if (n == 1) ++open;
+    return open;
+}
+
+TEST(EnvelopeBuilderTest, TiledBuildMatchesSingleBuild) {
+    auto scene  = make_cube_grid_stage(3, 2, 1, 1.3);
+    const ufd::GeometryCache geometry(stage_meshes(scene));
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+
+    auto single = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats single_stats;
+    ufd::EnvelopeBuilder(cfg).build(single, geometry, {}, &single_stats);
+
+    ufd::TileConfig tiles;
+    tiles.brick_size = 1.6;
+    tiles.spill_dir  = fresh_temp_dir("tiled_matches_single");
+    auto tiled = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats tiled_stats;
+    auto path = ufd::EnvelopeBuilder(cfg).build_tiled(tiled, geometry, tiles,
+                                                      &tiled_stats);
+    ASSERT_EQ(path, "/Envelope");
+
+    EXPECT_GT(tiled_stats.brick_count, 1u);
+    EXPECT_NEAR(double(tiled_stats.envelope_face_count),
+                double(single_stats.envelope_face_count),
+                0.01 * single_stats.envelope_face_count);
+
+    auto single_bb = surface_bbox(single);
+    auto tiled_bb  = surface_bbox(tiled);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(single_bb.GetMin()[a], tiled_bb.GetMin()[a], cfg.voxel_size);
+        EXPECT_NEAR(single_bb.GetMax()[a], tiled_bb.GetMax()[a], cfg.voxel_size);
+    }
+}
+
+// Helper: one mesh prim holding a row of n disjoint unit cubes along x,
+// pitch apart
+static UsdStageRefPtr make_merged_cube_row_stage(int n, double pitch) {
+    auto stage = pxr::UsdStage::CreateInMemory();
+    VtVec3fArray points;
+    VtIntArray   counts, indices;
+    const GfVec3f corners[8] = {
+        GfVec3f(0, 0, 0), GfVec3f(1, 0, 0), GfVec3f(1, 1, 0), GfVec3f(0, 1, 0),
+        GfVec3f(0, 0, 1), GfVec3f(1, 0, 1), GfVec3f(1, 1, 1), GfVec3f(0, 1, 1),
+    };
+    const int faces[6][4] = {{0, 3, 2, 1}, {4, 5, 6, 7}, {0, 1, 5, 4},
+                             {3, 7, 6, 2}, {0, 4, 7, 3}, {1, 2, 6, 5}};
+    for (int c = 0; c < n; ++c) {
+        const int base = static_cast<int>(points.size());
+        const GfVec3f offset(static_cast<float>(c * pitch), 0, 0);
+        for (const auto& corner : corners) points.push_back(corner + offset);
+        for (const auto& face : faces) {
+            counts.push_back(4);
+            for (int v : face) indices.push_back(base + v);
+        }
+    }
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath("/Scene/row"));
+    mesh.GetPointsAttr().Set(points);
+    mesh.GetFaceVertexCountsAttr().Set(counts);
+    mesh.GetFaceVertexIndicesAttr().Set(indices);
+    return stage;
+}
+
+TEST(EnvelopeBuilderTest, TiledBuildSplitsMeshIntoShells) {
+    auto scene = make_merged_cube_row_stage(5, 1.3);
+    const ufd::GeometryCache geometry(stage_meshes(scene));
+    ASSERT_EQ(geometry.size(), 1u);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+
+    auto single = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats single_stats;
+    ufd::EnvelopeBuilder(cfg).build(single, geometry, {}, &single_stats);
+
+    // The row is wider than a brick, so each brick voxelizes only the cubes
+    // that reach it
+    ufd::TileConfig tiles;
+    tiles.brick_size = 1.6;
+    tiles.spill_dir  = fresh_temp_dir("tiled_shells");
+    auto tiled = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats tiled_stats;
+    ufd::EnvelopeBuilder(cfg).build_tiled(tiled, geometry, tiles, &tiled_stats);
+
+    EXPECT_GT(tiled_stats.brick_count, 1u);
+    EXPECT_NEAR(double(tiled_stats.envelope_face_count),
+                double(single_stats.envelope_face_count),
+                0.01 * single_stats.envelope_face_count);
+    EXPECT_EQ(open_edge_count(tiled), 0u);
+}
+
+TEST(EnvelopeBuilderTest, TiledEnvelopeIsWatertight) {
+    auto scene  = make_cube_grid_stage(2, 2, 2, 1.3);
+    const ufd::GeometryCache geometry(stage_meshes(scene));
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+
+    ufd::TileConfig tiles;
+    tiles.brick_size = 0.8;
+    tiles.spill_dir  = fresh_temp_dir("tiled_watertight");
+    auto stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats stats;
+    ufd::EnvelopeBuilder(cfg).build_tiled(stage, geometry, tiles, &stats);
+
+    EXPECT_GT(stats.brick_count, 8u);
+    EXPECT_EQ(open_edge_count(stage), 0u);
+}
+
+TEST(EnvelopeBuilderTest, MemoryBudgetBoundsBrickSize) {
+    auto scene  = make_cube_grid_stage(3, 1, 1, 1.3);
+    const ufd::GeometryCache geometry(stage_meshes(scene));
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.05;
+
+    ufd::TileConfig tiles;
+    tiles.spill_dir = fresh_temp_dir("tiled_budget");
+    ufd::EnvelopeStats unbounded, bounded;
+    ufd::EnvelopeBuilder(cfg).build_tiled(pxr::UsdStage::CreateInMemory(),
+                                          geometry, tiles, &unbounded);
+    tiles.memory_budget = 8ull << 20;
+    tiles.spill_dir     = fresh_temp_dir("tiled_budget_8mb");
+    ufd::EnvelopeBuilder(cfg).build_tiled(pxr::UsdStage::CreateInMemory(),
+                                          geometry, tiles, &bounded);
+
+    EXPECT_EQ(unbounded.brick_count, 1u);
+    EXPECT_GT(bounded.brick_count, 1u);
+    EXPECT_LE(bounded.sdf_bytes, tiles.memory_budget);
+}
+
+TEST(EnvelopeBuilderTest, SplitBrickWorkersMatchSingleProcess) {
+    auto scene  = make_cube_grid_stage(3, 2, 1, 1.3);
+    const ufd::GeometryCache geometry(stage_meshes(scene));
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+    ufd::EnvelopeBuilder builder(cfg);
+
+    ufd::TileConfig tiles;
+    tiles.brick_size = 1.6;
+    tiles.spill_dir  = fresh_temp_dir("tiled_single_process");
+    ufd::EnvelopeStats whole;
+    builder.build_tiled(pxr::UsdStage::CreateInMemory(), geometry, tiles, &whole);
+
+    // Each worker gets only the meshes its plan says reach its bricks
+    tiles.spill_dir = fresh_temp_dir("tiled_split_workers");
+    const ufd::TilePlan plan = builder.plan_tiles(geometry, tiles);
+    for (size_t worker = 0; worker < 2; ++worker) {
+        std::vector<UsdGeomMesh> meshes;
+        for (size_t i : plan.worker_meshes(worker, 2))
+            meshes.push_back(geometry.meshes()[i]);
+        EXPECT_TRUE(builder.build_bricks(ufd::GeometryCache(meshes), plan,
+                                         tiles, worker, 2));
+    }
+    ufd::EnvelopeStats split;
+    auto path = builder.stitch_bricks(pxr::UsdStage::CreateInMemory(), plan,
+                                      tiles, &split);
+
+    EXPECT_EQ(path, "/Envelope");
+    EXPECT_EQ(split.brick_count, whole.brick_count);
+    EXPECT_EQ(split.envelope_face_count, whole.envelope_face_count);
+    EXPECT_EQ(split.face_count, whole.face_count);
+}
+
+TEST(EnvelopeBuilderTest, TilePlanGivesWorkersNearbyMeshes) {
+    // A column of cubes along z: the first worker's bricks are the bottom
+    // ones, the second's the top ones
+    auto scene  = make_cube_grid_stage(1, 1, 6, 1.3);
+    const ufd::GeometryCache geometry(stage_meshes(scene));
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.2;
+    ufd::TileConfig tiles;
+    tiles.brick_size = 1.6;
+    const ufd::TilePlan plan = ufd::EnvelopeBuilder(cfg).plan_tiles(geometry,
+                                                                    tiles);
+    ASSERT_GT(plan.brick_count(), 2u);
+
+    const auto bottom = plan.worker_meshes(0, 2);
+    const auto top    = plan.worker_meshes(1, 2);
+    EXPECT_LT(bottom.size(), geometry.size());
+    EXPECT_LT(top.size(), geometry.size());
+    EXPECT_EQ(plan.worker_bricks(0, 2).second, plan.worker_bricks(1, 2).first);
+    EXPECT_EQ(plan.worker_bricks(1, 2).second, plan.brick_count());
+
+    // Every mesh is needed by some worker
+    std::set<size_t> covered(bottom.begin(), bottom.end());
+    covered.insert(top.begin(), top.end());
+    EXPECT_EQ(covered.size(), geometry.size());
+
+    const std::string path = fresh_temp_dir("tile_plan") + "/plan.txt";
+    ASSERT_TRUE(plan.write(path));
+    ufd::TilePlan read;
+    ASSERT_TRUE(read.read(path));
+    EXPECT_EQ(read.voxel_size, plan.voxel_size);
+    EXPECT_EQ(read.brick_count(), plan.brick_count());
+    EXPECT_EQ(read.face_count, plan.face_count);
+    EXPECT_EQ(read.mesh_paths, plan.mesh_paths);
+    EXPECT_EQ(read.mesh_bricks, plan.mesh_bricks);
+}
+
+TEST(EnvelopeBuilderTest, StitchFailsOnMissingBrick) {
+    auto scene  = make_cube_grid_stage(3, 2, 1, 1.3);
+    const ufd::GeometryCache geometry(stage_meshes(scene));
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.1;
+    ufd::EnvelopeBuilder builder(cfg);
+
+    ufd::TileConfig tiles;
+    tiles.brick_size = 1.6;
+    tiles.spill_dir  = fresh_temp_dir("tiled_missing_brick");
+    // Only one of two workers ran
+    const ufd::TilePlan plan = builder.plan_tiles(geometry, tiles);
+    EXPECT_TRUE(builder.build_bricks(geometry, plan, tiles, 0, 2));
+    EXPECT_EQ(builder.stitch_bricks(pxr::UsdStage::CreateInMemory(), plan,
+                                    tiles), "");
+}
@@ -0,0 +1,183 @@
+#include "TestHelpers.h"
+
+#include <ufd/StageReader.h>
+#include <ufd/SurfaceExtractor.h>
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/EnvelopeEstimator.h>
+#include <ufd/GeometryCache.h>
+
+#include <pxr/usd/usd/stage.h>
+
+#include <gtest/gtest.h>
+
+static const std::string BOX_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box.usda";
+static const std::string BOX_X2_DISJOINT_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box_x2_disjoint.usda";
+static const std::string BOX_X2_INTERSECTED_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box_x2_intersected.usda";
+
+// Helper: estimator for the geometry the build will read
+static ufd::EnvelopeEstimator estimator_for(const ufd::GeometryCache& geometry) {
+    ufd::SurfaceExtractor ext;
+    return ufd::EnvelopeEstimator(ext.compute_surface_area(geometry),
+                                  ext.compute_bounding_box(geometry), geometry);
+}
+
+// Helper: build for real and check the predictions are within `ratio`
+static void expect_estimate_matches_build(const std::string& path,
+                                          const ufd::EnvelopeConfig& cfg,
+                                          double ratio = 2.0) {
+    ufd::StageReader reader;
+    reader.open(path);
+    const ufd::GeometryCache geometry(reader.collect_meshes());
+
+    const auto est = estimator_for(geometry).estimate(cfg);
+
+    ufd::EnvelopeStats stats;
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(),
+                                     geometry, {}, &stats);
+
+    const auto within = [ratio](double predicted, double actual) {
+        return predicted >= actual / ratio && predicted <= ratio * actual;
+    };
+    EXPECT_TRUE(within(est.active_voxels, stats.active_voxel_count))
+        << est.active_voxels << " predicted, " << stats.active_voxel_count
+        << " built";
+    EXPECT_TRUE(within(est.grid_bytes, stats.sdf_bytes))
+        << est.grid_bytes << " predicted, " << stats.sdf_bytes << " built";
+    EXPECT_TRUE(within(est.face_count, stats.envelope_face_count))
+        << est.face_count << " predicted, " << stats.envelope_face_count
+        << " built";
+    EXPECT_GE(est.peak_grid_bytes, est.grid_bytes);
+    EXPECT_GT(est.geometry_bytes, 0u);
+    EXPECT_GE(est.peak_bytes, est.peak_grid_bytes + est.geometry_bytes);
+}
+
+TEST(EnvelopeEstimatorTest, EmptyBoundsEstimateNothing) {
+    ufd::EnvelopeEstimator estimator(0.0, GfRange3d());
+    auto est = estimator.estimate(ufd::EnvelopeConfig{});
+
+    EXPECT_EQ(est.active_voxels, 0u);
+    EXPECT_EQ(est.peak_grid_bytes, 0u);
+    EXPECT_EQ(est.face_count, 0u);
+}
+
+TEST(EnvelopeEstimatorTest, FinerVoxelsCostMore) {
+    ufd::EnvelopeEstimator estimator(600.0,
+        GfRange3d(GfVec3d(0, 0, 0), GfVec3d(10, 10, 10)));
+    ufd::EnvelopeConfig cfg;
+
+    cfg.voxel_size = 0.5;
+    auto coarse = estimator.estimate(cfg);
+    cfg.voxel_size = 0.25;
+    auto fine = estimator.estimate(cfg);
+
+    EXPECT_GT(fine.active_voxels,      coarse.active_voxels);
+    EXPECT_GT(fine.peak_grid_bytes,    coarse.peak_grid_bytes);
+    EXPECT_GT(fine.dense_export_bytes, coarse.dense_export_bytes);
+    EXPECT_GT(fine.face_count,         coarse.face_count);
+}
+
+TEST(EnvelopeEstimatorTest, DenseExportSizeMatchesBandedBounds) {
+    ufd::EnvelopeEstimator estimator(600.0,
+        GfRange3d(GfVec3d(0, 0, 0), GfVec3d(10, 10, 10)));
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.5;
+    cfg.hole_threshold = 0.0;
+
+    // 20 voxels per edge, plus a 3-voxel band each side, plus one
+    const uint64_t n = 20 + 6 + 1;
+    EXPECT_EQ(estimator.estimate(cfg).dense_export_bytes,
+              32 + n * n * n * sizeof(float));
+}
+
+TEST(EnvelopeEstimatorTest, PredictionsMatchBoxBuild) {
+    // A single axis-aligned box is what the model is exact for, up to the
+    // band's rounded edges and the face constant's lean, so hold it closer
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.25;
+    expect_estimate_matches_build(BOX_USD, cfg, 1.5);
+
+    cfg.closing = ufd::ClosingMode::Topology;
+    expect_estimate_matches_build(BOX_USD, cfg, 1.5);
+}
+
+TEST(EnvelopeEstimatorTest, PredictionsMatchDisjointBoxesBuild) {
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.25;
+    expect_estimate_matches_build(BOX_X2_DISJOINT_USD, cfg);
+
+    cfg.closing = ufd::ClosingMode::Topology;
+    expect_estimate_matches_build(BOX_X2_DISJOINT_USD, cfg);
+}
+
+TEST(EnvelopeEstimatorTest, PredictionsMatchIntersectedBoxesBuild) {
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.25;
+    expect_estimate_matches_build(BOX_X2_INTERSECTED_USD, cfg);
+}
+
+TEST(EnvelopeEstimatorTest, FittedVoxelSizeRespectsBudget) {
+    ufd::EnvelopeEstimator estimator(600.0,
+        GfRange3d(GfVec3d(0, 0, 0), GfVec3d(10, 10, 10)));
+    ufd::EnvelopeConfig cfg;
+
+    const uint64_t small_budget = 16ull << 20;
+    const uint64_t large_budget = 256ull << 20;
+    const double small_vox = estimator.fit_voxel_size(cfg, small_budget);
+    const double large_vox = estimator.fit_voxel_size(cfg, large_budget);
+
+    EXPECT_LT(large_vox, small_vox);
+    cfg.voxel_size = small_vox;
+    EXPECT_LE(estimator.estimate(cfg).peak_bytes, small_budget);
+    // The finest fit: a noticeably finer voxel no longer fits
+    cfg.voxel_size = small_vox * 0.9;
+    EXPECT_GT(estimator.estimate(cfg).peak_bytes, small_budget);
+}
+
+TEST(EnvelopeEstimatorTest, InputGeometryCountsTowardPeak) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    const ufd::GeometryCache geometry(reader.collect_meshes());
+    ufd::SurfaceExtractor ext;
+    const double    area   = ext.compute_surface_area(geometry);
+    const GfRange3d bounds = ext.compute_bounding_box(geometry);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size = 0.25;
+    const auto grids_only = ufd::EnvelopeEstimator(area, bounds).estimate(cfg);
+    const auto with_input =
+        ufd::EnvelopeEstimator(area, bounds, geometry).estimate(cfg);
+
+    EXPECT_EQ(grids_only.geometry_bytes, 0u);
+    EXPECT_EQ(grids_only.peak_bytes, grids_only.peak_grid_bytes);
+    EXPECT_GT(with_input.geometry_bytes, 0u);
+    EXPECT_GE(with_input.peak_bytes,
+              grids_only.peak_bytes + with_input.geometry_bytes);
+}
+
+TEST(EnvelopeEstimatorTest, SoupAndParallelVoxelizationRaisePeak) {
+    // 64 small cubes: a soup copies every buffer and voxelizes the whole
+    // band in one call, and parallel PerMesh tasks hold several mesh grids
+    auto stage = pxr::UsdStage::CreateInMemory();
+    for (int i = 0; i < 64; ++i)
+        define_unit_cube(stage, "/Scene/part_" + std::to_string(i),
+                         GfVec3d(1.5 * (i % 4), 1.5 * (i / 4 % 4), 1.5 * (i / 16)));
+    const ufd::GeometryCache geometry(stage_meshes(stage));
+    const auto estimator = estimator_for(geometry);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.05;
+    cfg.hole_threshold = 0.0;
+    cfg.mode           = ufd::VoxelizeMode::PerMesh;
+    cfg.parallel       = false;
+    const auto serial = estimator.estimate(cfg);
+    cfg.parallel = true;
+    const auto parallel = estimator.estimate(cfg);
+    cfg.mode = ufd::VoxelizeMode::Soup;
+    const auto soup = estimator.estimate(cfg);
+
+    EXPECT_GE(parallel.peak_bytes, serial.peak_bytes);
+    EXPECT_GT(soup.peak_bytes, serial.peak_bytes + soup.geometry_bytes);
+}
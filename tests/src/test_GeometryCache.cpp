@@ -0,0 +1,105 @@
+#include <ufd/StageReader.h>
+#include <ufd/SurfaceExtractor.h>
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/GeometryCache.h>
+
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/xform.h>
+#include <pxr/usd/sdf/path.h>
+
+#include <gtest/gtest.h>
+
+static const std::string BOX_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box.usda";
+static const std::string BOX_X2_DISJOINT_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box_x2_disjoint.usda";
+
+TEST(GeometryCacheTest, EmptyMeshListIsEmpty) {
+    ufd::GeometryCache geometry({});
+    EXPECT_TRUE(geometry.empty());
+    EXPECT_EQ(geometry.face_count(), 0u);
+}
+
+TEST(GeometryCacheTest, HoldsOneEntryPerMesh) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::GeometryCache geometry(meshes);
+    ASSERT_EQ(geometry.size(), meshes.size());
+    EXPECT_EQ(geometry.world_xforms().size(), meshes.size());
+    EXPECT_EQ(geometry.geometry().size(), meshes.size());
+    for (size_t i = 0; i < meshes.size(); ++i)
+        EXPECT_EQ(geometry.meshes()[i].GetPath(), meshes[i].GetPath());
+}
+
+TEST(GeometryCacheTest, PointsMatchExtractedWorldSpacePoints) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::GeometryCache geometry(meshes);
+    auto surface = ufd::SurfaceExtractor().extract(meshes);
+
+    size_t k = 0;
+    for (const auto& geom : geometry.geometry()) {
+        for (const auto& p : geom.points) {
+            ASSERT_LT(k, surface.points.size());
+            EXPECT_EQ(GfVec3f(p[0], p[1], p[2]), surface.points[k++]);
+        }
+    }
+    EXPECT_EQ(k, surface.points.size());
+}
+
+TEST(GeometryCacheTest, TriangulatesNGonsAndKeepsQuads) {
+    auto stage = pxr::UsdStage::CreateInMemory();
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath("/mesh"));
+    mesh.GetPointsAttr().Set(VtVec3fArray{
+        GfVec3f(0, 0, 0), GfVec3f(1, 0, 0), GfVec3f(2, 1, 0),
+        GfVec3f(1, 2, 0), GfVec3f(0, 1, 0), GfVec3f(0, 0, 1)});
+    // A pentagon, a quad and a triangle
+    mesh.GetFaceVertexCountsAttr().Set(VtIntArray{5, 4, 3});
+    mesh.GetFaceVertexIndicesAttr().Set(VtIntArray{
+        0, 1, 2, 3, 4,  0, 1, 5, 4,  1, 2, 5});
+
+    ufd::GeometryCache geometry({mesh});
+    const auto& geom = geometry.geometry()[0];
+    EXPECT_EQ(geom.quads.size(), 1u);
+    EXPECT_EQ(geom.triangles.size(), 3u + 1u);
+    EXPECT_EQ(geometry.face_count(), 5u);
+}
+
+TEST(GeometryCacheTest, AppliesWorldTransforms) {
+    auto stage = pxr::UsdStage::CreateInMemory();
+    auto xf = UsdGeomXform::Define(stage, SdfPath("/Part"));
+    xf.AddTranslateOp().Set(GfVec3d(5, 0, 0));
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath("/Part/mesh"));
+    mesh.GetPointsAttr().Set(VtVec3fArray{
+        GfVec3f(0, 0, 0), GfVec3f(1, 0, 0), GfVec3f(0, 1, 0)});
+    mesh.GetFaceVertexCountsAttr().Set(VtIntArray{3});
+    mesh.GetFaceVertexIndicesAttr().Set(VtIntArray{0, 1, 2});
+
+    ufd::GeometryCache geometry({mesh});
+    EXPECT_EQ(geometry.geometry()[0].points[1], openvdb::Vec3s(6, 0, 0));
+}
+
+TEST(GeometryCacheTest, EnvelopeFromCacheMatchesEnvelopeFromMeshes) {
+    ufd::StageReader reader;
+    reader.open(BOX_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 1.0;
+    cfg.hole_threshold = 0.0;
+
+    ufd::EnvelopeStats from_meshes, from_cache;
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(), meshes,
+                                    {}, &from_meshes);
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(),
+                                    ufd::GeometryCache(meshes), {}, &from_cache);
+
+    EXPECT_EQ(from_cache.face_count,          from_meshes.face_count);
+    EXPECT_EQ(from_cache.envelope_face_count, from_meshes.envelope_face_count);
+    EXPECT_EQ(from_cache.active_voxel_count,  from_meshes.active_voxel_count);
+}
@@ -0,0 +1,93 @@
+#include "TestHelpers.h"
+
+#include <ufd/MeshGather.h>
+
+#include <gtest/gtest.h>
+
+// Helper: the former one-element-at-a-time gather, as a reference
+static ufd::SurfaceData serial_gather(const openvdb::tools::VolumeToMesh& mesher) {
+    ufd::SurfaceData surface;
+    const auto& pts = mesher.pointList();
+    for (size_t i = 0; i < mesher.pointListSize(); ++i)
+        surface.points.push_back(GfVec3f(pts[i][0], pts[i][1], pts[i][2]));
+
+    const auto& pools = mesher.polygonPoolList();
+    for (size_t pi = 0; pi < mesher.polygonPoolListSize(); ++pi) {
+        const auto& pool = pools[pi];
+        for (size_t qi = 0; qi < pool.numQuads(); ++qi) {
+            const openvdb::Vec4I& q = pool.quad(qi);
+            surface.face_vertex_counts.push_back(4);
+            for (int c = 3; c >= 0; --c)
+                surface.face_vertex_indices.push_back(static_cast<int>(q[c]));
+        }
+        for (size_t ti = 0; ti < pool.numTriangles(); ++ti) {
+            const openvdb::Vec3I& t = pool.triangle(ti);
+            surface.face_vertex_counts.push_back(3);
+            for (int c = 2; c >= 0; --c)
+                surface.face_vertex_indices.push_back(static_cast<int>(t[c]));
+        }
+    }
+    return surface;
+}
+
+TEST(MeshGatherTest, EmptyMesherGathersNothing) {
+    openvdb::tools::VolumeToMesh mesher(0.0);
+    auto surface = ufd::gather_mesh(mesher);
+
+    EXPECT_TRUE(surface.points.empty());
+    EXPECT_TRUE(surface.face_vertex_counts.empty());
+    EXPECT_TRUE(surface.face_vertex_indices.empty());
+}
+
+TEST(MeshGatherTest, MatchesSerialGather) {
+    openvdb::tools::VolumeToMesh mesher(0.0, 0.0);
+    mesher(*make_sphere(20.0f));
+
+    auto expected = serial_gather(mesher);
+    auto surface  = ufd::gather_mesh(mesher);
+
+    EXPECT_EQ(surface.points, expected.points);
+    EXPECT_EQ(surface.face_vertex_counts, expected.face_vertex_counts);
+    EXPECT_EQ(surface.face_vertex_indices, expected.face_vertex_indices);
+}
+
+TEST(MeshGatherTest, MatchesSerialGatherWithTriangles) {
+    // Adaptive meshing mixes quads and triangles within pools
+    openvdb::tools::VolumeToMesh mesher(0.0, 0.5);
+    mesher(*make_sphere(20.0f));
+
+    auto expected = serial_gather(mesher);
+    auto surface  = ufd::gather_mesh(mesher);
+
+    EXPECT_EQ(surface.face_vertex_counts, expected.face_vertex_counts);
+    EXPECT_EQ(surface.face_vertex_indices, expected.face_vertex_indices);
+}
+
+TEST(MeshGatherTest, KeepsWindingWhenNotFlipped) {
+    openvdb::tools::VolumeToMesh mesher(0.0, 0.0);
+    mesher(*make_sphere(5.0f));
+
+    auto flipped = ufd::gather_mesh(mesher);
+    auto kept    = ufd::gather_mesh(mesher, false);
+
+    ASSERT_EQ(flipped.face_vertex_counts, kept.face_vertex_counts);
+    size_t cursor = 0;
+    for (int count : kept.face_vertex_counts) {
+        for (int c = 0; c < count; ++c) {
+            EXPECT_EQ(kept.face_vertex_indices[cursor + c],
+                      flipped.face_vertex_indices[cursor + count - 1 - c]);
+        }
+        cursor += count;
+    }
+}
+
+TEST(MeshGatherTest, MatchesSerialGatherOnLargeMesh) {
+    // Enough polygon pools that the parallel gather splits the work
+    openvdb::tools::VolumeToMesh mesher(0.0, 0.0);
+    mesher(*make_sphere(400.0f));
+
+    auto expected = serial_gather(mesher);
+    auto surface  = ufd::gather_mesh(mesher);
+
+    EXPECT_EQ(surface.face_vertex_indices, expected.face_vertex_indices);
+}
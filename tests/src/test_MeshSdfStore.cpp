@@ -0,0 +1,262 @@
+#include "TestHelpers.h"
+
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/MeshSdfStore.h>
+
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/xform.h>
+#include <pxr/usd/sdf/path.h>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <vector>
+
+// Helper: in-memory stage with a row of n unit cubes 0.3 apart, each under
+// a translated Xform /Scene/part_<i>
+static UsdStageRefPtr make_cube_row_stage(int n) {
+    auto stage = pxr::UsdStage::CreateInMemory();
+    for (int i = 0; i < n; ++i)
+        define_unit_cube(stage, "/Scene/part_" + std::to_string(i),
+                         GfVec3d(i * 1.3, 0, 0));
+    return stage;
+}
+
+// Helper: move part i of a cube-row stage
+static void move_part(UsdStageRefPtr stage, int i, const GfVec3d& translate) {
+    UsdGeomXform xf(stage->GetPrimAtPath(
+        SdfPath("/Scene/part_" + std::to_string(i))));
+    bool reset = false;
+    xf.GetOrderedXformOps(&reset)[0].Set(translate);
+}
+
+// Helper: give part i of a cube-row stage no faces, or the unit cube's back
+static void set_part_faces(UsdStageRefPtr stage, int i, bool faces) {
+    UsdGeomMesh mesh(stage->GetPrimAtPath(
+        SdfPath("/Scene/part_" + std::to_string(i) + "/mesh")));
+    if (faces) {
+        mesh.GetFaceVertexCountsAttr().Set(VtIntArray{4, 4, 4, 4, 4, 4});
+        mesh.GetFaceVertexIndicesAttr().Set(VtIntArray{
+            0, 3, 2, 1,  4, 5, 6, 7,  0, 1, 5, 4,
+            3, 7, 6, 2,  0, 4, 7, 3,  1, 2, 6, 5,
+        });
+    } else {
+        mesh.GetFaceVertexCountsAttr().Set(VtIntArray());
+        mesh.GetFaceVertexIndicesAttr().Set(VtIntArray());
+    }
+}
+
+// Helper: face count and bbox of the /Envelope mesh
+static size_t envelope_faces(UsdStageRefPtr stage) {
+    VtIntArray counts;
+    UsdGeomMesh(stage->GetPrimAtPath(SdfPath("/Envelope")))
+        .GetFaceVertexCountsAttr().Get(&counts);
+    return counts.size();
+}
+
+static GfRange3d envelope_bbox(UsdStageRefPtr stage) {
+    VtVec3fArray pts;
+    UsdGeomMesh(stage->GetPrimAtPath(SdfPath("/Envelope")))
+        .GetPointsAttr().Get(&pts);
+    GfRange3d bbox;
+    for (const auto& p : pts) bbox.UnionWith(GfVec3d(p[0], p[1], p[2]));
+    return bbox;
+}
+
+TEST(MeshSdfStoreTest, FindOfUnknownPathIsMiss) {
+    ufd::MeshSdfStore store;
+
+    EXPECT_FALSE(store.find("/a", 1));
+    EXPECT_FALSE(store.last_build().closed);
+}
+
+TEST(MeshSdfStoreTest, FindRequiresMatchingKey) {
+    ufd::MeshSdfStore store;
+    auto sphere = make_sphere(2.0f, 0.5f);
+
+    store.put("/a", 1, sphere);
+
+    EXPECT_EQ(store.find("/a", 1), sphere);
+    EXPECT_FALSE(store.find("/a", 2));
+    EXPECT_EQ(store.size(), 1u);
+
+    store.erase("/a");
+    EXPECT_FALSE(store.find("/a", 1));
+}
+
+TEST(MeshSdfStoreTest, DirectoryPersistsAcrossInstances) {
+    const auto dir = fresh_temp_dir("mesh_store_persist");
+    auto sphere = make_sphere(2.0f, 0.5f);
+    {
+        ufd::MeshSdfStore store(dir);
+        store.put("/World/part", 7, sphere);
+
+        ufd::MeshSdfStore::Build build;
+        build.settings_key = 3;
+        build.mesh_keys["/World/part"] = 7;
+        build.closed = sphere;
+        store.set_last_build(build);
+    }
+
+    ufd::MeshSdfStore store(dir);
+    auto loaded = store.find("/World/part", 7);
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->activeVoxelCount(), sphere->activeVoxelCount());
+    EXPECT_FALSE(store.find("/World/part", 8));
+
+    auto build = store.last_build();
+    ASSERT_TRUE(build.closed);
+    EXPECT_EQ(build.settings_key, 3u);
+    ASSERT_EQ(build.mesh_keys.size(), 1u);
+    EXPECT_EQ(build.mesh_keys.at("/World/part"), 7u);
+}
+
+TEST(MeshSdfStoreTest, UnchangedRebuildVoxelizesNothing) {
+    auto scene  = make_cube_row_stage(4);
+    auto meshes = stage_meshes(scene);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.4;
+    ufd::MeshSdfStore store;
+
+    ufd::EnvelopeStats first, second;
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(pxr::UsdStage::CreateInMemory(), meshes, {}, &first);
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(pxr::UsdStage::CreateInMemory(), meshes, {}, &second);
+
+    EXPECT_EQ(first.voxelized_count, 4u);
+    EXPECT_EQ(second.voxelized_count, 0u);
+    EXPECT_EQ(second.reused_mesh_count, 4u);
+    EXPECT_EQ(second.envelope_face_count, first.envelope_face_count);
+}
+
+TEST(MeshSdfStoreTest, IncrementalRebuildMatchesFullBuild) {
+    auto scene  = make_cube_row_stage(8);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.05;
+    cfg.hole_threshold = 0.4;
+    ufd::MeshSdfStore store;
+
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(pxr::UsdStage::CreateInMemory(), stage_meshes(scene));
+
+    // Lift the last cube: only it is re-voxelized, and only its
+    // neighbourhood is re-closed
+    move_part(scene, 7, GfVec3d(7 * 1.3, 0.5, 0));
+    auto meshes = stage_meshes(scene);
+
+    auto incremental_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats stats;
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(incremental_stage, meshes, {}, &stats);
+
+    auto full_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(full_stage, meshes);
+
+    EXPECT_EQ(stats.voxelized_count, 1u);
+    EXPECT_EQ(stats.reused_mesh_count, 7u);
+
+    const double full_faces = envelope_faces(full_stage);
+    EXPECT_NEAR(envelope_faces(incremental_stage), full_faces, 0.01 * full_faces);
+    auto incremental_bb = envelope_bbox(incremental_stage);
+    auto full_bb        = envelope_bbox(full_stage);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(incremental_bb.GetMin()[a], full_bb.GetMin()[a], cfg.voxel_size);
+        EXPECT_NEAR(incremental_bb.GetMax()[a], full_bb.GetMax()[a], cfg.voxel_size);
+    }
+}
+
+TEST(MeshSdfStoreTest, RemovedMeshIsCutFromEnvelope) {
+    auto scene = make_cube_row_stage(4);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.4;
+    ufd::MeshSdfStore store;
+
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(pxr::UsdStage::CreateInMemory(), stage_meshes(scene));
+
+    scene->RemovePrim(SdfPath("/Scene/part_3"));
+    auto meshes = stage_meshes(scene);
+    auto stage  = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg, nullptr, &store).build(stage, meshes);
+
+    // Three cubes span x in [0, 3.6]
+    EXPECT_NEAR(envelope_bbox(stage).GetMax()[0], 3.6, 2 * cfg.voxel_size);
+    EXPECT_EQ(store.size(), 3u);
+}
+
+TEST(MeshSdfStoreTest, RebuildAfterEmptyEnvelopeMatchesFullBuild) {
+    auto scene = make_cube_row_stage(2);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.4;
+    ufd::MeshSdfStore store;
+
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(pxr::UsdStage::CreateInMemory(), stage_meshes(scene));
+
+    // Both cubes lose their faces: the envelope is empty, but their new
+    // (empty) SDFs are already stored
+    set_part_faces(scene, 0, false);
+    set_part_faces(scene, 1, false);
+    EXPECT_EQ(ufd::EnvelopeBuilder(cfg, nullptr, &store)
+                  .build(pxr::UsdStage::CreateInMemory(), stage_meshes(scene)),
+              "");
+
+    // The second cube comes back; the first must not reappear from the
+    // envelope before the empty build
+    set_part_faces(scene, 1, true);
+    auto meshes = stage_meshes(scene);
+    auto incremental_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg, nullptr, &store).build(incremental_stage, meshes);
+
+    auto full_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeBuilder(cfg).build(full_stage, meshes);
+
+    EXPECT_EQ(envelope_faces(incremental_stage), envelope_faces(full_stage));
+    auto incremental_bb = envelope_bbox(incremental_stage);
+    auto full_bb        = envelope_bbox(full_stage);
+    for (int a = 0; a < 3; ++a) {
+        EXPECT_NEAR(incremental_bb.GetMin()[a], full_bb.GetMin()[a], cfg.voxel_size);
+        EXPECT_NEAR(incremental_bb.GetMax()[a], full_bb.GetMax()[a], cfg.voxel_size);
+    }
+    // The second cube alone spans x in [1.3, 2.3]
+    EXPECT_GT(incremental_bb.GetMin()[0], 1.0);
+}
+
+TEST(MeshSdfStoreTest, StoredMeshMissingFromLastBuildIsSpliced) {
+    auto scene = make_cube_row_stage(4);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.1;
+    cfg.hole_threshold = 0.4;
+    ufd::MeshSdfStore store;
+
+    // A build of three cubes, then one of all four whose record is lost,
+    // as if the process died between storing the SDFs and the build
+    auto meshes = stage_meshes(scene);
+    const std::vector<UsdGeomMesh> first_three(meshes.begin(), meshes.begin() + 3);
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(pxr::UsdStage::CreateInMemory(), first_three);
+    const auto three = store.last_build();
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(pxr::UsdStage::CreateInMemory(), meshes);
+    store.set_last_build(three);
+
+    auto incremental_stage = pxr::UsdStage::CreateInMemory();
+    ufd::EnvelopeStats stats;
+    ufd::EnvelopeBuilder(cfg, nullptr, &store)
+        .build(incremental_stage, meshes, {}, &stats);
+
+    EXPECT_EQ(stats.voxelized_count, 0u);
+    // Four cubes span x in [0, 4.9]
+    EXPECT_NEAR(envelope_bbox(incremental_stage).GetMax()[0], 4.9,
+                2 * cfg.voxel_size);
+}
@@ -0,0 +1,178 @@
+#include <ufd/Metrics.h>
+
+#include <openvdb/openvdb.h>
+#include <openvdb/tools/LevelSetSphere.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void sleep_ms(int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+} // namespace
+
+TEST(MetricsTest, DisabledRecordsNothing) {
+    ufd::Metrics metrics;
+    {
+        ufd::ScopedPhase phase(metrics, "closing");
+    }
+    metrics.set_value("mesh_count", 3);
+    EXPECT_TRUE(metrics.phases().empty());
+    EXPECT_NE(metrics.to_json().find("\"values\": {}"), std::string::npos);
+}
+
+TEST(MetricsTest, PhaseCountsEntriesAndTime) {
+    ufd::Metrics metrics;
+    metrics.set_enabled(true);
+    for (int i = 0; i < 2; ++i) {
+        ufd::ScopedPhase phase(metrics, "closing");
+        sleep_ms(20);
+    }
+    {
+        ufd::ScopedPhase phase(metrics, "meshing");
+    }
+
+    const auto phases = metrics.phases();
+    ASSERT_EQ(phases.size(), 2u);
+    EXPECT_EQ(phases[0].name, "closing");
+    EXPECT_EQ(phases[0].count, 2u);
+    EXPECT_GE(phases[0].wall_seconds, 0.04);
+    EXPECT_GE(phases[0].busy_seconds, 0.04);
+    EXPECT_GE(phases[0].max_seconds, 0.02);
+    EXPECT_GE(phases[0].cpu_seconds, 0.0);
+    EXPECT_GT(phases[0].rss_begin_bytes, 0u);
+    EXPECT_GT(phases[0].rss_end_bytes, 0u);
+    EXPECT_EQ(phases[1].name, "meshing");
+}
+
+TEST(MetricsTest, OverlappingEntriesCountWallOnce) {
+    ufd::Metrics metrics;
+    metrics.set_enabled(true);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            ufd::ScopedPhase phase(metrics, "voxelize_mesh");
+            sleep_ms(50);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    const auto phases = metrics.phases();
+    ASSERT_EQ(phases.size(), 1u);
+    EXPECT_EQ(phases[0].count, 4u);
+    EXPECT_GE(phases[0].busy_seconds, 0.2);
+    EXPECT_LT(phases[0].wall_seconds, phases[0].busy_seconds);
+}
+
+TEST(MetricsTest, NestedPhasesAreRecordedSeparately) {
+    ufd::Metrics metrics;
+    metrics.set_enabled(true);
+    {
+        ufd::ScopedPhase outer(metrics, "voxelization");
+        ufd::ScopedPhase inner(metrics, "union");
+        sleep_ms(10);
+    }
+    const auto phases = metrics.phases();
+    ASSERT_EQ(phases.size(), 2u);
+    EXPECT_EQ(phases[0].name, "voxelization");
+    EXPECT_EQ(phases[1].name, "union");
+    EXPECT_GE(phases[0].wall_seconds, phases[1].wall_seconds);
+}
+
+TEST(MetricsTest, PhaseAfterPeakReportsItsOwnRss) {
+    ufd::Metrics metrics;
+    metrics.set_enabled(true);
+    const size_t bytes = size_t(64) << 20;
+    {
+        std::unique_ptr<char[]> block(new char[bytes]);
+        std::memset(block.get(), 1, bytes);
+        ufd::ScopedPhase phase(metrics, "closing");
+    }
+    {
+        ufd::ScopedPhase phase(metrics, "meshing");
+    }
+    const auto phases = metrics.phases();
+    ASSERT_EQ(phases.size(), 2u);
+    // The block is freed before "meshing" opens, so its RSS is well below
+    // the process peak that "closing" reached
+    EXPECT_LT(phases[1].rss_end_bytes + bytes / 2, phases[0].rss_end_bytes);
+}
+
+TEST(MetricsTest, ResetDropsEverything) {
+    ufd::Metrics metrics;
+    metrics.set_enabled(true);
+    {
+        ufd::ScopedPhase phase(metrics, "closing");
+    }
+    metrics.set_value("mesh_count", 3);
+    metrics.reset();
+    EXPECT_TRUE(metrics.phases().empty());
+    EXPECT_TRUE(metrics.grids().empty());
+}
+
+TEST(MetricsTest, RecordsGridStatistics) {
+    openvdb::initialize();
+    auto sphere = openvdb::tools::createLevelSetSphere<openvdb::FloatGrid>(
+        1.0f, openvdb::Vec3f(0.0f), 0.1f);
+
+    ufd::Metrics metrics;
+    metrics.set_enabled(true);
+    metrics.record_grid("closed", *sphere);
+
+    const auto grids = metrics.grids();
+    ASSERT_EQ(grids.size(), 1u);
+    EXPECT_EQ(grids[0].name, "closed");
+    EXPECT_EQ(grids[0].active_voxels, sphere->activeVoxelCount());
+    EXPECT_EQ(grids[0].leaf_count, sphere->tree().leafCount());
+    EXPECT_EQ(grids[0].mem_bytes, sphere->memUsage());
+    EXPECT_NEAR(grids[0].voxel_size, 0.1, 1e-9);
+}
+
+TEST(MetricsTest, JsonHoldsPhasesGridsAndValues) {
+    ufd::Metrics metrics;
+    metrics.set_enabled(true);
+    {
+        ufd::ScopedPhase phase(metrics, "stage_open");
+    }
+    metrics.set_value("mesh_count", 3);
+    metrics.set_value("mesh_count", 4);
+    metrics.set_value("input", "C:\\scenes\\\"plant\".usda");
+
+    const std::string json = metrics.to_json();
+    EXPECT_NE(json.find("\"name\": \"stage_open\", \"count\": 1"),
+              std::string::npos);
+    EXPECT_NE(json.find("\"mesh_count\": 4"), std::string::npos);
+    EXPECT_EQ(json.find("\"mesh_count\": 3"), std::string::npos);
+    EXPECT_NE(json.find("\"input\": \"C:\\\\scenes\\\\\\\"plant\\\".usda\""),
+              std::string::npos);
+    EXPECT_NE(json.find("\"peak_rss_bytes\""), std::string::npos);
+    EXPECT_NE(json.find("\"rss_end_bytes\""), std::string::npos);
+}
+
+TEST(MetricsTest, WriteJsonWritesTheReport) {
+    ufd::Metrics metrics;
+    metrics.set_enabled(true);
+    metrics.set_value("voxel_size", 0.5);
+
+    const auto path = std::filesystem::temp_directory_path()
+                    / "ufd_metrics_test.json";
+    ASSERT_TRUE(metrics.write_json(path.string()));
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_NE(contents.str().find("\"voxel_size\": 0.5"), std::string::npos);
+    std::filesystem::remove(path);
+
+    EXPECT_FALSE(metrics.write_json("/nonexistent_dir/metrics.json"));
+}
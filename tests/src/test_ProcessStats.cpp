@@ -0,0 +1,45 @@
+#include <ufd/ProcessStats.h>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+TEST(ProcessStatsTest, CurrentRssIsNonZero) {
+    EXPECT_GT(ufd::current_rss_bytes(), 0u);
+}
+
+TEST(ProcessStatsTest, PeakRssIsNonZero) {
+    EXPECT_GT(ufd::peak_rss_bytes(), 0u);
+}
+
+TEST(ProcessStatsTest, TouchedAllocationRaisesRss) {
+    const size_t bytes = size_t(64) << 20;
+    const uint64_t before = ufd::current_rss_bytes();
+    std::unique_ptr<char[]> block(new char[bytes]);
+    std::memset(block.get(), 1, bytes);
+    const uint64_t after = ufd::current_rss_bytes();
+    EXPECT_GE(after, before + bytes / 2);
+    // The kernel's counters are synced lazily; compare with some slack
+    EXPECT_GE(ufd::peak_rss_bytes(), before + bytes / 2);
+    EXPECT_EQ(block[bytes - 1], 1);
+}
+
+TEST(ProcessStatsTest, BusyLoopAdvancesCpuTime) {
+    const double before = ufd::process_cpu_seconds();
+    volatile double sink = 0.0;
+    while (ufd::process_cpu_seconds() - before < 0.05) {
+        for (int i = 0; i < 100000; ++i) sink = sink + i;
+    }
+    EXPECT_GE(ufd::process_cpu_seconds(), before + 0.05);
+}
+
+TEST(ProcessStatsTest, TempPathsAreUniqueAndNamePid) {
+    const std::string a = ufd::unique_temp_path("/tmp/x.vdb");
+    const std::string b = ufd::unique_temp_path("/tmp/x.vdb");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a.rfind("/tmp/x.vdb.tmp." + std::to_string(getpid()) + ".", 0), 0u);
+}
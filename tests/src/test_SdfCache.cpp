@@ -0,0 +1,121 @@
+#include "TestHelpers.h"
+
+#include <ufd/StageReader.h>
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/SdfCache.h>
+
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/sdf/path.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+
+static const std::string BOX_X2_DISJOINT_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box_x2_disjoint.usda";
+
+TEST(SdfCacheTest, LoadOfUnknownKeyIsMiss) {
+    ufd::SdfCache cache(fresh_temp_dir("cache_miss"));
+
+    EXPECT_FALSE(cache.load(42));
+    EXPECT_EQ(cache.stats().misses, 1);
+    EXPECT_EQ(cache.stats().hits, 0);
+}
+
+TEST(SdfCacheTest, StoreThenLoadRoundTrips) {
+    ufd::SdfCache cache(fresh_temp_dir("cache_roundtrip"));
+    auto sphere = make_sphere(5.0f, 0.5f);
+
+    cache.store(7, sphere);
+    auto loaded = cache.load(7);
+
+    ASSERT_TRUE(loaded);
+    EXPECT_EQ(loaded->activeVoxelCount(), sphere->activeVoxelCount());
+    EXPECT_FLOAT_EQ(loaded->background(), sphere->background());
+    EXPECT_EQ(cache.stats().hits, 1);
+    EXPECT_GT(cache.stats().bytes_saved, 0u);
+}
+
+TEST(SdfCacheTest, SizeCapEvictsLeastRecentlyUsed) {
+    const auto dir = fresh_temp_dir("cache_evict");
+    auto sphere = make_sphere(5.0f, 0.5f);
+
+    // Measure one entry, then cap the cache at two entries
+    uint64_t entry_bytes = 0;
+    {
+        ufd::SdfCache probe(dir);
+        probe.store(0, sphere);
+        entry_bytes = std::filesystem::file_size(probe.path_for(0));
+        std::filesystem::remove(probe.path_for(0));
+    }
+
+    ufd::SdfCache cache(dir, 2 * entry_bytes + entry_bytes / 2);
+    cache.store(1, sphere);
+    cache.store(2, sphere);
+    std::filesystem::last_write_time(
+        cache.path_for(1),
+        std::filesystem::last_write_time(cache.path_for(2))
+            - std::chrono::seconds(10));
+    cache.store(3, sphere);
+
+    EXPECT_FALSE(std::filesystem::exists(cache.path_for(1)));
+    EXPECT_TRUE(std::filesystem::exists(cache.path_for(2)));
+    EXPECT_TRUE(std::filesystem::exists(cache.path_for(3)));
+    EXPECT_EQ(cache.stats().evictions, 1);
+}
+
+TEST(SdfCacheTest, SecondBuildHitsCacheAndMatchesFirst) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.5;
+    cfg.hole_threshold = 1.0;
+
+    ufd::SdfCache cache(fresh_temp_dir("cache_build"));
+    ufd::EnvelopeBuilder builder(cfg, &cache);
+
+    ufd::EnvelopeStats first, second;
+    auto stage_a = pxr::UsdStage::CreateInMemory();
+    auto stage_b = pxr::UsdStage::CreateInMemory();
+    builder.build(stage_a, meshes, {}, &first);
+    builder.build(stage_b, meshes, {}, &second);
+
+    EXPECT_FALSE(first.cache_hit);
+    EXPECT_TRUE(second.cache_hit);
+    EXPECT_EQ(cache.stats().hits, 1);
+    EXPECT_EQ(cache.stats().misses, 1);
+
+    VtIntArray counts_a, counts_b;
+    UsdGeomMesh(stage_a->GetPrimAtPath(SdfPath("/Envelope")))
+        .GetFaceVertexCountsAttr().Get(&counts_a);
+    UsdGeomMesh(stage_b->GetPrimAtPath(SdfPath("/Envelope")))
+        .GetFaceVertexCountsAttr().Get(&counts_b);
+    EXPECT_FALSE(counts_b.empty());
+    EXPECT_EQ(counts_a.size(), counts_b.size());
+}
+
+TEST(SdfCacheTest, ChangedHoleThresholdMissesCache) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::SdfCache cache(fresh_temp_dir("cache_config"));
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.5;
+    cfg.hole_threshold = 0.0;
+    ufd::EnvelopeBuilder(cfg, &cache).build(
+        pxr::UsdStage::CreateInMemory(), meshes);
+
+    cfg.hole_threshold = 1.0;
+    ufd::EnvelopeStats stats;
+    ufd::EnvelopeBuilder(cfg, &cache).build(
+        pxr::UsdStage::CreateInMemory(), meshes, {}, &stats);
+
+    EXPECT_FALSE(stats.cache_hit);
+    EXPECT_EQ(cache.stats().misses, 2);
+}
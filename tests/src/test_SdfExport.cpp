@@ -0,0 +1,162 @@
+#include "TestHelpers.h"
+
+#include <ufd/StageReader.h>
+#include <ufd/EnvelopeBuilder.h>
+#include <ufd/SdfExport.h>
+
+#include <openvdb/tools/Dense.h>
+
+#include <pxr/usd/usd/stage.h>
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+static const std::string BOX_X2_DISJOINT_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box_x2_disjoint.usda";
+
+// Helper: output path in the system temp directory
+static std::string temp_path(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("ufd_" + name)).string();
+}
+
+TEST(SdfExportTest, DenseFileHasHeaderAndFullBox) {
+    auto sphere = make_sphere(10.0f);
+    const auto path = temp_path("dense.sdf");
+    ufd::write_sdf(*sphere, path, ufd::SdfFormat::Dense);
+
+    const auto dim = sphere->evalActiveVoxelBoundingBox().dim();
+    const uintmax_t expected = 32 + 4ull * dim.x() * dim.y() * dim.z();
+    EXPECT_EQ(std::filesystem::file_size(path), expected);
+}
+
+TEST(SdfExportTest, DenseFileValuesMatchDenseCopy) {
+    // Spans several x-slabs, so the streamed slabs must line up
+    auto sphere = make_sphere(20.0f);
+    const auto path = temp_path("dense_values.sdf");
+    ufd::write_sdf(*sphere, path, ufd::SdfFormat::Dense);
+
+    const auto bbox = sphere->evalActiveVoxelBoundingBox();
+    openvdb::tools::Dense<float, openvdb::tools::LayoutZYX> expected(bbox);
+    openvdb::tools::copyToDense(*sphere, expected);
+
+    std::ifstream in(path, std::ios::binary);
+    in.seekg(32);
+    std::vector<float> actual(expected.valueCount());
+    in.read(reinterpret_cast<char*>(actual.data()),
+            static_cast<std::streamsize>(actual.size() * sizeof(float)));
+    ASSERT_TRUE(in);
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_FLOAT_EQ(actual[i], expected.data()[i]) << "at index " << i;
+    }
+}
+
+TEST(SdfExportTest, NpyFileHasAlignedHeaderAndValues) {
+    auto sphere = make_sphere(20.0f);
+    const auto path = temp_path("sdf.npy");
+    ufd::write_sdf(*sphere, path, ufd::SdfFormat::Npy);
+
+    std::ifstream in(path, std::ios::binary);
+    char preamble[10];
+    in.read(preamble, sizeof(preamble));
+    ASSERT_TRUE(in);
+    EXPECT_EQ(std::string(preamble, 6), "\x93NUMPY");
+    EXPECT_EQ(preamble[6], 1);
+    const size_t header_len = static_cast<unsigned char>(preamble[8])
+                            | static_cast<unsigned char>(preamble[9]) << 8;
+    EXPECT_EQ((10 + header_len) % 64, 0u);
+
+    std::string dict(header_len, '\0');
+    in.read(&dict[0], static_cast<std::streamsize>(header_len));
+    const auto dim = sphere->evalActiveVoxelBoundingBox().dim();
+    const std::string shape = "(" + std::to_string(dim.x()) + ", "
+                            + std::to_string(dim.y()) + ", "
+                            + std::to_string(dim.z()) + ")";
+    EXPECT_NE(dict.find("'descr': '<f4'"), std::string::npos);
+    EXPECT_NE(dict.find("'fortran_order': False"), std::string::npos);
+    EXPECT_NE(dict.find(shape), std::string::npos);
+
+    const auto bbox = sphere->evalActiveVoxelBoundingBox();
+    openvdb::tools::Dense<float, openvdb::tools::LayoutZYX> expected(bbox);
+    openvdb::tools::copyToDense(*sphere, expected);
+
+    std::vector<float> actual(expected.valueCount());
+    in.read(reinterpret_cast<char*>(actual.data()),
+            static_cast<std::streamsize>(actual.size() * sizeof(float)));
+    ASSERT_TRUE(in);
+    EXPECT_EQ(in.peek(), std::char_traits<char>::eof());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_FLOAT_EQ(actual[i], expected.data()[i]) << "at index " << i;
+    }
+
+    EXPECT_TRUE(std::filesystem::exists(path + ".json"));
+}
+
+TEST(SdfExportTest, SparseRoundTripMatchesDenseCopy) {
+    auto sphere = make_sphere(10.0f);
+    const auto path = temp_path("roundtrip.ssdf");
+    ufd::write_sdf(*sphere, path, ufd::SdfFormat::Sparse);
+
+    auto sparse = ufd::read_sparse_sdf(path);
+    EXPECT_FLOAT_EQ(sparse.voxel_size, 1.0f);
+    EXPECT_FLOAT_EQ(sparse.background, sphere->background());
+    EXPECT_EQ(sparse.leaves.size(), sphere->tree().leafCount());
+
+    const auto bbox = sphere->evalActiveVoxelBoundingBox();
+    openvdb::tools::Dense<float, openvdb::tools::LayoutZYX> expected(bbox);
+    openvdb::tools::copyToDense(*sphere, expected);
+
+    const std::array<int32_t, 3> mn = {bbox.min().x(), bbox.min().y(), bbox.min().z()};
+    const std::array<int32_t, 3> mx = {bbox.max().x(), bbox.max().y(), bbox.max().z()};
+    EXPECT_EQ(sparse.bbox_min, mn);
+    EXPECT_EQ(sparse.bbox_max, mx);
+
+    const auto actual = sparse.dense(mn, mx);
+    ASSERT_EQ(actual.size(), expected.valueCount());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_FLOAT_EQ(actual[i], expected.data()[i]) << "at index " << i;
+    }
+}
+
+TEST(SdfExportTest, SparseSliceOfInteriorIsNegative) {
+    auto sphere = make_sphere(30.0f);
+    const auto path = temp_path("interior.ssdf");
+    ufd::write_sdf(*sphere, path, ufd::SdfFormat::Sparse);
+
+    // The sphere centre lies in an interior tile, not a stored leaf
+    auto slice = ufd::read_sparse_sdf(path).dense({0, 0, 0}, {0, 0, 0});
+    ASSERT_EQ(slice.size(), 1);
+    EXPECT_LT(slice[0], 0.0f);
+}
+
+TEST(SdfExportTest, SparseIsSmallerThanDense) {
+    auto sphere = make_sphere(100.0f);
+    const auto dense_path  = temp_path("size.sdf");
+    const auto sparse_path = temp_path("size.ssdf");
+    ufd::write_sdf(*sphere, dense_path,  ufd::SdfFormat::Dense);
+    ufd::write_sdf(*sphere, sparse_path, ufd::SdfFormat::Sparse);
+
+    const auto dense_bytes  = std::filesystem::file_size(dense_path);
+    const auto sparse_bytes = std::filesystem::file_size(sparse_path);
+    EXPECT_LT(sparse_bytes, dense_bytes);
+}
+
+TEST(SdfExportTest, EnvelopeBuilderWritesSparseSdf) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+
+    ufd::EnvelopeConfig cfg;
+    cfg.voxel_size     = 0.5;
+    cfg.hole_threshold = 0.0;
+    cfg.sdf_format     = ufd::SdfFormat::Sparse;
+
+    const auto path = temp_path("envelope.ssdf");
+    std::filesystem::remove(path);
+    ufd::EnvelopeBuilder(cfg).build(pxr::UsdStage::CreateInMemory(),
+                                    reader.collect_meshes(), path);
+
+    auto sparse = ufd::read_sparse_sdf(path);
+    EXPECT_FLOAT_EQ(sparse.voxel_size, 0.5f);
+    EXPECT_FALSE(sparse.leaves.empty());
+}
@@ -1,13 +1,36 @@
 #include <ufd/StageReader.h>
 
+#include <pxr/usd/usdGeom/tokens.h>
+
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 static const std::string BOX_USD =
     std::string(TEST_RESOURCES_DIR) + "/box.usda";
 static const std::string BOX_X2_DISJOINT_USD =
     std::string(TEST_RESOURCES_DIR) + "/box_x2_disjoint.usda";
 static const std::string BOX_X2_INTERSECTED_USD =
     std::string(TEST_RESOURCES_DIR) + "/box_x2_intersected.usda";
+static const std::string BOX_X3_INSTANCED_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box_x3_instanced.usda";
+static const std::string BOX_X2_PAYLOAD_USD =
+    std::string(TEST_RESOURCES_DIR) + "/box_x2_payload.usda";
+static const std::string PLANT_FILTERED_USD =
+    std::string(TEST_RESOURCES_DIR) + "/plant_filtered.usda";
+
+// Helper: paths of the meshes collect_meshes(filter) keeps in plant_filtered
+static std::vector<std::string> plant_mesh_paths(
+    const ufd::TraversalFilter& filter = {}) {
+    ufd::StageReader reader;
+    EXPECT_TRUE(reader.open(PLANT_FILTERED_USD));
+    std::vector<std::string> paths;
+    for (const auto& mesh : reader.collect_meshes(filter))
+        paths.push_back(mesh.GetPath().GetString());
+    return paths;
+}
 
 TEST(StageReaderTest, OpenInvalidPathReturnsFalse) {
     ufd::StageReader reader;
@@ -58,3 +81,222 @@ TEST(StageReaderTest, CollectMeshesFromIntersectedFindsTwoMeshes) {
     auto meshes = reader.collect_meshes();
     EXPECT_EQ(meshes.size(), 2);
 }
+
+TEST(StageReaderTest, CollectMeshesFromInstancedFindsInstanceProxies) {
+    ufd::StageReader reader;
+    reader.open(BOX_X3_INSTANCED_USD);
+    auto meshes = reader.collect_meshes();
+    ASSERT_EQ(meshes.size(), 3);
+    for (const auto& mesh : meshes)
+        EXPECT_TRUE(mesh.GetPrim().IsInstanceProxy());
+}
+
+// ---- Filters ----
+
+TEST(StageReaderTest, UnfilteredTraversalMatchesStageOrder) {
+    // Parts has enough children to be traversed in parallel
+    ufd::StageReader reader;
+    reader.open(PLANT_FILTERED_USD);
+    std::vector<std::string> expected;
+    for (const auto& prim : reader.get_stage()->Traverse()) {
+        if (prim.IsA<UsdGeomMesh>()) expected.push_back(prim.GetPath().GetString());
+    }
+    ASSERT_EQ(expected.size(), 15u);
+    EXPECT_EQ(plant_mesh_paths(), expected);
+}
+
+TEST(StageReaderTest, PurposeFilterSkipsGuidesAndProxies) {
+    ufd::TraversalFilter filter;
+    filter.purposes = {UsdGeomTokens->default_, UsdGeomTokens->render};
+    const auto paths = plant_mesh_paths(filter);
+    EXPECT_EQ(paths.size(), 13u);
+    for (const auto& path : paths) {
+        EXPECT_EQ(path.find("/Plant/Guide"), std::string::npos);
+        EXPECT_EQ(path.find("/Plant/Proxy"), std::string::npos);
+    }
+}
+
+TEST(StageReaderTest, VisibleOnlySkipsInvisibleSubtrees) {
+    ufd::TraversalFilter filter;
+    filter.visible_only = true;
+    const auto paths = plant_mesh_paths(filter);
+    EXPECT_EQ(paths.size(), 14u);
+    EXPECT_EQ(std::count(paths.begin(), paths.end(), "/Plant/Hidden/mesh"), 0);
+}
+
+TEST(StageReaderTest, ExcludePatternsPruneSubtrees) {
+    ufd::TraversalFilter filter;
+    filter.exclude = {"/Plant/Interior", "*/part_[0-4]"};
+    EXPECT_EQ(plant_mesh_paths(filter).size(), 9u);
+}
+
+TEST(StageReaderTest, IncludePatternsKeepMatchingSubtreesOnly) {
+    ufd::TraversalFilter filter;
+    filter.include = {"/Plant/Parts"};
+    const auto paths = plant_mesh_paths(filter);
+    ASSERT_EQ(paths.size(), 10u);
+    for (size_t i = 0; i < paths.size(); ++i)
+        EXPECT_EQ(paths[i], "/Plant/Parts/part_" + std::to_string(i) + "/mesh");
+}
+
+TEST(StageReaderTest, KindFiltersKeepAndSkipModels) {
+    ufd::TraversalFilter keep;
+    keep.kinds = {TfToken("component")};
+    EXPECT_EQ(plant_mesh_paths(keep),
+              std::vector<std::string>{"/Plant/Body/mesh"});
+
+    ufd::TraversalFilter skip;
+    skip.exclude_kinds = {TfToken("subcomponent")};
+    const auto paths = plant_mesh_paths(skip);
+    EXPECT_EQ(paths.size(), 14u);
+    EXPECT_EQ(std::count(paths.begin(), paths.end(), "/Plant/Interior/mesh"), 0);
+}
+
+TEST(StageReaderTest, FiltersKeepInstanceProxies) {
+    ufd::StageReader reader;
+    reader.open(BOX_X3_INSTANCED_USD);
+    ufd::TraversalFilter filter;
+    filter.purposes     = {UsdGeomTokens->default_};
+    filter.visible_only = true;
+    filter.exclude      = {"/Scene/box001"};
+    EXPECT_EQ(reader.collect_meshes(filter).size(), 2u);
+}
+
+// ---- Open options ----
+
+TEST(StageReaderTest, DefaultOpenLoadsAllPayloads) {
+    ufd::StageReader reader;
+    ufd::StageOpenStats stats;
+    ASSERT_TRUE(reader.open(BOX_X2_PAYLOAD_USD, {}, &stats));
+    EXPECT_EQ(reader.collect_meshes().size(), 2u);
+    EXPECT_GE(stats.seconds, 0.0);
+    EXPECT_FALSE(stats.cache_hit);
+}
+
+TEST(StageReaderTest, NoPayloadsLoadsNoGeometry) {
+    ufd::StageReader reader;
+    ufd::StageOpenOptions options;
+    options.load_payloads = false;
+    ASSERT_TRUE(reader.open(BOX_X2_PAYLOAD_USD, options));
+    EXPECT_TRUE(reader.collect_meshes().empty());
+    EXPECT_TRUE(reader.get_stage()->GetPrimAtPath(SdfPath("/Scene/A")));
+}
+
+TEST(StageReaderTest, RootsMaskPopulationAndLoadOnlyTheirPayloads) {
+    ufd::StageReader reader;
+    ufd::StageOpenOptions options;
+    options.roots = {SdfPath("/Scene/A")};
+    ASSERT_TRUE(reader.open(BOX_X2_PAYLOAD_USD, options));
+
+    auto stage = reader.get_stage();
+    EXPECT_FALSE(stage->GetPrimAtPath(SdfPath("/Scene/B")));
+    EXPECT_FALSE(stage->GetPrimAtPath(SdfPath("/Scene/Camera")));
+    EXPECT_TRUE(stage->GetPrimAtPath(SdfPath("/Scene/A")).IsLoaded());
+    EXPECT_EQ(reader.collect_meshes().size(), 1u);
+}
+
+TEST(StageReaderTest, RootInsideUnloadedPayloadIsLoaded) {
+    // /Scene/A/Cube only exists once A's payload is loaded
+    ufd::StageReader reader;
+    ufd::StageOpenOptions options;
+    options.roots = {SdfPath("/Scene/A/Cube")};
+    ASSERT_TRUE(reader.open(BOX_X2_PAYLOAD_USD, options));
+    auto meshes = reader.collect_meshes();
+    ASSERT_EQ(meshes.size(), 1u);
+    EXPECT_TRUE(meshes[0].GetPath().HasPrefix(SdfPath("/Scene/A/Cube")));
+}
+
+TEST(StageReaderTest, StageCacheReusesOpenedStage) {
+    ufd::StageOpenOptions options;
+    options.use_stage_cache = true;
+    options.roots = {SdfPath("/Scene/B")};
+
+    ufd::StageReader first, second;
+    ufd::StageOpenStats first_stats, second_stats;
+    ASSERT_TRUE(first.open(BOX_X2_PAYLOAD_USD, options, &first_stats));
+    ASSERT_TRUE(second.open(BOX_X2_PAYLOAD_USD, options, &second_stats));
+    EXPECT_EQ(first.get_stage(), second.get_stage());
+    EXPECT_TRUE(second_stats.cache_hit);
+    EXPECT_EQ(second.collect_meshes().size(), 1u);
+}
+
+TEST(StageReaderTest, CachedStageFollowsEachOpensPayloadOption) {
+    ufd::StageOpenOptions loaded;
+    loaded.use_stage_cache = true;
+    ufd::StageOpenOptions unloaded = loaded;
+    unloaded.load_payloads = false;
+
+    ufd::StageReader first, second, third;
+    ASSERT_TRUE(first.open(BOX_X2_PAYLOAD_USD, loaded));
+    EXPECT_EQ(first.collect_meshes().size(), 2u);
+
+    ufd::StageOpenStats stats;
+    ASSERT_TRUE(second.open(BOX_X2_PAYLOAD_USD, unloaded, &stats));
+    EXPECT_EQ(first.get_stage(), second.get_stage());
+    EXPECT_TRUE(stats.cache_hit);
+    EXPECT_TRUE(second.collect_meshes().empty());
+    EXPECT_FALSE(second.get_stage()->GetPrimAtPath(SdfPath("/Scene/A"))
+                     .IsLoaded());
+
+    ASSERT_TRUE(third.open(BOX_X2_PAYLOAD_USD, loaded));
+    EXPECT_EQ(third.collect_meshes().size(), 2u);
+}
+
+// ---- Streaming ----
+
+TEST(StageReaderTest, MeshStreamYieldsCollectedMeshesInOrder) {
+    ufd::StageReader reader;
+    reader.open(PLANT_FILTERED_USD);
+
+    ufd::TraversalFilter filter;
+    filter.purposes     = {UsdGeomTokens->default_};
+    filter.visible_only = true;
+    filter.exclude      = {"*/part_[2-3]"};
+
+    for (const auto& f : {ufd::TraversalFilter{}, filter}) {
+        std::vector<std::string> expected;
+        for (const auto& mesh : reader.collect_meshes(f))
+            expected.push_back(mesh.GetPath().GetString());
+
+        ufd::MeshStream stream(reader.get_stage(), f);
+        std::vector<std::string> streamed;
+        UsdGeomMesh mesh;
+        while (stream.next(mesh)) streamed.push_back(mesh.GetPath().GetString());
+
+        EXPECT_EQ(streamed, expected);
+        EXPECT_EQ(stream.count(), expected.size());
+        EXPECT_FALSE(stream.next(mesh));
+    }
+}
+
+TEST(StageReaderTest, MeshStreamOnClosedStageIsEmpty) {
+    ufd::MeshStream stream(nullptr);
+    UsdGeomMesh mesh;
+    EXPECT_FALSE(stream.next(mesh));
+}
+
+TEST(StageReaderTest, ForEachBatchHandsOutEveryMeshOnce) {
+    ufd::StageReader reader;
+    reader.open(PLANT_FILTERED_USD);
+    std::vector<std::string> expected;
+    for (const auto& mesh : reader.collect_meshes())
+        expected.push_back(mesh.GetPath().GetString());
+
+    ufd::MeshStream stream(reader.get_stage());
+    std::vector<std::string> handed;
+    size_t batches = 0;
+    const size_t count = stream.for_each_batch(
+        [&](const std::vector<UsdGeomMesh>& meshes,
+            const std::vector<GfMatrix4d>& world_xforms) {
+            EXPECT_LE(meshes.size(), 4u);
+            EXPECT_EQ(world_xforms.size(), meshes.size());
+            for (const auto& mesh : meshes)
+                handed.push_back(mesh.GetPath().GetString());
+            ++batches;
+        },
+        UsdTimeCode::Default(), 4);
+
+    EXPECT_EQ(count, expected.size());
+    EXPECT_EQ(handed, expected);
+    EXPECT_EQ(batches, (expected.size() + 3) / 4);
+}
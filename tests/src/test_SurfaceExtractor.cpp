@@ -1,5 +1,11 @@
 #include <ufd/StageReader.h>
 #include <ufd/SurfaceExtractor.h>
+#include <ufd/GeometryCache.h>
+
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/xform.h>
+#include <pxr/usd/sdf/path.h>
 
 #include <gtest/gtest.h>
 
@@ -117,3 +123,185 @@ TEST(SurfaceExtractorTest, BoundingBoxOfIntersectedMeshes) {
     EXPECT_NEAR(bbox.GetMax()[1], 15.0, 1e-5);
     EXPECT_NEAR(bbox.GetMax()[2], 15.0, 1e-5);
 }
+
+TEST(SurfaceExtractorTest, SurfaceAreaOfEmptySurfaceIsZero) {
+    ufd::SurfaceExtractor extractor;
+    EXPECT_EQ(extractor.compute_surface_area(ufd::SurfaceData{}), 0.0);
+}
+
+TEST(SurfaceExtractorTest, SurfaceAreaOfDisjointBoxes) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    // Two 10-unit cubes
+    ufd::SurfaceExtractor extractor;
+    auto surface = extractor.extract(meshes);
+    EXPECT_NEAR(extractor.compute_surface_area(surface), 2 * 6 * 100.0, 1e-3);
+}
+
+TEST(SurfaceExtractorTest, BoundingBoxOverTimeIsUnionOfFrames) {
+    auto stage = pxr::UsdStage::CreateInMemory();
+    auto xf = UsdGeomXform::Define(stage, SdfPath("/Part"));
+    auto op = xf.AddTranslateOp();
+    op.Set(GfVec3d(0, 0, 0), UsdTimeCode(0));
+    op.Set(GfVec3d(5, 0, 0), UsdTimeCode(10));
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath("/Part/mesh"));
+    mesh.GetPointsAttr().Set(VtVec3fArray{
+        GfVec3f(0, 0, 0), GfVec3f(1, 0, 0), GfVec3f(0, 1, 0)});
+    mesh.GetFaceVertexCountsAttr().Set(VtIntArray{3});
+    mesh.GetFaceVertexIndicesAttr().Set(VtIntArray{0, 1, 2});
+
+    ufd::SurfaceExtractor extractor;
+    auto bbox = extractor.compute_bounding_box(
+        {mesh}, {UsdTimeCode(0), UsdTimeCode(5), UsdTimeCode(10)});
+
+    EXPECT_DOUBLE_EQ(bbox.GetMin()[0], 0.0);
+    EXPECT_DOUBLE_EQ(bbox.GetMax()[0], 6.0);
+}
+
+TEST(SurfaceExtractorTest, ExtractManyMeshesKeepsOrderAndRebasesIndices) {
+    // Parts of differing sizes so every slice of the merged arrays has its
+    // own offset
+    auto stage = pxr::UsdStage::CreateInMemory();
+    std::vector<UsdGeomMesh> meshes;
+    const int parts = 64;
+    for (int p = 0; p < parts; ++p) {
+        const std::string part = "/Part_" + std::to_string(p);
+        auto xf = UsdGeomXform::Define(stage, SdfPath(part));
+        xf.AddTranslateOp().Set(GfVec3d(p, 0, 0));
+        auto mesh = UsdGeomMesh::Define(stage, SdfPath(part + "/mesh"));
+
+        const int fan = 3 + p % 5;  // triangles around point 0
+        VtVec3fArray points{GfVec3f(0, 0, 0)};
+        VtIntArray   counts, indices;
+        for (int k = 0; k <= fan; ++k)
+            points.push_back(GfVec3f(1, float(k), float(p)));
+        for (int k = 0; k < fan; ++k) {
+            counts.push_back(3);
+            indices.push_back(0);
+            indices.push_back(k + 1);
+            indices.push_back(k + 2);
+        }
+        mesh.GetPointsAttr().Set(points);
+        mesh.GetFaceVertexCountsAttr().Set(counts);
+        mesh.GetFaceVertexIndicesAttr().Set(indices);
+        meshes.push_back(mesh);
+    }
+
+    ufd::SurfaceExtractor extractor;
+    auto surface = extractor.extract(meshes);
+
+    size_t point_base = 0, face_base = 0, index_base = 0;
+    for (int p = 0; p < parts; ++p) {
+        const int fan = 3 + p % 5;
+        EXPECT_EQ(surface.points[point_base], GfVec3f(float(p), 0, 0));
+        EXPECT_EQ(surface.points[point_base + 1], GfVec3f(float(p + 1), 0, float(p)));
+        for (int k = 0; k < fan; ++k) {
+            EXPECT_EQ(surface.face_vertex_counts[face_base + k], 3);
+            EXPECT_EQ(surface.face_vertex_indices[index_base + 3 * k],
+                      static_cast<int>(point_base));
+            EXPECT_EQ(surface.face_vertex_indices[index_base + 3 * k + 2],
+                      static_cast<int>(point_base) + k + 2);
+        }
+        point_base += fan + 2;
+        face_base  += fan;
+        index_base += 3 * fan;
+    }
+    EXPECT_EQ(surface.points.size(), point_base);
+    EXPECT_EQ(surface.face_vertex_counts.size(), face_base);
+    EXPECT_EQ(surface.face_vertex_indices.size(), index_base);
+}
+
+// ---- Bounds only ----
+
+TEST(SurfaceExtractorTest, WorldBoundsMatchExtractedSurface) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::SurfaceExtractor extractor;
+    EXPECT_EQ(extractor.compute_world_bounds(meshes),
+              extractor.compute_bounding_box(extractor.extract(meshes)));
+}
+
+TEST(SurfaceExtractorTest, WorldBoundsOfNoMeshesAreEmpty) {
+    ufd::SurfaceExtractor extractor;
+    EXPECT_TRUE(extractor.compute_world_bounds({}).IsEmpty());
+}
+
+TEST(SurfaceExtractorTest, TrustedExtentsReplacePoints) {
+    // Authored extent deliberately larger than the points
+    auto stage = pxr::UsdStage::CreateInMemory();
+    auto xf = UsdGeomXform::Define(stage, SdfPath("/Part"));
+    xf.AddTranslateOp().Set(GfVec3d(10, 0, 0));
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath("/Part/mesh"));
+    mesh.GetPointsAttr().Set(VtVec3fArray{
+        GfVec3f(0, 0, 0), GfVec3f(1, 0, 0), GfVec3f(0, 1, 0)});
+    mesh.GetFaceVertexCountsAttr().Set(VtIntArray{3});
+    mesh.GetFaceVertexIndicesAttr().Set(VtIntArray{0, 1, 2});
+    mesh.GetExtentAttr().Set(VtVec3fArray{GfVec3f(-1, -1, -1),
+                                          GfVec3f(2, 2, 2)});
+
+    ufd::SurfaceExtractor extractor;
+    const auto trusted = extractor.compute_world_bounds(
+        {mesh}, UsdTimeCode::Default(), true);
+    EXPECT_EQ(trusted, GfRange3d(GfVec3d(9, -1, -1), GfVec3d(12, 2, 2)));
+
+    const auto from_points = extractor.compute_world_bounds({mesh});
+    EXPECT_EQ(from_points, GfRange3d(GfVec3d(10, 0, 0), GfVec3d(11, 1, 0)));
+}
+
+TEST(SurfaceExtractorTest, MeshWithoutExtentFallsBackToPoints) {
+    auto stage = pxr::UsdStage::CreateInMemory();
+    auto mesh = UsdGeomMesh::Define(stage, SdfPath("/mesh"));
+    mesh.GetPointsAttr().Set(VtVec3fArray{
+        GfVec3f(0, 0, 0), GfVec3f(3, 0, 0), GfVec3f(0, 4, 0)});
+    mesh.GetFaceVertexCountsAttr().Set(VtIntArray{3});
+    mesh.GetFaceVertexIndicesAttr().Set(VtIntArray{0, 1, 2});
+
+    ufd::SurfaceExtractor extractor;
+    EXPECT_EQ(extractor.compute_world_bounds({mesh}, UsdTimeCode::Default(),
+                                             true),
+              GfRange3d(GfVec3d(0, 0, 0), GfVec3d(3, 4, 0)));
+}
+
+TEST(SurfaceExtractorTest, StreamedWorldBoundsMatchCollectedMeshes) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+
+    ufd::SurfaceExtractor extractor;
+    ufd::MeshStream stream(reader.get_stage());
+    EXPECT_EQ(extractor.compute_world_bounds(stream),
+              extractor.compute_world_bounds(reader.collect_meshes()));
+}
+
+// ---- From a GeometryCache ----
+
+TEST(SurfaceExtractorTest, CachedBoundingBoxMatchesExtractedSurface) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::SurfaceExtractor extractor;
+    const auto from_surface = extractor.compute_bounding_box(
+        extractor.extract(meshes));
+    const auto from_cache = extractor.compute_bounding_box(
+        ufd::GeometryCache(meshes));
+    EXPECT_EQ(from_cache, from_surface);
+}
+
+TEST(SurfaceExtractorTest, CachedSurfaceAreaMatchesExtractedSurface) {
+    ufd::StageReader reader;
+    reader.open(BOX_X2_DISJOINT_USD);
+    auto meshes = reader.collect_meshes();
+
+    ufd::SurfaceExtractor extractor;
+    EXPECT_NEAR(extractor.compute_surface_area(ufd::GeometryCache(meshes)),
+                2 * 6 * 100.0, 1e-3);
+}
+
+TEST(SurfaceExtractorTest, CachedBoundingBoxOfNoMeshesIsEmpty) {
+    ufd::SurfaceExtractor extractor;
+    EXPECT_TRUE(extractor.compute_bounding_box(ufd::GeometryCache({})).IsEmpty());
+}
@@ -0,0 +1,139 @@
+#include <ufd/Trace.h>
+
+#include <tbb/parallel_for.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Tracing is process-wide; each test starts from an empty, enabled trace.
+class TraceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ufd::reset_trace();
+        ufd::set_tracing(true);
+    }
+    void TearDown() override {
+        ufd::set_tracing(false);
+        ufd::reset_trace();
+    }
+};
+
+size_t count_of(const std::string& text, const std::string& needle) {
+    size_t n = 0;
+    for (size_t at = text.find(needle); at != std::string::npos;
+         at = text.find(needle, at + 1))
+        ++n;
+    return n;
+}
+
+} // namespace
+
+TEST_F(TraceTest, DisabledRecordsNothing) {
+    ufd::set_tracing(false);
+    {
+        ufd::TraceScope span("closing");
+    }
+    EXPECT_EQ(ufd::trace_event_count(), 0u);
+}
+
+TEST_F(TraceTest, ScopeRecordsOneCompleteEvent) {
+    {
+        ufd::TraceScope span("closing", "voxels", 42);
+    }
+    EXPECT_EQ(ufd::trace_event_count(), 1u);
+
+    const std::string json = ufd::trace_json();
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\": \"closing\", \"cat\": \"ufd\", \"ph\": \"X\""),
+              std::string::npos);
+    EXPECT_NE(json.find("\"args\": {\"voxels\": 42}"), std::string::npos);
+    EXPECT_EQ(count_of(json, "\"thread_name\""), 1u);
+}
+
+TEST_F(TraceTest, SpanOpenWhenTracingStopsIsStillRecorded) {
+    {
+        ufd::TraceScope span("meshing");
+        ufd::set_tracing(false);
+    }
+    EXPECT_EQ(ufd::trace_event_count(), 1u);
+}
+
+TEST_F(TraceTest, ManySpansOverflowIntoMoreChunks) {
+    for (int i = 0; i < 10000; ++i) {
+        ufd::TraceScope span("union");
+    }
+    EXPECT_EQ(ufd::trace_event_count(), 10000u);
+    EXPECT_EQ(count_of(ufd::trace_json(), "\"name\": \"union\""), 10000u);
+}
+
+TEST_F(TraceTest, ParallelTasksGetTheirOwnTimelines) {
+    tbb::parallel_for(0, 64, [](int i) {
+        ufd::TraceScope span("mesh_sdf", "mesh", i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+    EXPECT_EQ(ufd::trace_event_count(), 64u);
+
+    // Every span lands on the timeline of the thread that ran it
+    const std::string json = ufd::trace_json();
+    std::set<std::string> tids;
+    for (size_t at = json.find("\"tid\": "); at != std::string::npos;
+         at = json.find("\"tid\": ", at + 1)) {
+        tids.insert(json.substr(at, json.find_first_of(",}", at) - at));
+    }
+    EXPECT_EQ(count_of(json, "\"thread_name\""), tids.size());
+    if (std::thread::hardware_concurrency() > 1) EXPECT_GT(tids.size(), 1u);
+}
+
+TEST_F(TraceTest, SpansOfExitedThreadsAreKept) {
+    std::thread([] { ufd::TraceScope span("layer_save"); }).join();
+    EXPECT_EQ(ufd::trace_event_count(), 1u);
+}
+
+TEST_F(TraceTest, ResetDropsSpans) {
+    {
+        ufd::TraceScope span("closing");
+    }
+    ufd::reset_trace();
+    EXPECT_EQ(ufd::trace_event_count(), 0u);
+    {
+        ufd::TraceScope span("closing");
+    }
+    EXPECT_EQ(ufd::trace_event_count(), 1u);
+}
+
+TEST_F(TraceTest, MacrosFollowTheBuildFlag) {
+    {
+        UFD_TRACE_SCOPE("outer");
+        UFD_TRACE_SCOPE_ARG("inner", "faces", 12);
+    }
+#ifdef UFD_TRACING
+    EXPECT_EQ(ufd::trace_event_count(), 2u);
+#else
+    EXPECT_EQ(ufd::trace_event_count(), 0u);
+#endif
+}
+
+TEST_F(TraceTest, WriteTraceWritesTheJson) {
+    {
+        ufd::TraceScope span("closing");
+    }
+    const auto path = std::filesystem::temp_directory_path()
+                    / "ufd_trace_test.json";
+    ASSERT_TRUE(ufd::write_trace(path.string()));
+    std::ifstream in(path);
+    std::stringstream contents;
+    contents << in.rdbuf();
+    EXPECT_EQ(contents.str(), ufd::trace_json());
+    std::filesystem::remove(path);
+
+    EXPECT_FALSE(ufd::write_trace("/nonexistent_dir/trace.json"));
+}
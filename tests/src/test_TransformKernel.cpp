@@ -0,0 +1,119 @@
+#include <ufd/TransformKernel.h>
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/range3d.h>
+#include <pxr/base/gf/rotation.h>
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/vt/types.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Helper: count random points in [-100, 100]^3, packed xyz
+static std::vector<float> random_points(size_t count) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    std::vector<float> pts(3 * count);
+    for (auto& c : pts) c = coord(rng);
+    return pts;
+}
+
+// Helper: rotation, non-uniform scale and translation
+static GfMatrix4d affine_xform() {
+    GfMatrix4d m;
+    m.SetRotate(GfRotation(GfVec3d(1, 2, 3), 37.0));
+    GfMatrix4d scale;
+    scale.SetScale(GfVec3d(1.5, 0.25, 3.0));
+    return scale * m * GfMatrix4d().SetTranslate(GfVec3d(10.5, -3.25, 7.125));
+}
+
+// Helper: the per-point GfMatrix4d::Transform loop the kernel replaces
+static std::vector<float> reference_transform(const GfMatrix4d& m,
+                                              const std::vector<float>& in) {
+    std::vector<float> out(in.size());
+    for (size_t i = 0; i < in.size(); i += 3) {
+        const GfVec3d p = m.Transform(GfVec3d(in[i], in[i + 1], in[i + 2]));
+        out[i]     = static_cast<float>(p[0]);
+        out[i + 1] = static_cast<float>(p[1]);
+        out[i + 2] = static_cast<float>(p[2]);
+    }
+    return out;
+}
+
+static bool bitwise_equal(const std::vector<float>& a,
+                          const std::vector<float>& b) {
+    return a.size() == b.size()
+        && std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+TEST(TransformKernelTest, EveryLevelMatchesGfTransformExactly) {
+    // Larger than one task, with a ragged tail
+    const auto in  = random_points(300001);
+    const auto m   = affine_xform();
+    const auto ref = reference_transform(m, in);
+
+    for (auto level : {ufd::SimdLevel::Scalar, ufd::SimdLevel::SSE2,
+                       ufd::SimdLevel::AVX2}) {
+        std::vector<float> out(in.size());
+        ufd::transform_points(m, in.data(), out.data(), in.size() / 3, level);
+        EXPECT_TRUE(bitwise_equal(out, ref)) << ufd::to_string(level);
+    }
+}
+
+TEST(TransformKernelTest, TransformsInPlace) {
+    auto pts = random_points(1000);
+    const auto m   = affine_xform();
+    const auto ref = reference_transform(m, pts);
+
+    ufd::transform_points(m, pts.data(), pts.data(), pts.size() / 3);
+    EXPECT_TRUE(bitwise_equal(pts, ref));
+}
+
+TEST(TransformKernelTest, ProjectiveMatrixDividesByW) {
+    const auto in = random_points(100);
+    GfMatrix4d m(1.0);
+    m[0][3] = 0.01;  // w = 1 + 0.01 x
+    const auto ref = reference_transform(m, in);
+
+    std::vector<float> out(in.size());
+    ufd::transform_points(m, in.data(), out.data(), in.size() / 3);
+    EXPECT_TRUE(bitwise_equal(out, ref));
+}
+
+TEST(TransformKernelTest, WritesIntoGfVec3fArrays) {
+    const VtVec3fArray in = {GfVec3f(1, 2, 3), GfVec3f(-4, 5, -6)};
+    VtVec3fArray out(in.size());
+    const GfMatrix4d m = GfMatrix4d().SetTranslate(GfVec3d(1, 1, 1));
+
+    ufd::transform_points(m, reinterpret_cast<const float*>(in.cdata()),
+                          reinterpret_cast<float*>(out.data()), in.size());
+    EXPECT_EQ(out[0], GfVec3f(2, 3, 4));
+    EXPECT_EQ(out[1], GfVec3f(-3, 6, -5));
+}
+
+TEST(TransformKernelTest, EmptyInputIsNoOp) {
+    ufd::transform_points(affine_xform(), nullptr, nullptr, 0);
+}
+
+TEST(TransformKernelTest, BoundsMatchTransformedPointsAtEveryLevel) {
+    const auto in  = random_points(300001);
+    const auto m   = affine_xform();
+    const auto ref = reference_transform(m, in);
+    GfRange3d expected;
+    for (size_t i = 0; i < ref.size(); i += 3)
+        expected.UnionWith(GfVec3d(ref[i], ref[i + 1], ref[i + 2]));
+
+    for (auto level : {ufd::SimdLevel::Scalar, ufd::SimdLevel::SSE2,
+                       ufd::SimdLevel::AVX2}) {
+        EXPECT_EQ(ufd::transform_bounds(m, in.data(), in.size() / 3, level),
+                  expected) << ufd::to_string(level);
+    }
+}
+
+TEST(TransformKernelTest, BoundsOfNoPointsAreEmpty) {
+    EXPECT_TRUE(ufd::transform_bounds(affine_xform(), nullptr, 0).IsEmpty());
+}